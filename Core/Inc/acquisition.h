@@ -0,0 +1,57 @@
+#ifndef __ACQUISITION_H
+#define __ACQUISITION_H
+
+#include <stdint.h>
+
+/* 采集缓冲参数
+ * DMA以循环模式写入acq_dma_buf, 半传输/全传输中断分别标记前半/后半数据块就绪,
+ * 主循环只处理已完成的半缓冲, 不再逐点轮询ADC.
+ */
+#define ACQ_HALF_SAMPLES        256
+#define ACQ_DMA_SAMPLES         (ACQ_HALF_SAMPLES * 2)
+
+/* 采样率参数 (TIM8 TRGO触发ADC3) */
+#define ACQ_DEFAULT_SAMPLE_RATE 100000U     /* 默认100kS/s */
+#define ACQ_MAX_SAMPLE_RATE     250000U     /* 28.5周期采样时间下的上限 */
+
+/* 双ADC快速交替模式采样率: ADCCLK=12MHz, 每个ADC 1.5+12.5=14周期, 两路错开7周期 */
+#define ACQ_INTERLEAVED_SAMPLE_RATE 1714285U
+
+/* 采集模式 */
+typedef enum {
+    ACQ_MODE_SINGLE = 0,        /* ADC3, TIM8触发 */
+    ACQ_MODE_INTERLEAVED,       /* ADC1+ADC2快速交替, 连续转换 */
+    ACQ_MODE_SCAN,              /* ADC3扫描多个通道, TIM8每次触发转换整个序列 */
+    ACQ_MODE_COUNT
+} acq_mode_t;
+
+/* DMA缓冲: 单ADC模式按半字写入, 双ADC模式按字写入 */
+typedef union {
+    uint16_t samples[ACQ_DMA_SAMPLES];
+    uint32_t words[ACQ_DMA_SAMPLES / 2];
+} acq_dma_buf_t;
+
+/* 中断上下文中的数据块处理函数, 在半缓冲就绪时被调用 */
+typedef void (*acq_block_hook_t)(const uint16_t *samples, uint16_t n);
+
+/* 已完成的半缓冲数据块 */
+typedef struct {
+    const uint16_t *data;   /* 指向DMA缓冲内部, 在acq_release_block()之前有效 */
+    uint16_t len;           /* 采样点数 */
+    uint32_t seq;           /* 块序号, 连续递增, 可用于检测丢块 */
+} acq_block_t;
+
+/* DMA目标缓冲 */
+extern acq_dma_buf_t acq_dma_buf;
+
+/* 数据块交接 (不依赖HAL, ISR与主循环之间使用) */
+void acq_stream_reset(void);
+void acq_set_block_hook(acq_block_hook_t hook);
+void acq_on_half_complete(void);
+void acq_on_full_complete(void);
+uint8_t acq_get_block(acq_block_t *blk);
+void acq_release_block(void);
+uint32_t acq_dropped_blocks(void);
+const char *acq_mode_name(acq_mode_t mode);
+
+#endif /* __ACQUISITION_H */
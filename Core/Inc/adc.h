@@ -29,19 +29,55 @@ extern "C" {
 #include "main.h"
 
 /* USER CODE BEGIN Includes */
-
+#include "acquisition.h"
 /* USER CODE END Includes */
 
+extern ADC_HandleTypeDef hadc1;
+
+extern ADC_HandleTypeDef hadc2;
+
 extern ADC_HandleTypeDef hadc3;
 
 /* USER CODE BEGIN Private defines */
+/* 看门狗触发的标记延迟上限(采样点)
+ * 看门狗中断在越限采样转换结束时置位, 优先级最高, 进入回调约需 12(入栈) + ~80(HAL_ADC_IRQHandler)
+ * 个CPU周期, 即72MHz下约1.3us; 最高采样率250kS/s时一个采样4us, 因此读取DMA计数时最多
+ * 多写入1个采样. 上限取4, 留出关中断临界区的余量. 实测最大值由adc_trigger_awd_latency()给出,
+ * 超过上限的次数由adc_trigger_awd_violations()给出.
+ */
+#define ADC_AWD_MAX_LATENCY     4
+
+/* ADC3一次转换 28.5+12.5 = 41个ADC时钟(12MHz) = 246个CPU周期, 也是扫描模式下相邻通道的采样间隔.
+ * 等效时间采样: 捕获中断读取DMA计数时, 距最近一次启动转换的时间在该值附近 +-ADC_ETS_CONV_MARGIN 周期内
+ * 无法判断转换结果是否已写入, 这样的捕获被丢弃.
+ * 触发信号(或比较器输出)需接到PC6(TIM8_CH1).
+ */
+#define ADC3_CONV_CYCLES        246
+#define ADC_ETS_CONV_MARGIN     16
 
 /* USER CODE END Private defines */
 
+void MX_ADC1_Init(void);
+void MX_ADC2_Init(void);
 void MX_ADC3_Init(void);
 
 /* USER CODE BEGIN Prototypes */
 void adc_channel_set(ADC_HandleTypeDef *adc_handle,uint32_t ch,uint32_t rank,uint32_t stime);
+uint32_t adc_acq_start(acq_mode_t mode, uint32_t rate_hz);
+void adc_acq_stop(void);
+uint32_t adc_acq_start_held(uint32_t rate_hz);
+void adc_acq_release(void);
+acq_mode_t adc_acq_get_mode(void);
+void adc_trigger_rearm(void);
+uint8_t adc_trigger_awd_active(void);
+uint16_t adc_trigger_awd_latency(void);
+uint32_t adc_trigger_awd_violations(void);
+void adc_trigger_set_ets(uint8_t enable);
+uint8_t adc_trigger_ets_active(void);
+uint32_t adc_trigger_ets_dropped(void);
+void adc_scan_set_channels(const uint32_t *channels, uint8_t count);
+void adc_scan_set_count(uint8_t count);
+uint8_t adc_scan_get_count(void);
 uint32_t adc_get_result(uint32_t ch);
 uint32_t adc_get_result_average(uint32_t ch,uint8_t times);
 void adc_get_result_array(uint32_t ch, uint32_t *result_array, uint8_t times);
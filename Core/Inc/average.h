@@ -0,0 +1,39 @@
+#ifndef __AVERAGE_H
+#define __AVERAGE_H
+
+#include <stdint.h>
+
+/* 多次触发记录平均
+ * 作为数据块处理函数(average_push)在DMA中断中运行: 每完成一条触发记录就累加并立即重新布防,
+ * 显示刷新时用average_read()读出当前结果, 与显示刷新的快慢无关, 每条记录都参与平均.
+ * AVERAGE_BLOCK: 把N条记录逐点累加到32位累加器, 满N条时右移log2(N)位得到平均值, 然后重新开始.
+ *                累加过程中读出时乘一次预先求出的倒数输出中间结果. 16位高分辨率记录
+ *                65535*256 < 2^24, 不会溢出.
+ * AVERAGE_EMA  : 指数滑动平均 acc += (x - acc) >> k, 等效平均长度约2^k条记录,
+ *                只保存累加器, 不需要保存N条记录.
+ * 逐点运算只用整数加减, 乘法和移位, 不使用浮点. 不依赖HAL.
+ *
+ * RAM占用: 累加器 AVERAGE_MAX_RECORD * 4 = 1840字节, 其余状态不足16字节.
+ */
+
+#define AVERAGE_MAX_RECORD      460     /* 与WAVE_WIDTH一致, 一次扫描最多460点 */
+#define AVERAGE_MAX_LOG2        8       /* 最多256条 */
+
+typedef enum {
+    AVERAGE_OFF = 0,
+    AVERAGE_BLOCK,
+    AVERAGE_EMA,
+    AVERAGE_MODE_COUNT
+} average_mode_t;
+
+void average_configure(average_mode_t mode, uint8_t log2n);
+void average_reset(void);
+void average_push(const uint16_t *samples, uint16_t n);
+uint16_t average_read(uint16_t *record, uint16_t len);
+
+average_mode_t average_get_mode(void);
+uint8_t average_get_log2(void);
+uint16_t average_count(void);
+uint32_t average_records(void);
+
+#endif /* __AVERAGE_H */
@@ -0,0 +1,60 @@
+#ifndef __BODE_H
+#define __BODE_H
+
+#include <stdint.h>
+
+/* 闭环频率特性测量(波特图)
+ * DAC以DDS输出正弦波, 依次设置N个按对数间隔分布的频率, 每个频点等待被测网络稳定后,
+ * 把ADC采样与DDS自身的相位做单频点DFT相关: 参考相位由DDS的频率字和相位逐点算出, 不需要第二路ADC.
+ * 积分长度取整数个周期, 并减去采样的平均值, 直流和其它谐波不泄漏到结果中.
+ * 相关运算为定点: 采样(12位)乘Q15正弦表, 64位累加. 增益和相位在主循环中由累加结果算出.
+ * 要求ADC与DAC由同一个定时器触发, 第k个ADC采样对应第k-BODE_DAC_LATENCY个DAC输出点.
+ * 采样保持, DAC建立时间等固定误差可以用直通校准扣除: 保存一次直连时的结果, 之后的结果都减去它.
+ * bode_push()/bode_poll()不依赖HAL, 可在主机上用模拟的RC网络测试.
+ */
+
+#define BODE_MAX_POINTS         64
+#define BODE_DEFAULT_POINTS     41
+#define BODE_DEFAULT_START_MHZ  20000U          /* 20Hz */
+#define BODE_DEFAULT_STOP_MHZ   20000000U       /* 20kHz */
+#define BODE_SAMPLE_RATE        200000U         /* ADC与DAC共用的采样率 */
+#define BODE_DAC_LATENCY        1               /* DAC的DMA请求在触发时才装载下一个点, 输出晚一个采样 */
+#ifndef BODE_ADC_SAMPLE_NS
+#define BODE_ADC_SAMPLE_NS      2375            /* DAC更新后ADC采样保持结束的时刻: 28.5个12MHz ADC时钟 */
+#endif
+#define BODE_PERIODS            4               /* 每个频点至少积分的周期数 */
+#define BODE_MIN_SAMPLES        4096            /* 高频时增加周期数, 积分点数不少于此 */
+#define BODE_SETTLE_PERIODS     2               /* 改变频率后丢弃的周期数 */
+#define BODE_SETTLE_SAMPLES     1024            /* 丢弃的点数不少于此 */
+
+/* 一个频点的结果 */
+typedef struct {
+    uint32_t freq_mhz;          /* 实际频率 */
+    int16_t gain_cdb;           /* 增益, 0.01dB */
+    int16_t phase_x10;          /* 相位, 0.1度, -1800~1800, 正值为超前 */
+} bode_point_t;
+
+/* 周期计数器, 用于测量相关运算耗时 */
+typedef uint32_t (*bode_clock_fn)(void);
+
+void bode_configure(uint32_t f_start_mhz, uint32_t f_stop_mhz, uint16_t points);
+void bode_set_clock(bode_clock_fn clock);
+void bode_start(uint16_t ref_amp);
+void bode_stop(void);
+void bode_push(const uint16_t *samples, uint16_t n);
+uint8_t bode_poll(void);
+
+uint8_t bode_running(void);
+uint16_t bode_points(void);
+uint16_t bode_done(void);
+uint32_t bode_start_freq(void);
+uint32_t bode_stop_freq(void);
+uint8_t bode_get_point(uint16_t index, bode_point_t *pt);
+
+void bode_cal_store(void);
+void bode_cal_clear(void);
+uint8_t bode_cal_valid(void);
+
+uint32_t bode_cycles_per_sample_x100(void);
+
+#endif /* __BODE_H */
@@ -5,7 +5,7 @@
 #include "oscilloscope.h"
 
 /* 按钮数量定义 */
-#define BUTTON_COUNT 5
+#define BUTTON_COUNT 27
 
 /* 虚拟按钮函数 */
 void draw_virtual_buttons(void);
@@ -0,0 +1,45 @@
+#ifndef __CAPTURE_H
+#define __CAPTURE_H
+
+#include <stdint.h>
+
+/* 预触发/后触发环形缓冲采集引擎
+ * 连续把采样写入环形缓冲, 预触发深度填满后开始检测触发, 触发后再采集后触发部分,
+ * 完成后冻结整条记录供显示使用. 不依赖HAL, 可在主机上直接喂入采样序列测试.
+ */
+
+#define CAPTURE_RING_BITS   10
+#define CAPTURE_RING_SIZE   (1U << CAPTURE_RING_BITS)   /* 1024点, 2KB */
+#define CAPTURE_RING_MASK   (CAPTURE_RING_SIZE - 1)
+#define CAPTURE_MAX_RECORD  CAPTURE_RING_SIZE
+
+/* 采集状态 */
+typedef enum {
+    CAPTURE_IDLE = 0,       /* 未布防 */
+    CAPTURE_PRETRIGGER,     /* 正在填充预触发数据 */
+    CAPTURE_ARMED,          /* 等待触发 */
+    CAPTURE_POSTTRIGGER,    /* 已触发, 正在采集后触发数据 */
+    CAPTURE_DONE            /* 记录已冻结 */
+} capture_state_t;
+
+/* 触发检测函数: 在samples[0..n)中查找触发点, 返回偏移, 未找到返回-1 */
+typedef int32_t (*capture_trigger_fn)(const uint16_t *samples, uint16_t n);
+
+void capture_configure(uint16_t record_len, uint8_t pretrigger_pct, uint8_t align);
+void capture_set_trigger(capture_trigger_fn fn);
+void capture_set_level(uint16_t level);
+void capture_arm(void);
+void capture_arm_continue(void);
+void capture_disarm(void);
+void capture_force(void);
+void capture_push(const uint16_t *samples, uint16_t n);
+uint16_t capture_feed(const uint16_t *samples, uint16_t n);
+
+capture_state_t capture_state(void);
+uint8_t capture_ready(void);
+uint16_t capture_record_length(void);
+uint16_t capture_trigger_index(void);
+uint16_t capture_read(uint16_t index);
+void capture_copy_record(uint16_t *dst, uint16_t len);
+
+#endif /* __CAPTURE_H */
@@ -35,6 +35,33 @@ extern "C" {
 extern DAC_HandleTypeDef hdac;
 
 /* USER CODE BEGIN Private defines */
+/* DMA波形发生器: TIM7 TRGO触发DAC通道1(双通道DDS时两个通道), DMA2通道3循环输出 */
+#define DAC_WAVE_MAX_LEN        2048            /* 波形表最多点数 */
+#define DAC_WAVE_MIN_LEN        16
+#define DAC_WAVE_MAX_RATE       1000000         /* 输出点速率上限, 点/秒 */
+#define DAC_WAVE_MIN_FREQ_MHZ   1000U           /* 1Hz */
+#define DAC_WAVE_MAX_FREQ_MHZ   (DAC_WAVE_MAX_RATE / DAC_WAVE_MIN_LEN * 1000U)  /* 62.5kHz */
+#define DAC_DDS_HALF            256             /* DDS方式每次填充的点数, 缓冲为两倍 */
+#define DAC_DEFAULT_FREQ_HZ     500U            /* 默认100kS/s采样时一次扫描约显示两个周期 */
+
+typedef enum {
+    DAC_SHAPE_TRIANGLE = 0,
+    DAC_SHAPE_SINE,
+    DAC_SHAPE_ARB,              /* 上传的任意波形, 点数由上传决定, 不使用幅度和中心值 */
+    DAC_SHAPE_COUNT
+} dac_wave_shape_t;
+
+/* DAC内置波形发生器: 每次触发把三角波计数器或LFSR的低n位加到DHR上 */
+typedef enum {
+    DAC_HWGEN_OFF = 0,
+    DAC_HWGEN_TRIANGLE,
+    DAC_HWGEN_NOISE,
+    DAC_HWGEN_COUNT
+} dac_hwgen_t;
+
+#define DAC_HWGEN_NOISE_STEPS   16      /* 单独输出噪声时, 设定频率的每个周期触发16次 */
+
+extern uint16_t g_dac_sin_buf[DAC_WAVE_MAX_LEN];
 
 /* USER CODE END Private defines */
 
@@ -42,6 +69,32 @@ void MX_DAC_Init(void);
 
 /* USER CODE BEGIN Prototypes */
 void dac_triangular_wave(uint16_t maxval, uint16_t dt, uint16_t samples, uint16_t n);
+
+uint32_t dac_wave_start(dac_wave_shape_t shape, uint32_t freq_mhz, uint16_t amp, uint16_t offset);
+uint32_t dac_wave_set_frequency(uint32_t freq_mhz);
+void dac_wave_set_shape(dac_wave_shape_t shape, uint16_t amp, uint16_t offset);
+void dac_wave_poll(void);
+uint32_t dac_wave_get_frequency(void);
+uint16_t dac_wave_get_length(void);
+uint32_t dac_wave_get_rate(void);
+dac_wave_shape_t dac_wave_get_shape(void);
+uint16_t dac_wave_value_at(uint32_t idx, uint32_t rate);
+
+uint32_t dac_dds_start(uint8_t dual);
+uint8_t dac_dds_active(void);
+uint8_t dac_dds_dual(void);
+uint32_t dac_dds_start_synced(uint32_t rate);
+uint8_t dac_dds_synced(void);
+
+uint16_t *dac_arb_begin(uint16_t len);
+uint8_t dac_arb_end(uint16_t len);
+uint16_t dac_arb_length(void);
+
+uint32_t dac_hwgen_start(dac_hwgen_t kind, uint32_t freq_mhz, uint8_t bits, uint16_t offset);
+void dac_hwgen_overlay(dac_hwgen_t kind, uint8_t bits);
+uint8_t dac_hwgen_active(void);
+dac_hwgen_t dac_hwgen_get_kind(void);
+const char *dac_hwgen_name(dac_hwgen_t kind);
 /* USER CODE END Prototypes */
 
 #ifdef __cplusplus
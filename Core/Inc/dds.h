@@ -0,0 +1,80 @@
+#ifndef __DDS_H
+#define __DDS_H
+
+#include <stdint.h>
+
+/* 直接数字频率合成(DDS)
+ * 32位相位累加器每个输出点加一次频率字M, 输出频率 f = M * fs / 2^32, fs为输出点速率.
+ * fs = 200kS/s 时频率分辨率约46.6uHz, 改变频率只改写M, 相位连续.
+ * 正弦波查表: 表长2^DDS_LUT_BITS点, 上电时用定点递推生成(不使用浮点), 相位高位作下标,
+ * 可选用接下来的16位在相邻两点之间线性插值. 三角波, 锯齿波和方波直接由相位算出.
+ * 通道2由同一个相位累加器导出: 相位 = 通道1相位 * k + 相位差, 两个通道严格同步.
+ * 扫频: 在起止频率之间按线性或对数间隔阶梯或连续改变频率字, 每一级开始时产生同步标记.
+ * dds_fill()/dds_fill_dual()在DAC DMA的半传输/传输完成中断中填充刚输出完的半个缓冲. 不依赖HAL.
+ */
+
+#define DDS_LUT_BITS        10      /* 正弦表1024点, 可取10~12 */
+#define DDS_LUT_SIZE        (1U << DDS_LUT_BITS)
+
+#define DDS_DEFAULT_RATE    200000U /* 默认输出点速率, 点/秒 */
+#define DDS_CHANNELS        2
+#define DDS_SWEEP_CHUNK     8       /* 连续扫频每8个输出点更新一次频率字 */
+
+typedef enum {
+    DDS_SINE = 0,
+    DDS_TRIANGLE,
+    DDS_SAWTOOTH,
+    DDS_SQUARE,
+    DDS_SHAPE_COUNT
+} dds_shape_t;
+
+typedef enum {
+    DDS_SWEEP_OFF = 0,
+    DDS_SWEEP_STEP,             /* 阶梯扫频 */
+    DDS_SWEEP_CHIRP             /* 连续扫频 */
+} dds_sweep_kind_t;
+
+/* 周期计数器, 用于测量填充耗时 */
+typedef uint32_t (*dds_clock_fn)(void);
+
+void dds_init(void);
+void dds_set_rate(uint32_t sample_rate);
+uint32_t dds_set_frequency(uint32_t freq_mhz);
+void dds_set_shape(uint8_t ch, dds_shape_t shape);
+void dds_set_duty(uint8_t ch, uint16_t duty_permille);
+void dds_set_level(uint8_t ch, uint16_t amp, uint16_t offset);
+void dds_set_interp(uint8_t enable);
+void dds_set_phase_offset(uint16_t deg_x10);
+void dds_set_ratio(uint8_t k);
+void dds_set_clock(dds_clock_fn clock);
+void dds_reset_phase(void);
+
+void dds_fill(uint16_t *dst, uint16_t n);
+void dds_fill_dual(uint32_t *dst, uint16_t n);
+uint16_t dds_sample(uint8_t ch, uint32_t phase);
+
+void dds_sweep_start(dds_sweep_kind_t kind, uint32_t f_start_mhz, uint32_t f_stop_mhz,
+                     uint32_t duration_ms, uint16_t steps, uint8_t log, uint16_t block);
+void dds_sweep_stop(void);
+dds_sweep_kind_t dds_sweep_get_kind(void);
+uint8_t dds_sweep_take_marker(void);
+uint32_t dds_sweep_marker_count(void);
+uint32_t dds_sweep_marker_sample(void);
+uint32_t dds_sweep_marker_freq(void);
+uint16_t dds_sweep_step_index(void);
+uint32_t dds_get_sample_count(void);
+uint32_t dds_get_origin(uint32_t *sample, uint32_t *phase);
+const int16_t *dds_sine_table(void);
+
+uint32_t dds_get_rate(void);
+uint32_t dds_get_tuning_word(void);
+uint32_t dds_get_frequency(void);
+dds_shape_t dds_get_shape(uint8_t ch);
+uint16_t dds_get_duty(uint8_t ch);
+uint16_t dds_get_phase_offset(void);
+uint8_t dds_get_ratio(void);
+uint8_t dds_get_interp(void);
+uint32_t dds_cycles_per_sample_x100(void);
+const char *dds_shape_name(dds_shape_t shape);
+
+#endif /* __DDS_H */
@@ -0,0 +1,33 @@
+#ifndef __ETS_H
+#define __ETS_H
+
+#include <stdint.h>
+
+/* 等效时间采样(随机交替采样)
+ * 对重复信号, 每次触发时信号过电平的时刻相对采样时钟的相位是随机的. 用定时器输入捕获
+ * 测出这个亚采样偏移frac, 把每条记录的采样按 (采样时刻 - 过电平时刻) 放入细分为
+ * factor份的时间网格, 多次采集后网格被填满, 等效采样率为实际采样率的factor倍.
+ * 网格每格保存累加和与次数, 输出时取平均, 空格用相邻有效格线性插值.
+ * ets_add_record()/ets_reconstruct()不依赖HAL, 可在主机上用模拟信号测试.
+ */
+
+#define ETS_MAX_BINS        460     /* 网格点数上限, 与显示宽度一致 */
+#define ETS_MIN_FACTOR      4
+#define ETS_MAX_FACTOR      64
+#define ETS_MAX_RECORD      (ETS_MAX_BINS / ETS_MIN_FACTOR + 4)
+#define ETS_DECAY_COUNT     32      /* 任一格累计到该次数时全部减半, 使旧数据逐渐淡出 */
+
+void ets_configure(uint8_t factor, uint16_t bins, uint8_t pretrigger_pct);
+void ets_reset(void);
+uint8_t ets_get_factor(void);
+uint16_t ets_get_bins(void);
+uint16_t ets_record_length(void);
+uint32_t ets_record_count(void);
+
+void ets_add_record(const uint16_t *record, uint16_t len, uint16_t trig_idx, uint16_t frac);
+uint16_t ets_reconstruct(uint16_t *out);
+
+void ets_note_trigger(uint16_t frac);
+void ets_push(const uint16_t *samples, uint16_t n);
+
+#endif /* __ETS_H */
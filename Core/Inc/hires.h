@@ -0,0 +1,39 @@
+#ifndef __HIRES_H
+#define __HIRES_H
+
+#include <stdint.h>
+
+/* 过采样高分辨率采集
+ * ADC以最高采样率运行, 每个DMA半缓冲在原地经2阶CIC抽取滤波器降采样R倍:
+ *   两级积分器 -> 每R个采样取一次 -> 两级梳状器(差分延迟1)
+ * 积分器使用32位无符号回绕运算, 只要输出位数 12 + 2*log2(R) <= 32 结果就是正确的.
+ * CIC增益R^2, 输出统一缩放为16位(满量程65520). 白噪声经R倍平均后下降sqrt(R)倍,
+ * 有效位数约为 12 + log2(R)/2: R=16为14位, 64为15位, 256为16位.
+ *
+ * 可选的3抽头FIR补偿 y = x + (2x - x[-1] - x[+1])/8 用于抵消CIC通带下垂(延迟一个输出点).
+ *
+ * 输出写回同一半缓冲的开头, 再送入触发采集引擎. 触发电平仍为12位, 触发检测时把输出右移4位比较.
+ * 不依赖HAL, 可在主机上测试.
+ */
+
+#define HIRES_MIN_DECIMATION    4
+#define HIRES_MAX_DECIMATION    256
+
+/* 按扫描时间自动选择抽取比: 慢速时基用更多的位数换取采样率.
+ * 时基分频1~3的扫描时间为5817/2902/1939ms, 对应R=256/256/64. 高分辨率模式下自动滚动不启用
+ * (waveform_roll_update), 这些慢速时基由高分辨率记录显示. */
+#define HIRES_SWEEP_MS_16BIT    2000    /* 扫描不短于该值时R=256 */
+#define HIRES_SWEEP_MS_15BIT    700     /* 扫描不短于该值时R=64, 否则R=16 */
+
+void hires_configure(uint16_t decimation, uint8_t fir);
+uint16_t hires_get_decimation(void);
+uint8_t hires_get_fir(void);
+uint8_t hires_bits(void);
+uint16_t hires_select_decimation(uint32_t sweep_ms);
+void hires_reset(void);
+
+uint16_t hires_process(uint16_t *buf, uint16_t n);
+void hires_push(const uint16_t *samples, uint16_t n);
+int32_t hires_trigger_find(const uint16_t *samples, uint16_t n);
+
+#endif /* __HIRES_H */
@@ -0,0 +1,26 @@
+#ifndef __INTERLEAVE_H
+#define __INTERLEAVE_H
+
+#include <stdint.h>
+
+/* 双ADC快速交替模式的数据处理
+ * ADC1->DR的32位结果中低16位为ADC1, 高16位为ADC2. 快速交替模式下ADC2先采样,
+ * ADC1延迟7个ADC时钟后采样, 因此时间顺序为 ADC2, ADC1, ADC2, ADC1 ...
+ * 两个ADC的增益/偏置略有差异, 以ADC1为基准修正ADC2, 否则波形上会出现2点周期的毛刺.
+ */
+
+#define INTERLEAVE_GAIN_ONE     16384   /* Q14格式的1.0 */
+#define INTERLEAVE_GAIN_MIN     (INTERLEAVE_GAIN_ONE / 2)   /* 估计的增益超出0.5~2.0时不采用 */
+#define INTERLEAVE_GAIN_MAX     (INTERLEAVE_GAIN_ONE * 2)
+
+/* ADC2相对ADC1的修正参数: adc2' = ((adc2 * gain_q14) >> 14) + offset */
+typedef struct {
+    uint16_t gain_q14;
+    int16_t offset;
+} interleave_cal_t;
+
+void interleave_cal_reset(interleave_cal_t *cal);
+uint8_t interleave_estimate(const uint32_t *words, uint16_t count, interleave_cal_t *cal);
+void interleave_unpack(uint32_t *words, uint16_t count, const interleave_cal_t *cal);
+
+#endif /* __INTERLEAVE_H */
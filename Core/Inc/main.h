@@ -53,6 +53,9 @@ extern "C" {
 void Error_Handler(void);
 
 /* USER CODE BEGIN EFP */
+void capture_restart(void);
+void generator_update(void);
+void bode_mode_set(uint8_t mode);
 
 /* USER CODE END EFP */
 
@@ -65,6 +68,8 @@ void Error_Handler(void);
 #define WK_UP_GPIO_Port GPIOA
 #define LCD_BL_Pin GPIO_PIN_0
 #define LCD_BL_GPIO_Port GPIOB
+#define SWEEP_MARK_Pin GPIO_PIN_7
+#define SWEEP_MARK_GPIO_Port GPIOC
 
 /* USER CODE BEGIN Private defines */
 
@@ -14,10 +14,35 @@ typedef struct {
     uint16_t highlight_color;
 } virtual_button_t;
 
+/* 滚动显示方式 */
+typedef enum {
+    ROLL_AUTO = 0,      /* 扫描时间不短于roll_threshold_ms时自动滚动, 高分辨率模式下不滚动 */
+    ROLL_ON,
+    ROLL_OFF,
+    ROLL_MODE_COUNT
+} roll_mode_t;
+
 /* 波形显示相关函数 */
 void init_waveform_display(void);
 void draw_waveform_point(uint16_t dac_value, uint16_t adc_value);
+void draw_waveform_span(uint16_t dac_value, uint16_t adc_min, uint16_t adc_max);
+void draw_waveform_scan(uint16_t dac_value, const uint16_t *adc_values, uint8_t channels);
 void detect_period_and_adjust_timebase(uint16_t dac_value);
+uint16_t waveform_sweep_index(void);
+uint16_t waveform_sweep_length(void);
+uint32_t waveform_sweep_ms(void);
+uint8_t waveform_roll_update(uint8_t auto_allowed);
+void draw_waveform_overlay(const uint16_t *data, uint16_t len, uint16_t count);
+void draw_waveform_roll(uint16_t dac_value, uint16_t adc_value);
+void roll_set_mode(roll_mode_t mode);
+roll_mode_t roll_get_mode(void);
+const char *roll_mode_name(roll_mode_t mode);
+void roll_set_threshold_ms(uint32_t ms);
+uint32_t roll_get_threshold_ms(void);
+void draw_bode_frame(uint32_t f_start_mhz, uint32_t f_stop_mhz);
+void draw_bode_point(uint16_t index, uint32_t freq_mhz, int16_t gain_cdb, int16_t phase_x10);
+
+extern const uint16_t scan_trace_colors[];
 
 /* 虚拟按钮相关函数 */
 void draw_virtual_buttons(void);
@@ -30,4 +55,17 @@ void press_selected_button(void);
 #define WAVE_WIDTH 460
 #define WAVE_START_X 10
 
+/* 扫描节拍: TIM6更新频率78.9Hz, 以0.1Hz为单位 */
+#define WAVE_TICK_HZ_X10 789
+
+/* 波特图增益坐标: 顶端+10dB, 上半区域共80dB */
+#define BODE_DB_TOP 10
+#define BODE_DB_SPAN 80
+
+/* 自动滚动的默认门限: 最慢时基(每列一个节拍)扫描一次约5.8s, 门限取6s, 开机仍为触发扫描;
+ * 扫描时间短于门限的75%才退出滚动. 门限可由roll_set_threshold_ms()调低 */
+#define ROLL_DEFAULT_THRESHOLD_MS 6000
+#define ROLL_MIN_THRESHOLD_MS 500
+#define ROLL_EXIT_PCT 75
+
 #endif /* __OSCILLOSCOPE_H */
\ No newline at end of file
@@ -0,0 +1,21 @@
+#ifndef __PEAK_H
+#define __PEAK_H
+
+#include <stdint.h>
+
+/* 峰值检测采集
+ * 每factor个原始采样归并为一对(min, max), 以 min0,max0,min1,max1... 的形式送入触发采集引擎,
+ * 一条记录的每个采样对对应屏幕上的一列. 抽取比例再大, 窄毛刺也会体现在该列的min/max中.
+ * 不依赖HAL.
+ */
+
+#define PEAK_MAX_FACTOR     256
+
+void peak_configure(uint16_t factor);
+uint16_t peak_get_factor(void);
+void peak_reset(void);
+void peak_push(const uint16_t *samples, uint16_t n);
+int32_t peak_trigger_find(const uint16_t *samples, uint16_t n);
+void peak_minmax(const uint16_t *samples, uint16_t n, uint16_t *min_out, uint16_t *max_out);
+
+#endif /* __PEAK_H */
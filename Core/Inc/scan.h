@@ -0,0 +1,38 @@
+#ifndef __SCAN_H
+#define __SCAN_H
+
+#include <stdint.h>
+
+/* 多通道扫描采集
+ * ADC3扫描模式下一次TIM8触发依次转换规则序列中的N个通道, DMA按 ch0,ch1,...,chN-1,ch0,... 的
+ * 顺序写入. 数据块处理函数按通道拆分到各自的环形缓冲, 并把通道0送入触发采集引擎,
+ * 因此触发仍作用在通道0上, 各通道的记录与通道0的触发记录逐帧对齐.
+ * 半缓冲不一定是N的整数倍, 拆分时保留帧内相位, 跨块连续.
+ *
+ * 通道k比通道0晚k个转换时间采样. 取记录时按 skew_q15(相邻通道间隔占采样周期的比例, Q15)
+ * 对通道k做线性插值, 得到与通道0同一时刻的值.
+ *
+ * RAM占用: 4 * 512 * 2 = 4KB. 不依赖HAL.
+ */
+
+#define SCAN_MAX_CHANNELS   4
+#define SCAN_RING_BITS      9
+#define SCAN_RING_SIZE      (1U << SCAN_RING_BITS)      /* 每通道512点 */
+#define SCAN_RING_MASK      (SCAN_RING_SIZE - 1)
+#define SCAN_CHUNK_FRAMES   32      /* 每次拆分的帧数, 记录完成后最多多写入这么多帧 */
+#define SCAN_MAX_RECORD     (SCAN_RING_SIZE - SCAN_CHUNK_FRAMES - 1)
+
+/* 周期计数器, 用于测量每个数据块的处理耗时 */
+typedef uint32_t (*scan_clock_fn)(void);
+
+void scan_configure(uint8_t channels, uint16_t skew_q15);
+void scan_reset(void);
+void scan_set_clock(scan_clock_fn clock);
+void scan_push(const uint16_t *samples, uint16_t n);
+
+uint8_t scan_channels(void);
+uint16_t scan_skew_q15(void);
+void scan_copy_record(uint8_t ch, uint16_t *dst, uint16_t len);
+uint32_t scan_push_cycles_max(void);
+
+#endif /* __SCAN_H */
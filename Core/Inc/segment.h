@@ -0,0 +1,35 @@
+#ifndef __SEGMENT_H
+#define __SEGMENT_H
+
+#include <stdint.h>
+
+/* 分段存储采集
+ * 采集存储分成K段, 每段保存一条触发记录. 一段完成后在DMA中断中立即用capture_arm_continue()
+ * 重新布防, 不等主循环显示, 连续捕获K个突发事件. 每段记录触发点的采样序号作为时间戳
+ * (采样由TIM8定时触发, 序号乘以采样周期即为时间).
+ * 重新布防的耗时用外部提供的周期计数器(DWT CYCCNT)测量.
+ * 不依赖HAL.
+ */
+
+#define SEGMENT_MEM_SAMPLES     4096    /* 8KB */
+#define SEGMENT_MAX_COUNT       32
+#define SEGMENT_DEFAULT_COUNT   16      /* 默认16段, 每段最多256点 */
+
+/* 周期计数器, 用于测量重新布防耗时 */
+typedef uint32_t (*segment_clock_fn)(void);
+
+void segment_configure(uint16_t count, uint16_t len);
+void segment_set_clock(segment_clock_fn clock);
+void segment_start(void);
+void segment_stop(void);
+void segment_push(const uint16_t *samples, uint16_t n);
+
+uint8_t segment_running(void);
+uint16_t segment_count(void);
+uint16_t segment_done(void);
+uint16_t segment_length(void);
+const uint16_t *segment_data(uint16_t index);
+uint32_t segment_timestamp(uint16_t index);
+uint32_t segment_rearm_cycles_max(void);
+
+#endif /* __SEGMENT_H */
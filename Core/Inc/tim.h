@@ -34,14 +34,21 @@ extern "C" {
 
 extern TIM_HandleTypeDef htim6;
 
+extern TIM_HandleTypeDef htim7;
+
+extern TIM_HandleTypeDef htim8;
+
 /* USER CODE BEGIN Private defines */
 
 /* USER CODE END Private defines */
 
 void MX_TIM6_Init(void);
+void MX_TIM7_Init(void);
+void MX_TIM8_Init(void);
 
 /* USER CODE BEGIN Prototypes */
-
+uint32_t tim8_set_sample_rate(uint32_t rate_hz);
+uint32_t tim7_set_period(uint32_t ticks);
 /* USER CODE END Prototypes */
 
 #ifdef __cplusplus
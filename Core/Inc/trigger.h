@@ -0,0 +1,67 @@
+#ifndef __TRIGGER_H
+#define __TRIGGER_H
+
+#include <stdint.h>
+
+/* 基于ADC采样的触发检测
+ * 边沿: 上升/下降/双边沿; 电平带迟滞: 上升沿要求信号先回到 level-hysteresis 以下,
+ * 下降沿要求信号先回到 level+hysteresis 以上, 噪声在电平附近抖动不会重复触发.
+ * 释抑: 检测到触发后的holdoff个采样内不再触发.
+ * trigger_find()与capture_trigger_fn原型一致, 直接在DMA回调中扫描半缓冲.
+ */
+
+/* 触发边沿 */
+typedef enum {
+    TRIGGER_EDGE_RISING = 0,
+    TRIGGER_EDGE_FALLING,
+    TRIGGER_EDGE_EITHER,
+    TRIGGER_EDGE_COUNT
+} trigger_edge_t;
+
+/* 扫描方式 */
+typedef enum {
+    TRIGGER_SWEEP_AUTO = 0,     /* 一次扫描内未触发则强制触发 */
+    TRIGGER_SWEEP_NORMAL,       /* 只在触发时刷新, 否则保持上一条记录 */
+    TRIGGER_SWEEP_SINGLE,       /* 触发一次后停止, 需重新布防 */
+    TRIGGER_SWEEP_COUNT
+} trigger_sweep_t;
+
+/* 触发检测方式 */
+typedef enum {
+    TRIGGER_SOURCE_SOFTWARE = 0,    /* 逐点比较 */
+    TRIGGER_SOURCE_AWD,             /* ADC模拟看门狗中断标记 + 软件精确定位 */
+    TRIGGER_SOURCE_COUNT
+} trigger_source_t;
+
+#define TRIGGER_DEFAULT_LEVEL       2048
+#define TRIGGER_DEFAULT_HYSTERESIS  32
+#define TRIGGER_LEVEL_STEP          256     /* 电平按钮每次改变的LSB, 约0.2V */
+
+/* 释抑时间(us)换算为采样数 */
+#define TRIGGER_LATENCY_UNKNOWN     0xFFFF  /* trigger_locate(): 过电平点不在本段内, 延迟无法测量 */
+#define TRIGGER_US_TO_SAMPLES(us, rate)  ((uint32_t)((uint64_t)(us) * (rate) / 1000000U))
+
+void trigger_reset(void);
+void trigger_set_edge(trigger_edge_t edge);
+void trigger_set_level(uint16_t level, uint16_t hysteresis);
+void trigger_set_holdoff(uint32_t samples);
+void trigger_set_sweep(trigger_sweep_t sweep);
+void trigger_set_source(trigger_source_t source);
+
+trigger_edge_t trigger_get_edge(void);
+trigger_sweep_t trigger_get_sweep(void);
+trigger_source_t trigger_get_source(void);
+uint16_t trigger_get_level(void);
+uint16_t trigger_get_hysteresis(void);
+uint16_t trigger_get_arm_low(void);
+uint16_t trigger_get_arm_high(void);
+uint32_t trigger_get_holdoff(void);
+const char *trigger_edge_name(trigger_edge_t edge);
+const char *trigger_sweep_name(trigger_sweep_t sweep);
+const char *trigger_source_name(trigger_source_t source);
+
+int32_t trigger_find(const uint16_t *samples, uint16_t n);
+int32_t trigger_refine(const uint16_t *samples, uint16_t from, uint16_t to);
+int32_t trigger_locate(const uint16_t *samples, uint16_t n, uint16_t end, uint16_t *latency);
+
+#endif /* __TRIGGER_H */
@@ -0,0 +1,62 @@
+#ifndef __UI_H
+#define __UI_H
+
+#include <stdint.h>
+
+/* 保留模式的界面元素
+ * 文本框和按钮记住上次画到屏上的内容, 修改时只做标记, ui_flush()只重画有变化的元素:
+ * 文本框逐字符比较新旧内容, 只重画变化的连续字符段, 变短时只清除多出的尾部;
+ * 按钮只在选中状态变化时重画. 内容没有变化时ui_flush()不访问LCD.
+ * 绘制经由ui_backend_t, 固件中接到LCD驱动, 主机上可接到模拟的帧缓冲测试比较逻辑. 不依赖HAL.
+ */
+
+#define UI_TEXT_MAX         64      /* 文本最长字符数(含结尾0) */
+#define UI_MAX_TEXTS        8
+#define UI_MAX_BUTTONS      28
+
+#define UI_BLACK            0x0000
+#define UI_WHITE            0xFFFF
+
+/* 绘制接口, 坐标均含端点 */
+typedef struct {
+    void (*fill)(uint16_t sx, uint16_t sy, uint16_t ex, uint16_t ey, uint16_t color);
+    void (*rect)(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint16_t color);
+    /* 单行文字, 字符宽size/2, 背景色bg */
+    void (*text)(uint16_t x, uint16_t y, uint16_t width, uint8_t size, const char *str, uint16_t color, uint16_t bg);
+} ui_backend_t;
+
+/* 文本框: 标签或数值, 一行, 超出宽度的字符不显示 */
+typedef struct {
+    uint16_t x, y, width;
+    uint8_t size;
+    uint8_t flags;
+    uint16_t color, bg;
+    uint16_t shown_color;
+    char text[UI_TEXT_MAX];     /* 要显示的内容 */
+    char shown[UI_TEXT_MAX];    /* 屏上的内容 */
+} ui_text_t;
+
+/* 按钮: 边框, 背景和居中的文字, 选中时换用高亮色 */
+typedef struct {
+    uint16_t x, y, width, height;
+    const char *text;
+    uint16_t color, highlight;
+    uint16_t text_color, highlight_text;
+    uint16_t border;
+    uint8_t selected;
+    uint8_t flags;
+} ui_button_t;
+
+void ui_init(const ui_backend_t *backend);
+void ui_invalidate(void);
+uint16_t ui_flush(void);
+
+void ui_text_init(ui_text_t *t, uint16_t x, uint16_t y, uint16_t width, uint8_t size, uint16_t color, uint16_t bg);
+void ui_text_set(ui_text_t *t, const char *str);
+void ui_text_set_color(ui_text_t *t, uint16_t color);
+
+void ui_button_init(ui_button_t *b, uint16_t x, uint16_t y, uint16_t width, uint16_t height,
+                    const char *text, uint16_t color, uint16_t highlight);
+void ui_button_select(ui_button_t *b, uint8_t selected);
+
+#endif /* __UI_H */
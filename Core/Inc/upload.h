@@ -0,0 +1,55 @@
+#ifndef __UPLOAD_H
+#define __UPLOAD_H
+
+#include <stdint.h>
+
+/* 任意波形上传
+ * 上位机经USART1分块发送波形点, 固件写入发生器的暂存表, 校验通过后在周期边界整表切换.
+ * 帧格式: 0xA5 0x5A | 命令(1) | 数据长度(2) | 数据 | CRC16(2), 多字节均为小端,
+ * CRC16-CCITT(多项式0x1021, 初值0xFFFF)覆盖命令, 长度和数据.
+ *   'B' 开始: 点数(2), 偶数, 由发生器决定能否接受
+ *   'D' 数据: 起始点(2) + 最多UPLOAD_MAX_CHUNK个点(每点2字节, 0~4095), 必须按顺序发送;
+ *       起始点小于已接收点数时视为重发, 覆盖写入
+ *   'E' 结束: 整表CRC16(2), 按点的小端字节顺序计算, 校验通过后提交
+ *   'A' 放弃
+ * 每帧回复一行 "UPL <命令> <结果> <值>", 值为下一个应发送的起始点(开始/数据帧)或点数(结束帧).
+ * 上位机每发一帧等待回复后再发下一帧, 出错时从回复的起始点重发. 串口同时输出文本日志, 上位机只看UPL开头的行.
+ * upload_feed()不依赖HAL, 可在主机上测试.
+ */
+
+#define UPLOAD_SYNC0            0xA5
+#define UPLOAD_SYNC1            0x5A
+#define UPLOAD_MAX_CHUNK        64      /* 每个数据帧最多的点数 */
+#define UPLOAD_MAX_PAYLOAD      (2 + UPLOAD_MAX_CHUNK * 2)
+#define UPLOAD_MAX_VALUE        4095
+
+typedef enum {
+    UPLOAD_OK = 0,
+    UPLOAD_ERR_CRC,             /* 帧CRC错误 */
+    UPLOAD_ERR_FORMAT,          /* 未知命令或数据长度不对 */
+    UPLOAD_ERR_SEQ,             /* 未开始或起始点不连续 */
+    UPLOAD_ERR_RANGE,           /* 点值超出0~4095或超出表长 */
+    UPLOAD_ERR_BUSY,            /* 发生器拒绝该点数, 或正在换表(稍后重发'B') */
+    UPLOAD_ERR_VERIFY,          /* 点数不足或整表CRC不符 */
+    UPLOAD_STATUS_COUNT
+} upload_status_t;
+
+/* 开始上传: 返回写入的表, NULL为拒绝 */
+typedef uint16_t *(*upload_begin_fn)(uint16_t points);
+/* 结束上传: points为0表示放弃, 否则提交, 返回0为失败 */
+typedef uint8_t (*upload_end_fn)(uint16_t points);
+/* 每帧的回复 */
+typedef void (*upload_reply_fn)(uint8_t cmd, upload_status_t status, uint16_t value);
+
+void upload_init(upload_begin_fn begin, upload_end_fn end, upload_reply_fn reply);
+void upload_feed(const uint8_t *data, uint16_t n);
+void upload_abort(void);
+
+uint8_t upload_active(void);
+uint16_t upload_received(void);
+uint16_t upload_total(void);
+uint32_t upload_frame_errors(void);
+uint16_t upload_crc16(uint16_t crc, const uint8_t *data, uint16_t n);
+const char *upload_status_name(upload_status_t status);
+
+#endif /* __UPLOAD_H */
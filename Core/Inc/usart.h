@@ -35,13 +35,14 @@ extern "C" {
 extern UART_HandleTypeDef huart1;
 
 /* USER CODE BEGIN Private defines */
-
+#define USART_RX_BUF_SIZE   512     /* DMA接收环形缓冲 */
 /* USER CODE END Private defines */
 
 void MX_USART1_UART_Init(void);
 
 /* USER CODE BEGIN Prototypes */
-
+void usart_rx_start(void);
+uint16_t usart_rx_get(const uint8_t **data);
 /* USER CODE END Prototypes */
 
 #ifdef __cplusplus
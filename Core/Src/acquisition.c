@@ -0,0 +1,104 @@
+#include "acquisition.h"
+
+/* DMA循环缓冲, 前半[0, ACQ_HALF_SAMPLES), 后半[ACQ_HALF_SAMPLES, ACQ_DMA_SAMPLES) */
+acq_dma_buf_t acq_dma_buf;
+
+/* 半缓冲状态 - 由ISR置位, 主循环清除 */
+static volatile uint8_t half_ready[2];
+static volatile uint32_t half_seq[2];
+static volatile int8_t half_busy = -1;      /* 主循环正在处理的半区, -1表示无 */
+static volatile uint32_t block_seq = 0;
+static volatile uint32_t dropped_blocks = 0;
+static acq_block_hook_t block_hook = 0;
+
+/* 半区写满 (ISR上下文) */
+static void acq_mark_ready(uint8_t half)
+{
+  /* 上一次的数据还未被取走或正在被处理, 已被DMA覆盖 */
+  if(half_ready[half] || half_busy == (int8_t)half) {
+    dropped_blocks++;
+  }
+
+  /* 需要完整连续数据流的处理(如触发采集)直接在中断中完成, 不受主循环耗时影响 */
+  if(block_hook) {
+    block_hook(&acq_dma_buf.samples[half * ACQ_HALF_SAMPLES], ACQ_HALF_SAMPLES);
+  }
+
+  half_seq[half] = block_seq++;
+  half_ready[half] = 1;
+}
+
+/* 复位数据块交接状态, 在启动DMA之前调用 */
+void acq_stream_reset(void)
+{
+  half_ready[0] = 0;
+  half_ready[1] = 0;
+  half_busy = -1;
+  block_seq = 0;
+  dropped_blocks = 0;
+}
+
+/* 设置中断上下文的数据块处理函数, 传入NULL取消 */
+void acq_set_block_hook(acq_block_hook_t hook)
+{
+  block_hook = hook;
+}
+
+/* DMA半传输完成: 前半缓冲就绪 */
+void acq_on_half_complete(void)
+{
+  acq_mark_ready(0);
+}
+
+/* DMA全传输完成: 后半缓冲就绪 */
+void acq_on_full_complete(void)
+{
+  acq_mark_ready(1);
+}
+
+/* 取出最早就绪的数据块, 返回0表示当前没有可用数据 */
+uint8_t acq_get_block(acq_block_t *blk)
+{
+  uint8_t half;
+
+  if(half_ready[0] && half_ready[1]) {
+    half = ((int32_t)(half_seq[1] - half_seq[0]) < 0) ? 1 : 0;
+  } else if(half_ready[0]) {
+    half = 0;
+  } else if(half_ready[1]) {
+    half = 1;
+  } else {
+    return 0;
+  }
+
+  half_busy = half;
+  half_ready[half] = 0;
+
+  blk->data = &acq_dma_buf.samples[half * ACQ_HALF_SAMPLES];
+  blk->len = ACQ_HALF_SAMPLES;
+  blk->seq = half_seq[half];
+  return 1;
+}
+
+/* 数据块处理完毕 */
+void acq_release_block(void)
+{
+  half_busy = -1;
+}
+
+/* 采集模式名称, 用于界面显示 */
+const char *acq_mode_name(acq_mode_t mode)
+{
+  switch(mode) {
+    case ACQ_MODE_SINGLE:      return "Single";
+    case ACQ_MODE_INTERLEAVED: return "Dual";
+    case ACQ_MODE_SCAN:        return "Scan";
+    default:                   return "?";
+  }
+}
+
+/* 因主循环处理不及时而被覆盖的数据块数 */
+uint32_t acq_dropped_blocks(void)
+{
+  return dropped_blocks;
+}
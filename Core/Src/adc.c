@@ -22,9 +22,153 @@
 
 /* USER CODE BEGIN 0 */
 #include "../../SYSTEM/delay/delay.h"
+#include "acquisition.h"
+#include "interleave.h"
+#include "capture.h"
+#include "trigger.h"
+#include "peak.h"
+#include "ets.h"
+#include "scan.h"
+#include "hires.h"
+#include "tim.h"
+
+static uint8_t adc_acq_running = 0;
+static acq_mode_t adc_acq_mode = ACQ_MODE_SINGLE;
+
+/* 双ADC交替模式的增益/偏置修正, 启动后由半缓冲自动估计; 估计不可信时用后续的半缓冲重试,
+ * 重试ADC_INTERLEAVE_CAL_TRIES次仍不成功则保持单位增益 */
+#define ADC_INTERLEAVE_CAL_TRIES 8
+static interleave_cal_t adc_interleave_cal;
+static volatile uint8_t adc_interleave_cal_pending = 0;
+
+/* 多通道扫描的规则序列: PA1, PA2, PA3, PC0, 使用前adc_scan_count个 */
+static uint32_t adc_scan_list[SCAN_MAX_CHANNELS] = { ADC_CHANNEL_1, ADC_CHANNEL_2, ADC_CHANNEL_3, ADC_CHANNEL_10 };
+static uint8_t adc_scan_count = 2;
+
+/* 1: 单通道采集启动时暂不启动TIM8, 由adc_acq_release()启动, 用于与DAC共用TIM8触发 */
+static uint8_t adc_acq_hold = 0;
+
+/* 模拟看门狗触发状态 */
+#define ADC_AWD_IDLE        0   /* 未使用 */
+#define ADC_AWD_ARMING      1   /* 窗口设在布防门限, 等待信号回到迟滞带之外 */
+#define ADC_AWD_WAITING     2   /* 窗口设在触发电平, 等待过电平 */
+#define ADC_AWD_MARKED      3   /* 已记录触发时的DMA写入位置, 等待数据块处理 */
+
+static uint8_t adc_awd_active = 0;
+static volatile uint8_t adc_awd_phase = ADC_AWD_IDLE;
+static volatile uint16_t adc_awd_mark = 0;      /* 看门狗中断时DMA的写入位置 */
+static uint32_t adc_awd_holdoff_left = 0;
+static uint16_t adc_awd_max_latency = 0;        /* 实测的最大标记延迟(采样点) */
+static uint32_t adc_awd_violations = 0;         /* 延迟超过ADC_AWD_MAX_LATENCY或无法测量的次数 */
+
+/* 等效时间采样触发状态: TIM8 CH1捕获触发信号的过电平时刻 */
+static uint8_t adc_ets_enabled = 0;
+static uint8_t adc_ets_active = 0;
+static volatile uint8_t adc_ets_pending = 0;
+static volatile uint16_t adc_ets_pos = 0;       /* 过电平之后第一个采样在DMA环形缓冲中的位置 */
+static volatile uint16_t adc_ets_frac = 0;      /* 过电平时刻在前一个采样之后的位置, 单位1/factor采样间隔 */
+static uint32_t adc_ets_dropped = 0;            /* 无法确定采样位置而丢弃的捕获次数 */
 /* USER CODE END 0 */
 
+ADC_HandleTypeDef hadc1;
+ADC_HandleTypeDef hadc2;
 ADC_HandleTypeDef hadc3;
+DMA_HandleTypeDef hdma_adc1;
+DMA_HandleTypeDef hdma_adc3;
+
+/* ADC1 init function */
+void MX_ADC1_Init(void)
+{
+
+  /* USER CODE BEGIN ADC1_Init 0 */
+
+  /* USER CODE END ADC1_Init 0 */
+
+  ADC_MultiModeTypeDef multimode = {0};
+  ADC_ChannelConfTypeDef sConfig = {0};
+
+  /* USER CODE BEGIN ADC1_Init 1 */
+
+  /* USER CODE END ADC1_Init 1 */
+
+  /** Common config
+  */
+  hadc1.Instance = ADC1;
+  hadc1.Init.ScanConvMode = ADC_SCAN_DISABLE;
+  hadc1.Init.ContinuousConvMode = ENABLE;
+  hadc1.Init.DiscontinuousConvMode = DISABLE;
+  hadc1.Init.ExternalTrigConv = ADC_SOFTWARE_START;
+  hadc1.Init.DataAlign = ADC_DATAALIGN_RIGHT;
+  hadc1.Init.NbrOfConversion = 1;
+  if (HAL_ADC_Init(&hadc1) != HAL_OK)
+  {
+    Error_Handler();
+  }
+
+  /** Configure the ADC multi-mode
+  */
+  multimode.Mode = ADC_DUALMODE_INTERLFAST;
+  if (HAL_ADCEx_MultiModeConfigChannel(&hadc1, &multimode) != HAL_OK)
+  {
+    Error_Handler();
+  }
+
+  /** Configure Regular Channel
+  */
+  sConfig.Channel = ADC_CHANNEL_1;
+  sConfig.Rank = ADC_REGULAR_RANK_1;
+  sConfig.SamplingTime = ADC_SAMPLETIME_1CYCLE_5;
+  if (HAL_ADC_ConfigChannel(&hadc1, &sConfig) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  /* USER CODE BEGIN ADC1_Init 2 */
+  HAL_ADCEx_Calibration_Start(&hadc1);
+  /* USER CODE END ADC1_Init 2 */
+
+}
+/* ADC2 init function */
+void MX_ADC2_Init(void)
+{
+
+  /* USER CODE BEGIN ADC2_Init 0 */
+
+  /* USER CODE END ADC2_Init 0 */
+
+  ADC_ChannelConfTypeDef sConfig = {0};
+
+  /* USER CODE BEGIN ADC2_Init 1 */
+
+  /* USER CODE END ADC2_Init 1 */
+
+  /** Common config
+  */
+  hadc2.Instance = ADC2;
+  hadc2.Init.ScanConvMode = ADC_SCAN_DISABLE;
+  hadc2.Init.ContinuousConvMode = ENABLE;
+  hadc2.Init.DiscontinuousConvMode = DISABLE;
+  hadc2.Init.ExternalTrigConv = ADC_SOFTWARE_START;
+  hadc2.Init.DataAlign = ADC_DATAALIGN_RIGHT;
+  hadc2.Init.NbrOfConversion = 1;
+  if (HAL_ADC_Init(&hadc2) != HAL_OK)
+  {
+    Error_Handler();
+  }
+
+  /** Configure Regular Channel
+  */
+  sConfig.Channel = ADC_CHANNEL_1;
+  sConfig.Rank = ADC_REGULAR_RANK_1;
+  sConfig.SamplingTime = ADC_SAMPLETIME_1CYCLE_5;
+  if (HAL_ADC_ConfigChannel(&hadc2, &sConfig) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  /* USER CODE BEGIN ADC2_Init 2 */
+  HAL_ADCEx_Calibration_Start(&hadc2);
+  /* USER CODE END ADC2_Init 2 */
+
+}
 
 /* ADC3 init function */
 void MX_ADC3_Init(void)
@@ -46,7 +190,7 @@ void MX_ADC3_Init(void)
   hadc3.Init.ScanConvMode = ADC_SCAN_DISABLE;
   hadc3.Init.ContinuousConvMode = DISABLE;
   hadc3.Init.DiscontinuousConvMode = DISABLE;
-  hadc3.Init.ExternalTrigConv = ADC_SOFTWARE_START;
+  hadc3.Init.ExternalTrigConv = ADC_EXTERNALTRIGCONV_T8_TRGO;
   hadc3.Init.DataAlign = ADC_DATAALIGN_RIGHT;
   hadc3.Init.NbrOfConversion = 1;
   if (HAL_ADC_Init(&hadc3) != HAL_OK)
@@ -58,13 +202,22 @@ void MX_ADC3_Init(void)
   */
   sConfig.Channel = ADC_CHANNEL_1;
   sConfig.Rank = ADC_REGULAR_RANK_1;
-  sConfig.SamplingTime = ADC_SAMPLETIME_239CYCLES_5;
+  sConfig.SamplingTime = ADC_SAMPLETIME_28CYCLES_5;
   if (HAL_ADC_ConfigChannel(&hadc3, &sConfig) != HAL_OK)
   {
     Error_Handler();
   }
   /* USER CODE BEGIN ADC3_Init 2 */
   HAL_ADCEx_Calibration_Start(&hadc3);
+
+  /* 模拟看门狗只监视采集通道, 中断由adc_trigger_rearm()按需打开 */
+  ADC_AnalogWDGConfTypeDef awd_conf = {0};
+  awd_conf.WatchdogMode = ADC_ANALOGWATCHDOG_SINGLE_REG;
+  awd_conf.Channel = ADC_CHANNEL_1;
+  awd_conf.ITMode = DISABLE;
+  awd_conf.HighThreshold = 4095;
+  awd_conf.LowThreshold = 0;
+  HAL_ADC_AnalogWDGConfig(&hadc3, &awd_conf);
   /* USER CODE END ADC3_Init 2 */
 
 }
@@ -73,7 +226,64 @@ void HAL_ADC_MspInit(ADC_HandleTypeDef* adcHandle)
 {
 
   GPIO_InitTypeDef GPIO_InitStruct = {0};
-  if(adcHandle->Instance==ADC3)
+  if(adcHandle->Instance==ADC1)
+  {
+  /* USER CODE BEGIN ADC1_MspInit 0 */
+
+  /* USER CODE END ADC1_MspInit 0 */
+    /* ADC1 clock enable */
+    __HAL_RCC_ADC1_CLK_ENABLE();
+
+    __HAL_RCC_GPIOA_CLK_ENABLE();
+    /**ADC1 GPIO Configuration
+    PA1     ------> ADC1_IN1
+    */
+    GPIO_InitStruct.Pin = GPIO_PIN_1;
+    GPIO_InitStruct.Mode = GPIO_MODE_ANALOG;
+    HAL_GPIO_Init(GPIOA, &GPIO_InitStruct);
+
+    /* ADC1 DMA Init */
+    /* ADC1 Init */
+    hdma_adc1.Instance = DMA1_Channel1;
+    hdma_adc1.Init.Direction = DMA_PERIPH_TO_MEMORY;
+    hdma_adc1.Init.PeriphInc = DMA_PINC_DISABLE;
+    hdma_adc1.Init.MemInc = DMA_MINC_ENABLE;
+    hdma_adc1.Init.PeriphDataAlignment = DMA_PDATAALIGN_WORD;
+    hdma_adc1.Init.MemDataAlignment = DMA_MDATAALIGN_WORD;
+    hdma_adc1.Init.Mode = DMA_CIRCULAR;
+    hdma_adc1.Init.Priority = DMA_PRIORITY_HIGH;
+    if (HAL_DMA_Init(&hdma_adc1) != HAL_OK)
+    {
+      Error_Handler();
+    }
+
+    __HAL_LINKDMA(adcHandle,DMA_Handle,hdma_adc1);
+
+  /* USER CODE BEGIN ADC1_MspInit 1 */
+
+  /* USER CODE END ADC1_MspInit 1 */
+  }
+  else if(adcHandle->Instance==ADC2)
+  {
+  /* USER CODE BEGIN ADC2_MspInit 0 */
+
+  /* USER CODE END ADC2_MspInit 0 */
+    /* ADC2 clock enable */
+    __HAL_RCC_ADC2_CLK_ENABLE();
+
+    __HAL_RCC_GPIOA_CLK_ENABLE();
+    /**ADC2 GPIO Configuration
+    PA1     ------> ADC2_IN1
+    */
+    GPIO_InitStruct.Pin = GPIO_PIN_1;
+    GPIO_InitStruct.Mode = GPIO_MODE_ANALOG;
+    HAL_GPIO_Init(GPIOA, &GPIO_InitStruct);
+
+  /* USER CODE BEGIN ADC2_MspInit 1 */
+
+  /* USER CODE END ADC2_MspInit 1 */
+  }
+  else if(adcHandle->Instance==ADC3)
   {
   /* USER CODE BEGIN ADC3_MspInit 0 */
 
@@ -89,8 +299,36 @@ void HAL_ADC_MspInit(ADC_HandleTypeDef* adcHandle)
     GPIO_InitStruct.Mode = GPIO_MODE_ANALOG;
     HAL_GPIO_Init(GPIOA, &GPIO_InitStruct);
 
+    /* ADC3 DMA Init */
+    /* ADC3 Init */
+    hdma_adc3.Instance = DMA2_Channel5;
+    hdma_adc3.Init.Direction = DMA_PERIPH_TO_MEMORY;
+    hdma_adc3.Init.PeriphInc = DMA_PINC_DISABLE;
+    hdma_adc3.Init.MemInc = DMA_MINC_ENABLE;
+    hdma_adc3.Init.PeriphDataAlignment = DMA_PDATAALIGN_HALFWORD;
+    hdma_adc3.Init.MemDataAlignment = DMA_MDATAALIGN_HALFWORD;
+    hdma_adc3.Init.Mode = DMA_CIRCULAR;
+    hdma_adc3.Init.Priority = DMA_PRIORITY_HIGH;
+    if (HAL_DMA_Init(&hdma_adc3) != HAL_OK)
+    {
+      Error_Handler();
+    }
+
+    __HAL_LINKDMA(adcHandle,DMA_Handle,hdma_adc3);
+
+    /* ADC3 interrupt Init */
+    HAL_NVIC_SetPriority(ADC3_IRQn, 0, 0);
+    HAL_NVIC_EnableIRQ(ADC3_IRQn);
   /* USER CODE BEGIN ADC3_MspInit 1 */
+    /* 多通道扫描的其余输入: PA2 ------> ADC3_IN2, PA3 ------> ADC3_IN3, PC0 ------> ADC3_IN10 */
+    GPIO_InitStruct.Pin = GPIO_PIN_2|GPIO_PIN_3;
+    GPIO_InitStruct.Mode = GPIO_MODE_ANALOG;
+    HAL_GPIO_Init(GPIOA, &GPIO_InitStruct);
+    __HAL_RCC_GPIOC_CLK_ENABLE();
+    GPIO_InitStruct.Pin = GPIO_PIN_0;
+    HAL_GPIO_Init(GPIOC, &GPIO_InitStruct);
 
+    /* 看门狗中断(ADC3_IRQn)优先级高于DMA中断, 保证触发标记先于所在半缓冲的处理 */
   /* USER CODE END ADC3_MspInit 1 */
   }
 }
@@ -98,7 +336,43 @@ void HAL_ADC_MspInit(ADC_HandleTypeDef* adcHandle)
 void HAL_ADC_MspDeInit(ADC_HandleTypeDef* adcHandle)
 {
 
-  if(adcHandle->Instance==ADC3)
+  if(adcHandle->Instance==ADC1)
+  {
+  /* USER CODE BEGIN ADC1_MspDeInit 0 */
+
+  /* USER CODE END ADC1_MspDeInit 0 */
+    /* Peripheral clock disable */
+    __HAL_RCC_ADC1_CLK_DISABLE();
+
+    /**ADC1 GPIO Configuration
+    PA1     ------> ADC1_IN1
+    */
+    HAL_GPIO_DeInit(GPIOA, GPIO_PIN_1);
+
+    /* ADC1 DMA DeInit */
+    HAL_DMA_DeInit(adcHandle->DMA_Handle);
+  /* USER CODE BEGIN ADC1_MspDeInit 1 */
+
+  /* USER CODE END ADC1_MspDeInit 1 */
+  }
+  else if(adcHandle->Instance==ADC2)
+  {
+  /* USER CODE BEGIN ADC2_MspDeInit 0 */
+
+  /* USER CODE END ADC2_MspDeInit 0 */
+    /* Peripheral clock disable */
+    __HAL_RCC_ADC2_CLK_DISABLE();
+
+    /**ADC2 GPIO Configuration
+    PA1     ------> ADC2_IN1
+    */
+    HAL_GPIO_DeInit(GPIOA, GPIO_PIN_1);
+
+  /* USER CODE BEGIN ADC2_MspDeInit 1 */
+
+  /* USER CODE END ADC2_MspDeInit 1 */
+  }
+  else if(adcHandle->Instance==ADC3)
   {
   /* USER CODE BEGIN ADC3_MspDeInit 0 */
 
@@ -111,6 +385,11 @@ void HAL_ADC_MspDeInit(ADC_HandleTypeDef* adcHandle)
     */
     HAL_GPIO_DeInit(GPIOA, GPIO_PIN_1);
 
+    /* ADC3 DMA DeInit */
+    HAL_DMA_DeInit(adcHandle->DMA_Handle);
+
+    /* ADC3 interrupt Deinit */
+    HAL_NVIC_DisableIRQ(ADC3_IRQn);
   /* USER CODE BEGIN ADC3_MspDeInit 1 */
 
   /* USER CODE END ADC3_MspDeInit 1 */
@@ -129,11 +408,449 @@ void adc_channel_set(ADC_HandleTypeDef *adc_handle,uint32_t ch,uint32_t rank,uin
   HAL_ADC_ConfigChannel(adc_handle,&adc_ch_conf);
 }
 
+/* 设置ADC3规则序列, 多于1个通道时使用扫描模式. 只能在ADC3停止时调用 */
+static void adc3_set_sequence(const uint32_t *channels, uint8_t count)
+{
+  uint8_t i;
+
+  hadc3.Init.ScanConvMode = (count > 1) ? ADC_SCAN_ENABLE : ADC_SCAN_DISABLE;
+  hadc3.Init.NbrOfConversion = count;
+  HAL_ADC_Init(&hadc3);
+  for(i = 0; i < count; i++) {
+    adc_channel_set(&hadc3, channels[i], ADC_REGULAR_RANK_1 + i, ADC_SAMPLETIME_28CYCLES_5);
+  }
+}
+
+/**
+ * @brief       启动DMA循环采集
+ *   @note      ACQ_MODE_SINGLE: TIM8 TRGO每个周期触发一次ADC3转换, DMA2通道5按半字写入acq_dma_buf.
+ *              ACQ_MODE_INTERLEAVED: ADC1+ADC2快速交替连续转换, DMA1通道1按32位字写入,
+ *              采样率固定为ACQ_INTERLEAVED_SAMPLE_RATE, rate_hz被忽略.
+ *              ACQ_MODE_SCAN: TIM8每次触发ADC3依次转换adc_scan_set_channels()设置的通道, DMA同单ADC模式,
+ *              rate_hz为每通道采样率, 不超过ACQ_MAX_SAMPLE_RATE/通道数. 数据由scan_push()拆分.
+ *              半传输/全传输回调中标记对应半缓冲就绪, CPU不参与逐点采样.
+ * @param       mode   : 采集模式
+ * @param       rate_hz: 采样率(Hz), 仅单ADC模式有效
+ * @retval      实际采样率(Hz), 0表示启动失败
+ */
+uint32_t adc_acq_start(acq_mode_t mode, uint32_t rate_hz)
+{
+  uint32_t actual_rate;
+
+  adc_acq_stop();
+  acq_stream_reset();
+
+  if(mode == ACQ_MODE_INTERLEAVED) {
+    interleave_cal_reset(&adc_interleave_cal);
+    adc_interleave_cal_pending = ADC_INTERLEAVE_CAL_TRIES;
+
+    /* 从ADC先使能, 主ADC启动后两者按7个ADC时钟错开交替转换 */
+    if(HAL_ADC_Start(&hadc2) != HAL_OK) {
+      return 0;
+    }
+    if(HAL_ADCEx_MultiModeStart_DMA(&hadc1, acq_dma_buf.words, ACQ_DMA_SAMPLES / 2) != HAL_OK) {
+      HAL_ADC_Stop(&hadc2);
+      return 0;
+    }
+    actual_rate = ACQ_INTERLEAVED_SAMPLE_RATE;
+  } else if(mode == ACQ_MODE_SCAN) {
+    if(rate_hz > ACQ_MAX_SAMPLE_RATE / adc_scan_count) rate_hz = ACQ_MAX_SAMPLE_RATE / adc_scan_count;
+    adc3_set_sequence(adc_scan_list, adc_scan_count);
+    actual_rate = tim8_set_sample_rate(rate_hz);
+
+    /* 相邻通道相差一个转换时间, 换算为采样周期的Q15比例 */
+    scan_configure(adc_scan_count,
+                   (uint16_t)((uint64_t)ADC3_CONV_CYCLES * actual_rate * 32768U / SystemCoreClock));
+
+    if(HAL_ADC_Start_DMA(&hadc3, acq_dma_buf.words, ACQ_DMA_SAMPLES) != HAL_OK) {
+      return 0;
+    }
+    HAL_TIM_Base_Start(&htim8);
+  } else {
+    adc3_set_sequence(adc_scan_list, 1);
+    actual_rate = tim8_set_sample_rate(rate_hz);
+
+    if(HAL_ADC_Start_DMA(&hadc3, acq_dma_buf.words, ACQ_DMA_SAMPLES) != HAL_OK) {
+      return 0;
+    }
+    if(!adc_acq_hold) {
+      HAL_TIM_Base_Start(&htim8);
+    }
+    mode = ACQ_MODE_SINGLE;
+  }
+
+  adc_acq_mode = mode;
+  adc_acq_running = 1;
+
+  return actual_rate;
+}
+
+/**
+ * @brief       启动单通道DMA采集, 但先不启动TIM8
+ *   @note      DAC也改由TIM8 TRGO触发时使用: 两边的DMA都准备好后调用adc_acq_release(),
+ *              第一个更新事件同时触发ADC的第0个采样和DAC的第一次输出, 两边的采样序号一一对应.
+ * @param       rate_hz: 采样率(Hz)
+ * @retval      实际采样率(Hz), 0表示启动失败
+ */
+uint32_t adc_acq_start_held(uint32_t rate_hz)
+{
+  uint32_t actual_rate;
+
+  adc_acq_hold = 1;
+  actual_rate = adc_acq_start(ACQ_MODE_SINGLE, rate_hz);
+  adc_acq_hold = 0;
+  return actual_rate;
+}
+
+/* 从0开始计数, 启动adc_acq_start_held()保留的TIM8 */
+void adc_acq_release(void)
+{
+  if(!adc_acq_running || adc_acq_mode != ACQ_MODE_SINGLE) return;
+  __HAL_TIM_SET_COUNTER(&htim8, 0);
+  HAL_TIM_Base_Start(&htim8);
+}
+
+/**
+ * @brief       停止DMA采集
+ * @retval      无
+ */
+void adc_acq_stop(void)
+{
+  if(!adc_acq_running) return;
+
+  if(adc_acq_mode == ACQ_MODE_INTERLEAVED) {
+    HAL_ADCEx_MultiModeStop_DMA(&hadc1);
+    HAL_ADC_Stop(&hadc2);
+  } else {
+    HAL_TIM_Base_Stop(&htim8);
+    HAL_ADC_Stop_DMA(&hadc3);
+    if(adc_acq_mode == ACQ_MODE_SCAN) {
+      adc3_set_sequence(adc_scan_list, 1);    /* 恢复单通道, 供查询方式转换使用 */
+    }
+  }
+  adc_acq_running = 0;
+}
+
+/* 当前采集模式 */
+acq_mode_t adc_acq_get_mode(void)
+{
+  return adc_acq_mode;
+}
+
+/* 双ADC模式: 半缓冲写满后原地解交替, 之后与单ADC模式的数据格式完全相同 */
+static void adc_interleave_half(uint8_t half)
+{
+  uint32_t *words = &acq_dma_buf.words[half * (ACQ_HALF_SAMPLES / 2)];
+
+  if(adc_interleave_cal_pending) {
+    if(interleave_estimate(words, ACQ_HALF_SAMPLES / 2, &adc_interleave_cal)) {
+      adc_interleave_cal_pending = 0;
+    } else {
+      adc_interleave_cal_pending--;
+    }
+  }
+  interleave_unpack(words, ACQ_HALF_SAMPLES / 2, &adc_interleave_cal);
+}
+
+/* DMA半传输完成回调 */
+void HAL_ADC_ConvHalfCpltCallback(ADC_HandleTypeDef *hadc)
+{
+  if(hadc->Instance == ADC3) {
+    acq_on_half_complete();
+  } else if(hadc->Instance == ADC1) {
+    adc_interleave_half(0);
+    acq_on_half_complete();
+  }
+}
+
+/* DMA全传输完成回调 */
+void HAL_ADC_ConvCpltCallback(ADC_HandleTypeDef *hadc)
+{
+  if(hadc->Instance == ADC3) {
+    acq_on_full_complete();
+  } else if(hadc->Instance == ADC1) {
+    adc_interleave_half(1);
+    acq_on_full_complete();
+  }
+}
+
+/* 设置看门狗窗口, 采样落在[low, high]之外时产生中断 */
+static void adc_awd_window(uint16_t low, uint16_t high)
+{
+  hadc3.Instance->LTR = low;
+  hadc3.Instance->HTR = high;
+}
+
+/* 看门狗进入布防阶段: 上升沿等待低于level-hysteresis, 下降沿等待高于level+hysteresis */
+static void adc_awd_arm(void)
+{
+  if(trigger_get_edge() == TRIGGER_EDGE_FALLING) {
+    adc_awd_window(0, trigger_get_arm_high() - 1);
+  } else {
+    adc_awd_window(trigger_get_arm_low() + 1, 4095);
+  }
+  adc_awd_phase = ADC_AWD_ARMING;
+  __HAL_ADC_CLEAR_FLAG(&hadc3, ADC_FLAG_AWD);
+  __HAL_ADC_ENABLE_IT(&hadc3, ADC_IT_AWD);
+}
+
+/**
+ * @brief       模拟看门狗中断回调
+ *   @note      布防阶段触发后把窗口移到触发电平; 过电平阶段触发后记录DMA写入位置并关闭中断.
+ *              过电平的采样是位置adc_awd_mark之前的最后几个采样之一, 由数据块处理时精确定位.
+ */
+void HAL_ADC_LevelOutOfWindowCallback(ADC_HandleTypeDef *hadc)
+{
+  if(hadc->Instance != ADC3) return;
+
+  if(adc_awd_phase == ADC_AWD_ARMING) {
+    if(trigger_get_edge() == TRIGGER_EDGE_FALLING) {
+      adc_awd_window(trigger_get_level() + 1, 4095);
+    } else {
+      adc_awd_window(0, trigger_get_level() - 1);
+    }
+    adc_awd_phase = ADC_AWD_WAITING;
+  } else if(adc_awd_phase == ADC_AWD_WAITING) {
+    adc_awd_mark = ACQ_DMA_SAMPLES - __HAL_DMA_GET_COUNTER(hadc->DMA_Handle);
+    __HAL_ADC_DISABLE_IT(hadc, ADC_IT_AWD);
+    adc_awd_phase = ADC_AWD_MARKED;
+  }
+}
+
+/**
+ * @brief       看门狗触发方式的触发检测函数(capture_trigger_fn)
+ *   @note      samples总是指向acq_dma_buf内部, 由指针差得到它在DMA环形缓冲中的位置.
+ *              用trigger_locate()在整段内找到标记之前最近的过电平点, 标记在本段之后且本段内没有
+ *              过电平点则保留到下一段. 测得的延迟超过ADC_AWD_MAX_LATENCY或无法测量时计入超限次数.
+ *              消耗标记后立即重新布防看门狗.
+ */
+static int32_t adc_awd_trigger_find(const uint16_t *samples, uint16_t n)
+{
+  uint16_t base = samples - acq_dma_buf.samples;
+  uint16_t end, latency;
+  int32_t hit;
+
+  if(adc_awd_holdoff_left > 0) {
+    adc_awd_holdoff_left = (adc_awd_holdoff_left > n) ? (adc_awd_holdoff_left - n) : 0;
+  }
+  if(adc_awd_phase != ADC_AWD_MARKED) return -1;
+
+  /* 过电平采样相对本段起点的最晚位置; 标记在另一半区时视为在本段之后 */
+  end = (adc_awd_mark - 1 - base) & (ACQ_DMA_SAMPLES - 1);
+  hit = trigger_locate(samples, n, end, &latency);
+  if(hit < 0) return -1;
+
+  if(latency == TRIGGER_LATENCY_UNKNOWN || latency > ADC_AWD_MAX_LATENCY) adc_awd_violations++;
+  if(latency != TRIGGER_LATENCY_UNKNOWN && latency > adc_awd_max_latency) adc_awd_max_latency = latency;
+
+  adc_awd_arm();
+
+  /* 释抑期内的触发直接丢弃 */
+  if(adc_awd_holdoff_left > 0) return -1;
+  adc_awd_holdoff_left = trigger_get_holdoff();
+  return hit;
+}
+
+/* 清除旧的捕获并使能TIM8 CH1捕获中断, 等待下一次过电平 */
+static void adc_ets_ic_enable(void)
+{
+  adc_ets_pending = 0;
+  __HAL_TIM_CLEAR_IT(&htim8, TIM_IT_CC1);
+  __HAL_TIM_ENABLE_IT(&htim8, TIM_IT_CC1);
+}
+
+/**
+ * @brief       TIM8输入捕获回调, 等效时间采样时记录过电平时刻
+ *   @note      CCR1为过电平时刻距上一个更新事件(即上一次启动ADC转换)的计数值c, 因此
+ *              frac = c * factor / (ARR+1), 四舍五入. 再由DMA计数和当前CNT推出上一次转换的采样
+ *              在环形缓冲中的位置: 自捕获以来如又发生一次更新(CNT < c), 或距最近一次更新已超过
+ *              ADC3_CONV_CYCLES(转换已写入), DMA计数都已越过对应的采样.
+ *              转换恰在读取时完成的情况无法区分, 该次捕获丢弃, 等待下一次过电平.
+ */
+void HAL_TIM_IC_CaptureCallback(TIM_HandleTypeDef *htim)
+{
+  uint32_t c, cnt, psc, period, elapsed, written;
+  uint16_t pos;
+
+  if(htim->Instance != TIM8 || !adc_ets_active) return;
+
+  c = __HAL_TIM_GET_COMPARE(htim, TIM_CHANNEL_1);
+  cnt = __HAL_TIM_GET_COUNTER(htim);
+  pos = ACQ_DMA_SAMPLES - __HAL_DMA_GET_COUNTER(hadc3.DMA_Handle);
+  if(__HAL_TIM_GET_COUNTER(htim) < cnt) {
+    adc_ets_dropped++;        /* 读取期间发生了更新 */
+    return;
+  }
+
+  psc = htim->Instance->PSC + 1;
+  period = __HAL_TIM_GET_AUTORELOAD(htim) + 1;
+  elapsed = cnt * psc;
+  if(elapsed + ADC_ETS_CONV_MARGIN > ADC3_CONV_CYCLES && elapsed < ADC3_CONV_CYCLES + ADC_ETS_CONV_MARGIN) {
+    adc_ets_dropped++;
+    return;
+  }
+
+  /* 自过电平前的那次转换开始以来已写入DMA缓冲的采样数 */
+  written = ((cnt < c) ? 1 : 0) + ((elapsed >= ADC3_CONV_CYCLES) ? 1 : 0);
+  adc_ets_pos = (pos - written + 1) & (ACQ_DMA_SAMPLES - 1);
+  adc_ets_frac = (c * ets_get_factor() + period / 2) / period;
+  __HAL_TIM_DISABLE_IT(htim, TIM_IT_CC1);
+  adc_ets_pending = 1;
+}
+
+/**
+ * @brief       等效时间采样方式的触发检测函数(capture_trigger_fn)
+ *   @note      捕获位置落在本段数据内即为触发点, 落在之后则保留. 只有触发采集处于等待触发状态时
+ *              才把亚采样偏移交给ets模块, 预触发/后触发阶段的捕获仅被消耗.
+ *              不使用释抑: 每次过电平都是一条有效记录.
+ */
+static int32_t adc_ets_trigger_find(const uint16_t *samples, uint16_t n)
+{
+  uint16_t base = samples - acq_dma_buf.samples;
+  uint16_t rel;
+
+  if(!adc_ets_pending) return -1;
+
+  rel = (adc_ets_pos - base) & (ACQ_DMA_SAMPLES - 1);
+  if(rel >= n) return -1;
+
+  if(capture_state() == CAPTURE_ARMED) {
+    ets_note_trigger(adc_ets_frac);
+  }
+  adc_ets_ic_enable();
+  return rel;
+}
+
+/**
+ * @brief       重新布防触发检测
+ *   @note      选用看门狗方式需要: 设置为TRIGGER_SOURCE_AWD, 单ADC(ADC3)采集正在运行, 单边沿触发,
+ *              且触发采集直接接收DMA缓冲(峰值检测和高分辨率模式关闭). 条件不满足时退回软件逐点检测.
+ *              等效时间采样(adc_trigger_set_ets)优先, 只要求单ADC采集正在运行, 捕获极性跟随触发边沿.
+ *              修改触发参数或采集模式后调用.
+ */
+void adc_trigger_rearm(void)
+{
+  __HAL_ADC_DISABLE_IT(&hadc3, ADC_IT_AWD);
+  adc_awd_phase = ADC_AWD_IDLE;
+  adc_awd_holdoff_left = 0;
+  __HAL_TIM_DISABLE_IT(&htim8, TIM_IT_CC1);
+  adc_ets_pending = 0;
+  trigger_reset();
+
+  adc_ets_active = adc_ets_enabled && adc_acq_running && (adc_acq_mode == ACQ_MODE_SINGLE);
+  adc_awd_active = !adc_ets_active &&
+                   (trigger_get_source() == TRIGGER_SOURCE_AWD) && adc_acq_running &&
+                   (adc_acq_mode == ACQ_MODE_SINGLE) && (trigger_get_edge() != TRIGGER_EDGE_EITHER) &&
+                   (peak_get_factor() <= 1) && (hires_get_decimation() <= 1);
+  if(adc_ets_active) {
+    __HAL_TIM_SET_CAPTUREPOLARITY(&htim8, TIM_CHANNEL_1,
+        (trigger_get_edge() == TRIGGER_EDGE_FALLING) ? TIM_INPUTCHANNELPOLARITY_FALLING : TIM_INPUTCHANNELPOLARITY_RISING);
+    capture_set_trigger(adc_ets_trigger_find);
+    adc_ets_ic_enable();
+  } else if(adc_awd_active) {
+    capture_set_trigger(adc_awd_trigger_find);
+    adc_awd_arm();
+  } else if(hires_get_decimation() > 1 && adc_acq_mode == ACQ_MODE_SINGLE) {
+    capture_set_trigger(hires_trigger_find);
+  } else if(peak_get_factor() > 1 && adc_acq_mode != ACQ_MODE_SCAN) {
+    capture_set_trigger(peak_trigger_find);
+  } else {
+    capture_set_trigger(trigger_find);
+  }
+}
+
+/* 当前是否使用看门狗触发 */
+uint8_t adc_trigger_awd_active(void)
+{
+  return adc_awd_active;
+}
+
+/* 看门狗标记到实际过电平点的最大实测延迟(采样点) */
+uint16_t adc_trigger_awd_latency(void)
+{
+  return adc_awd_max_latency;
+}
+
+/* 看门狗标记延迟超过ADC_AWD_MAX_LATENCY或无法测量的次数 */
+uint32_t adc_trigger_awd_violations(void)
+{
+  return adc_awd_violations;
+}
+
+/* 选择等效时间采样触发(TIM8 CH1捕获), 下一次adc_trigger_rearm()时生效 */
+void adc_trigger_set_ets(uint8_t enable)
+{
+  adc_ets_enabled = enable;
+}
+
+/* 当前是否使用等效时间采样触发 */
+uint8_t adc_trigger_ets_active(void)
+{
+  return adc_ets_active;
+}
+
+/* 因转换恰在捕获时完成而丢弃的捕获次数 */
+uint32_t adc_trigger_ets_dropped(void)
+{
+  return adc_ets_dropped;
+}
+
+/**
+ * @brief       设置多通道扫描的通道列表, 下一次以ACQ_MODE_SCAN启动采集时生效
+ * @param       channels: ADC3通道(ADC_CHANNEL_x), 对应引脚需在MSP中配置为模拟输入
+ * @param       count   : 通道数 1~SCAN_MAX_CHANNELS
+ */
+void adc_scan_set_channels(const uint32_t *channels, uint8_t count)
+{
+  uint8_t i;
+
+  if(count < 1) count = 1;
+  if(count > SCAN_MAX_CHANNELS) count = SCAN_MAX_CHANNELS;
+  for(i = 0; i < count; i++) {
+    adc_scan_list[i] = channels[i];
+  }
+  adc_scan_count = count;
+}
+
+/* 设置扫描通道数, 使用默认通道列表的前count个 */
+void adc_scan_set_count(uint8_t count)
+{
+  if(count < 1) count = 1;
+  if(count > SCAN_MAX_CHANNELS) count = SCAN_MAX_CHANNELS;
+  adc_scan_count = count;
+}
+
+uint8_t adc_scan_get_count(void)
+{
+  return adc_scan_count;
+}
+
+/**
+ * @brief       获取一次ADC转换结果
+ *   @note      DMA采集运行时直接返回DMA缓冲中最新写入的采样点(ch被忽略),
+ *              否则由软件产生一次TIM8更新事件触发转换, 并轮询等待转换完成.
+ */
 uint32_t adc_get_result(uint32_t ch)
 {
+  if(adc_acq_running) {
+    uint32_t pos;
+
+    if(adc_acq_mode == ACQ_MODE_INTERLEAVED) {
+      /* 最新的32位字尚未解交替, 低半字即ADC1的结果 */
+      pos = ACQ_DMA_SAMPLES / 2 - __HAL_DMA_GET_COUNTER(hadc1.DMA_Handle);
+      pos = (pos == 0) ? (ACQ_DMA_SAMPLES / 2 - 1) : (pos - 1);
+      return acq_dma_buf.words[pos] & 0xFFFF;
+    }
+
+    pos = ACQ_DMA_SAMPLES - __HAL_DMA_GET_COUNTER(hadc3.DMA_Handle);
+    pos = (pos == 0) ? (ACQ_DMA_SAMPLES - 1) : (pos - 1);
+    return acq_dma_buf.samples[pos];
+  }
+
   adc_channel_set(&hadc3,ch,ADC_REGULAR_RANK_1,ADC_SAMPLETIME_239CYCLES_5);
 
   HAL_ADC_Start(&hadc3);
+  htim8.Instance->EGR = TIM_EGR_UG;   /* ADC3由TIM8 TRGO触发, 软件产生一次更新事件 */
   HAL_ADC_PollForConversion(&hadc3,10);
   return (uint16_t)HAL_ADC_GetValue(&hadc3);
 }
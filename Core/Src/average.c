@@ -0,0 +1,167 @@
+#include "average.h"
+#include "capture.h"
+
+/* 指数平均的累加器为Q12定点数, 16位的高分辨率记录左移后也不超出int32 */
+#define AVERAGE_EMA_SHIFT   12
+
+static uint32_t avg_acc[AVERAGE_MAX_RECORD];
+static average_mode_t avg_mode = AVERAGE_OFF;
+static uint8_t avg_log2 = 4;
+static uint16_t avg_len = 0;        /* 累加器中记录的长度, 变化时重新开始 */
+static uint16_t avg_count = 0;      /* 已累加的记录数 */
+static volatile uint32_t avg_records = 0;   /* 累加过的记录总数, 显示据此判断是否有新记录 */
+
+/**
+ * @brief       设置平均方式
+ * @param       mode : 平均方式
+ * @param       log2n: 平均次数的以2为底的对数, 1~AVERAGE_MAX_LOG2 (2~256条)
+ */
+void average_configure(average_mode_t mode, uint8_t log2n)
+{
+  if(mode >= AVERAGE_MODE_COUNT) mode = AVERAGE_OFF;
+  if(log2n < 1) log2n = 1;
+  if(log2n > AVERAGE_MAX_LOG2) log2n = AVERAGE_MAX_LOG2;
+
+  avg_mode = mode;
+  avg_log2 = log2n;
+  average_reset();
+}
+
+/* 清空累加器, 触发参数或时基改变后调用 */
+void average_reset(void)
+{
+  avg_len = 0;
+  avg_count = 0;
+}
+
+average_mode_t average_get_mode(void)
+{
+  return avg_mode;
+}
+
+uint8_t average_get_log2(void)
+{
+  return avg_log2;
+}
+
+/* 当前平均结果包含的记录数 */
+uint16_t average_count(void)
+{
+  return avg_count;
+}
+
+/* 累加过的记录总数, 只增不减 */
+uint32_t average_records(void)
+{
+  return avg_records;
+}
+
+/**
+ * @brief       把刚完成的触发记录累加到累加器
+ *   @note      在DMA中断中由average_push()调用, 直接从触发采集的环形缓冲读取
+ * @param       len: 记录长度, 超过AVERAGE_MAX_RECORD的部分不参与平均
+ */
+static void average_add(uint16_t len)
+{
+  uint16_t i;
+
+  if(len > AVERAGE_MAX_RECORD) len = AVERAGE_MAX_RECORD;
+  if(len != avg_len) {
+    avg_len = len;
+    avg_count = 0;
+  }
+
+  if(avg_mode == AVERAGE_EMA) {
+    uint8_t k = avg_log2;
+
+    if(avg_count == 0) {
+      for(i = 0; i < len; i++) {
+        avg_acc[i] = (uint32_t)capture_read(i) << AVERAGE_EMA_SHIFT;
+      }
+    } else {
+      for(i = 0; i < len; i++) {
+        int32_t acc = (int32_t)avg_acc[i];
+        acc += (((int32_t)capture_read(i) << AVERAGE_EMA_SHIFT) - acc) >> k;
+        avg_acc[i] = (uint32_t)acc;
+      }
+    }
+    if(avg_count < (1U << k)) avg_count++;
+  } else {
+    /* AVERAGE_BLOCK: 满N条后下一条记录重新开始 */
+    if(avg_count >= (1U << avg_log2)) {
+      avg_count = 0;
+    }
+    if(avg_count == 0) {
+      for(i = 0; i < len; i++) {
+        avg_acc[i] = capture_read(i);
+      }
+    } else {
+      for(i = 0; i < len; i++) {
+        avg_acc[i] += capture_read(i);
+      }
+    }
+    avg_count++;
+  }
+  avg_records++;
+}
+
+/**
+ * @brief       平均模式的数据块处理函数, 在DMA中断中调用
+ *   @note      与分段采集相同: 每完成一条记录立即累加并重新布防, 继续处理本块剩余的采样,
+ *              两次显示刷新之间完成的记录全部参与平均. 不平均时等同于capture_push().
+ */
+void average_push(const uint16_t *samples, uint16_t n)
+{
+  while(n > 0) {
+    uint16_t used = capture_feed(samples, n);
+
+    samples += used;
+    n -= used;
+
+    if(capture_ready()) {
+      if(avg_mode == AVERAGE_OFF) break;
+      average_add(capture_record_length());
+      capture_arm_continue();
+    } else if(used == 0) {
+      break;      /* 触发采集未布防 */
+    }
+  }
+}
+
+/**
+ * @brief       读出当前的平均结果
+ *   @note      AVERAGE_BLOCK下累计过程中也输出当前的平均值, 显示逐步变平滑.
+ *              累加器在中断中更新, 调用者需在关中断时读取.
+ * @param       record: 输出的记录
+ * @param       len   : 记录长度, 超过累加器中记录长度的部分不改变
+ * @retval      输出的点数, 还没有累加任何记录时为0
+ */
+uint16_t average_read(uint16_t *record, uint16_t len)
+{
+  uint16_t i;
+
+  if(avg_mode == AVERAGE_OFF || avg_count == 0) return 0;
+  if(len > avg_len) len = avg_len;
+
+  if(avg_mode == AVERAGE_EMA) {
+    for(i = 0; i < len; i++) {
+      record[i] = (uint16_t)((avg_acc[i] + (1U << (AVERAGE_EMA_SHIFT - 1))) >> AVERAGE_EMA_SHIFT);
+    }
+  } else if((avg_count & (avg_count - 1)) == 0) {
+    /* 累计次数为2的幂: 直接移位 */
+    uint8_t shift = 0;
+
+    while((1U << shift) < avg_count) shift++;
+    for(i = 0; i < len; i++) {
+      record[i] = (uint16_t)((avg_acc[i] + ((1U << shift) >> 1)) >> shift);
+    }
+  } else {
+    /* 其余次数: 求一次Q24倒数, 逐点乘后移位 */
+    uint32_t recip = ((1UL << 24) + avg_count / 2) / avg_count;
+
+    for(i = 0; i < len; i++) {
+      record[i] = (uint16_t)(((uint64_t)avg_acc[i] * recip + (1UL << 23)) >> 24);
+    }
+  }
+  return len;
+}
@@ -0,0 +1,330 @@
+#include "bode.h"
+#include "dds.h"
+#include <math.h>
+
+#define BODE_LUT_SHIFT      (32 - DDS_LUT_BITS)
+#define BODE_LUT_ROUND      (1U << (BODE_LUT_SHIFT - 1))    /* 相位四舍五入到表点, 参考相位没有半格的系统偏差 */
+#define BODE_QUARTER        0x40000000U                     /* 1/4周期, cos = sin(相位 + 90度) */
+
+typedef enum {
+    BODE_IDLE = 0,
+    BODE_TUNE,                  /* 已设置频率, 等待DDS切换频率字 */
+    BODE_MEASURE                /* 相关窗口已交给中断 */
+} bode_state_t;
+
+/* 频点和结果, 校准值按下标对应 */
+static uint32_t bode_freq[BODE_MAX_POINTS];
+static bode_point_t bode_result[BODE_MAX_POINTS];
+static int16_t bode_cal_gain[BODE_MAX_POINTS];
+static int16_t bode_cal_phase[BODE_MAX_POINTS];
+static uint8_t bode_cal_ok = 0;
+
+static uint32_t bode_f_start = BODE_DEFAULT_START_MHZ;
+static uint32_t bode_f_stop = BODE_DEFAULT_STOP_MHZ;
+static uint16_t bode_npoints = 0;
+static uint16_t bode_index = 0;
+static bode_state_t bode_state = BODE_IDLE;
+static uint16_t bode_ref_amp = 1800;
+static uint32_t bode_step = 0;                      /* 当前频点的频率字 */
+
+/* 相关窗口: 主循环填好后置win_state为1, 中断积分完成后置2, 之后主循环读取累加结果 */
+static volatile uint8_t win_state = 0;
+static uint32_t win_start;                          /* 第一个ADC采样的序号 */
+static uint32_t win_len;                            /* 积分点数, 整数个周期 */
+static uint32_t win_phase;                          /* 第一个采样对应的参考相位 */
+static uint32_t win_pos;                            /* 已积分点数 */
+static int64_t win_xs, win_xc;                      /* sum(x*sin), sum(x*cos) */
+static int64_t win_x, win_s, win_c;                 /* sum(x), sum(sin), sum(cos) */
+
+static volatile uint32_t bode_sample_count = 0;     /* 自bode_start()以来的ADC采样数 */
+
+static bode_clock_fn bode_clock = 0;
+static uint32_t bode_push_cycles = 0;
+static uint32_t bode_push_len = 0;
+
+/**
+ * @brief       设置扫描的频率范围和点数
+ *   @note      频点按对数等间隔分布. 频点改变时直通校准失效.
+ * @param       f_start_mhz: 起始频率, mHz
+ * @param       f_stop_mhz : 终止频率, mHz
+ * @param       points     : 频点数, 2~BODE_MAX_POINTS
+ */
+void bode_configure(uint32_t f_start_mhz, uint32_t f_stop_mhz, uint16_t points)
+{
+  float ratio;
+  uint16_t i;
+
+  if(points < 2) points = 2;
+  if(points > BODE_MAX_POINTS) points = BODE_MAX_POINTS;
+  if(f_start_mhz == 0) f_start_mhz = 1;
+  if(f_stop_mhz == 0) f_stop_mhz = 1;
+
+  bode_f_start = f_start_mhz;
+  bode_f_stop = f_stop_mhz;
+  ratio = logf((float)f_stop_mhz / (float)f_start_mhz) / (points - 1);
+  if(points != bode_npoints) bode_cal_ok = 0;
+  for(i = 0; i < points; i++) {
+    uint32_t f = (i == points - 1) ? f_stop_mhz : (uint32_t)(f_start_mhz * expf(ratio * i) + 0.5f);
+    if(f != bode_freq[i]) bode_cal_ok = 0;
+    bode_freq[i] = f;
+  }
+  bode_npoints = points;
+}
+
+void bode_set_clock(bode_clock_fn clock)
+{
+  bode_clock = clock;
+}
+
+/* 设置第bode_index个频点的频率, 等待DDS切换 */
+static void bode_tune(void)
+{
+  win_state = 0;
+  dds_set_frequency(bode_freq[bode_index]);
+  bode_step = dds_get_tuning_word();
+  bode_state = BODE_TUNE;
+}
+
+/**
+ * @brief       开始一次扫描
+ *   @note      第一次扫描在ADC和DAC的DMA都已准备好, 共用的触发定时器启动之前调用; 之后可在运行中重复调用.
+ *              DDS的采样率应已设为ADC采样率, DDS输出正弦波且没有在扫频.
+ * @param       ref_amp: DDS通道1的幅度设定(dds_set_level的amp), 作为增益的参考
+ */
+void bode_start(uint16_t ref_amp)
+{
+  if(bode_npoints == 0) bode_configure(bode_f_start, bode_f_stop, BODE_DEFAULT_POINTS);
+
+  bode_ref_amp = ref_amp ? ref_amp : 1;
+  bode_push_cycles = 0;
+  bode_push_len = 0;
+  bode_index = 0;
+  bode_tune();
+}
+
+/* 停止测量, ADC采样计数归零. 重新同步启动ADC和DAC之前调用 */
+void bode_stop(void)
+{
+  win_state = 0;
+  bode_state = BODE_IDLE;
+  bode_sample_count = 0;
+}
+
+/**
+ * @brief       单频点DFT相关, 定点
+ *   @note      参考为DDS的Q15正弦表, 每点两次查表, 两次32x32->64乘加和三次32位累加,
+ *              sum(sin)等在块内用32位累加(256点不会溢出), 块结束时并入64位和.
+ * @param       x    : 采样
+ * @param       n    : 点数, 不超过ACQ_HALF_SAMPLES
+ * @param       phase: 第一个采样的参考相位
+ * @param       step : 频率字
+ */
+static void bode_correlate(const uint16_t *x, uint16_t n, uint32_t phase, uint32_t step)
+{
+  const int16_t *lut = dds_sine_table();
+  int64_t xs = win_xs, xc = win_xc;
+  int32_t sx = 0, ss = 0, sc = 0;
+  uint16_t i;
+
+  phase += BODE_LUT_ROUND;
+  for(i = 0; i < n; i++, phase += step) {
+    int32_t v = x[i];
+    int32_t s = lut[phase >> BODE_LUT_SHIFT];
+    int32_t c = lut[(phase + BODE_QUARTER) >> BODE_LUT_SHIFT];
+
+    xs += (int64_t)(v * s);
+    xc += (int64_t)(v * c);
+    sx += v;
+    ss += s;
+    sc += c;
+  }
+  win_xs = xs;
+  win_xc = xc;
+  win_x += sx;
+  win_s += ss;
+  win_c += sc;
+}
+
+/**
+ * @brief       波特图测量的数据块处理函数, 在ADC DMA中断中调用
+ *   @note      主循环布置窗口较晚, 窗口起点已经过去时从本块第一个采样开始, 参考相位相应推进.
+ */
+void bode_push(const uint16_t *samples, uint16_t n)
+{
+  uint32_t first = bode_sample_count;
+
+  bode_sample_count = first + n;
+  if(win_state != 1) return;
+
+  if((int32_t)(first - win_start) > 0) {
+    win_phase += (first - win_start) * bode_step;
+    win_start = first;
+  }
+  if((int32_t)(first + n - win_start) > 0) {
+    uint32_t skip = win_start - first;
+    uint32_t len = n - skip;
+    uint32_t t0 = bode_clock ? bode_clock() : 0;
+
+    if(len > win_len - win_pos) len = win_len - win_pos;
+    bode_correlate(samples + skip, (uint16_t)len, win_phase, bode_step);
+
+    if(bode_clock) {
+      bode_push_cycles = bode_clock() - t0;
+      bode_push_len = len;
+    }
+    win_phase += len * bode_step;
+    win_start += len;
+    win_pos += len;
+    if(win_pos >= win_len) win_state = 2;
+  }
+}
+
+/* 由相关累加结果算出当前频点的增益和相位 */
+static void bode_finish_point(void)
+{
+  float n = (float)win_len;
+  float s = (float)win_xs - (float)win_x * (float)win_s / n;
+  float c = (float)win_xc - (float)win_x * (float)win_c / n;
+  float amp = 2.0f * sqrtf(s * s + c * c) / (n * 32767.0f);
+  float ref = bode_ref_amp * (32767.0f / 65536.0f);
+  float gain = (amp > 0.0f) ? 20.0f * log10f(amp / ref) : -327.0f;
+  bode_point_t *pt = &bode_result[bode_index];
+
+  if(gain > 327.0f) gain = 327.0f;
+  if(gain < -327.0f) gain = -327.0f;
+  pt->freq_mhz = dds_get_frequency();
+  pt->gain_cdb = (int16_t)lrintf(gain * 100.0f);
+  pt->phase_x10 = (int16_t)lrintf(atan2f(c, s) * (1800.0f / 3.14159265f));
+}
+
+/**
+ * @brief       推进测量, 在主循环中调用
+ *   @note      DDS切换频率字后, 由切换点的序号和相位算出稳定时间之后第一个ADC采样的参考相位,
+ *              布置整数个周期的相关窗口; 窗口完成后计算结果并设置下一个频点.
+ * @retval      1: 刚完成一个频点
+ */
+uint8_t bode_poll(void)
+{
+  uint32_t sample, phase, per, periods, settle;
+
+  if(bode_state == BODE_TUNE) {
+    if(dds_get_origin(&sample, &phase) != bode_step) return 0;
+
+    /* 一个周期 2^32/M 点, 积分至少BODE_PERIODS个周期且不少于BODE_MIN_SAMPLES点 */
+    per = (uint32_t)(0xFFFFFFFFU / bode_step);
+    periods = (uint32_t)(((uint64_t)BODE_MIN_SAMPLES * bode_step + 0xFFFFFFFFU) >> 32);
+    if(periods < BODE_PERIODS) periods = BODE_PERIODS;
+    settle = per * BODE_SETTLE_PERIODS;
+    if(settle < BODE_SETTLE_SAMPLES) settle = BODE_SETTLE_SAMPLES;
+
+    win_len = (uint32_t)((((uint64_t)periods << 32) + bode_step / 2) / bode_step);
+    win_start = sample + BODE_DAC_LATENCY + settle;
+    win_phase = phase + settle * bode_step;
+    win_pos = 0;
+    win_xs = win_xc = 0;
+    win_x = win_s = win_c = 0;
+    bode_state = BODE_MEASURE;
+    win_state = 1;
+    return 0;
+  }
+
+  if(bode_state == BODE_MEASURE && win_state == 2) {
+    bode_finish_point();
+    if(++bode_index < bode_npoints) {
+      bode_tune();
+    } else {
+      win_state = 0;
+      bode_state = BODE_IDLE;
+    }
+    return 1;
+  }
+  return 0;
+}
+
+/* 是否正在扫描 */
+uint8_t bode_running(void)
+{
+  return bode_state != BODE_IDLE;
+}
+
+uint16_t bode_points(void)
+{
+  return bode_npoints;
+}
+
+/* 本次扫描已完成的频点数 */
+uint16_t bode_done(void)
+{
+  return bode_index;
+}
+
+uint32_t bode_start_freq(void)
+{
+  return bode_f_start;
+}
+
+uint32_t bode_stop_freq(void)
+{
+  return bode_f_stop;
+}
+
+/**
+ * @brief       取一个频点的结果, 有直通校准时扣除校准值
+ * @param       index: 频点序号
+ * @param       pt   : 输出
+ * @retval      1: 该频点已测量
+ */
+uint8_t bode_get_point(uint16_t index, bode_point_t *pt)
+{
+  if(index >= bode_done()) return 0;
+
+  *pt = bode_result[index];
+  if(bode_cal_ok) {
+    /* 直连时ADC在每个台阶开始后BODE_ADC_SAMPLE_NS采到台阶值, 被测网络看到的是阶梯的基波:
+     * 幅度多了零阶保持的sinc(f/fs), 延迟为半个采样. 相除之后把这两项补回来 */
+    float x = 3.14159265f * pt->freq_mhz / (dds_get_rate() * 1000.0f);
+    float skew = x * (1.0f - 2.0f * BODE_ADC_SAMPLE_NS * 1e-9f * dds_get_rate());
+    int32_t zoh_cdb = (x > 0.0f) ? (int32_t)lrintf(2000.0f * log10f(sinf(x) / x)) : 0;
+    int32_t ph = pt->phase_x10 - bode_cal_phase[index] + (int32_t)lrintf(skew * (1800.0f / 3.14159265f));
+
+    if(ph > 1800) ph -= 3600;
+    if(ph < -1800) ph += 3600;
+    pt->gain_cdb -= bode_cal_gain[index] + zoh_cdb;
+    pt->phase_x10 = (int16_t)ph;
+  }
+  return 1;
+}
+
+/**
+ * @brief       把刚完成的一次扫描保存为直通校准
+ *   @note      ADC输入直接接DAC输出时扫描一次后调用, 以后的结果都相对于这次扫描,
+ *              DAC输出延迟, 建立时间和ADC采样时刻等固定的幅度/相位误差被扣除.
+ */
+void bode_cal_store(void)
+{
+  uint16_t i;
+
+  if(bode_running() || bode_done() < bode_npoints) return;
+  for(i = 0; i < bode_npoints; i++) {
+    bode_cal_gain[i] = bode_result[i].gain_cdb;
+    bode_cal_phase[i] = bode_result[i].phase_x10;
+  }
+  bode_cal_ok = 1;
+}
+
+void bode_cal_clear(void)
+{
+  bode_cal_ok = 0;
+}
+
+uint8_t bode_cal_valid(void)
+{
+  return bode_cal_ok;
+}
+
+/* 最近一块相关运算的每点周期数, x100 */
+uint32_t bode_cycles_per_sample_x100(void)
+{
+  if(bode_push_len == 0) return 0;
+  return bode_push_cycles * 100U / bode_push_len;
+}
@@ -1,62 +1,178 @@
 #include "buttons.h"
 #include "lcd.h"
 #include "oscilloscope.h"
+#include "adc.h"
+#include "dac.h"
+#include "trigger.h"
+#include "peak.h"
+#include "average.h"
+#include "segment.h"
+#include "ets.h"
+#include "scan.h"
+#include "hires.h"
+#include "dds.h"
+#include "bode.h"
+#include "ui.h"
 #include <stdio.h>
 #include <string.h>
 
 /* 虚拟按钮定义 */
 virtual_button_t virtual_buttons[BUTTON_COUNT] = {
-    {20,  750, 80, 30, "Freq+", BLUE, YELLOW},
-    {110, 750, 80, 30, "Freq-", BLUE, YELLOW},
-    {200, 750, 80, 30, "Volt+", RED, YELLOW},
-    {290, 750, 80, 30, "Volt-", RED, YELLOW},
-    {380, 750, 80, 30, "Reset", GRAY, YELLOW}
+    {10,  750, 52, 30, "Freq+", BLUE, YELLOW},
+    {67,  750, 52, 30, "Freq-", BLUE, YELLOW},
+    {124, 750, 52, 30, "Volt+", RED, YELLOW},
+    {181, 750, 52, 30, "Volt-", RED, YELLOW},
+    {238, 750, 52, 30, "Mode", BRRED, YELLOW},
+    {10,  710, 52, 30, "Trig", DARKBLUE, YELLOW},
+    {67,  710, 52, 30, "Edge", DARKBLUE, YELLOW},
+    {124, 710, 52, 30, "Src", DARKBLUE, YELLOW},
+    {181, 710, 52, 30, "Peak", BROWN, YELLOW},
+    {238, 710, 52, 30, "Avg", BROWN, YELLOW},
+    {295, 710, 52, 30, "Roll", BROWN, YELLOW},
+    {295, 750, 52, 30, "Seg", BRRED, YELLOW},
+    {352, 710, 52, 30, "ETS", BRRED, YELLOW},
+    {409, 710, 52, 30, "Chan", BRRED, YELLOW},
+    {352, 750, 52, 30, "HiRes", BRRED, YELLOW},
+    {409, 750, 52, 30, "Reset", GRAY, YELLOW},
+    {10,  100, 52, 30, "Wave", BLUE, YELLOW},
+    {67,  100, 52, 30, "Duty", BLUE, YELLOW},
+    {124, 100, 52, 30, "CH2", BLUE, YELLOW},
+    {181, 100, 52, 30, "Sweep", BLUE, YELLOW},
+    {238, 100, 52, 30, "Bode", BLUE, YELLOW},
+    {295, 100, 52, 30, "HwGen", BLUE, YELLOW},
+    {295, 140, 52, 30, "Level", DARKBLUE, YELLOW},
+    {352, 140, 52, 30, "Hyst", DARKBLUE, YELLOW},
+    {409, 140, 52, 30, "Hold", DARKBLUE, YELLOW},
+    {238, 140, 52, 30, "RollT", BROWN, YELLOW},
+    {352, 100, 52, 30, "Wave2", BLUE, YELLOW}
 };
 
 uint8_t selected_button = 0;
 
+/* DAC输出频率档位(mHz), 按1-2-5步进. 低于1Hz的档位只有DDS方式能输出 */
+static const uint32_t dac_freq_steps[] = {
+    100, 200, 500, 1000, 2000, 5000, 10000, 20000, 50000, 100000, 200000, 500000,
+    1000000, 2000000, 5000000, 10000000, 20000000, 50000000
+};
+
+/* 通道2预设: 相位差(0.1度)和频率倍数, I/Q信号及李萨如图形 */
+static const struct {
+    uint16_t phase;
+    uint8_t ratio;
+} dac_ch2_presets[] = {
+    { 0, 1 }, { 900, 1 }, { 1800, 1 }, { 2700, 1 }, { 900, 2 }, { 900, 3 }
+};
+#define DAC_CH2_PRESET_COUNT (sizeof(dac_ch2_presets) / sizeof(dac_ch2_presets[0]))
+static uint8_t dac_ch2_preset = 0;
+
+/* 扫频预设, 同步标记从PC7输出 */
+static const struct {
+    dds_sweep_kind_t kind;
+    uint32_t f_start_mhz;
+    uint32_t f_stop_mhz;
+    uint32_t duration_ms;
+    uint16_t steps;
+    uint8_t log;
+    const char *name;
+} dac_sweep_presets[] = {
+    { DDS_SWEEP_OFF,   0,       0,        0,    0,  0, "Off" },
+    { DDS_SWEEP_CHIRP, 10000,   20000000, 2000, 11, 1, "Log chirp 10Hz-20kHz 2s" },
+    { DDS_SWEEP_CHIRP, 100000,  10000000, 1000, 11, 0, "Lin chirp 100Hz-10kHz 1s" },
+    { DDS_SWEEP_STEP,  10000,   20000000, 3100, 31, 1, "Log 31 steps 10Hz-20kHz" },
+    { DDS_SWEEP_STEP,  1000000, 10000000, 1000, 10, 0, "Lin 10 steps 1k-10kHz" }
+};
+#define DAC_SWEEP_PRESET_COUNT (sizeof(dac_sweep_presets) / sizeof(dac_sweep_presets[0]))
+static uint8_t dac_sweep_preset = 0;
+
+/* DAC内置发生器预设: 单独输出时幅度和频率沿用Volt/Freq按钮, 叠加时为固定的抖动幅度 */
+static const struct {
+    dac_hwgen_t kind;
+    uint8_t overlay;
+    uint8_t bits;
+    const char *name;
+} dac_hw_presets[] = {
+    { DAC_HWGEN_OFF,      0, 0, "Off" },
+    { DAC_HWGEN_TRIANGLE, 0, 0, "Triangle" },
+    { DAC_HWGEN_NOISE,    0, 0, "Noise" },
+    { DAC_HWGEN_NOISE,    1, 2, "Dither noise 3LSB" },
+    { DAC_HWGEN_NOISE,    1, 4, "Dither noise 15LSB" },
+    { DAC_HWGEN_TRIANGLE, 1, 3, "Dither tri 7LSB" }
+};
+#define DAC_HW_PRESET_COUNT (sizeof(dac_hw_presets) / sizeof(dac_hw_presets[0]))
+static uint8_t dac_hw_preset = 0;
+
+/* 触发迟滞档位(LSB)和释抑档位(us) */
+static const uint16_t trig_hyst_steps[] = { 8, 16, 32, 64, 128 };
+#define TRIG_HYST_STEP_COUNT (sizeof(trig_hyst_steps) / sizeof(trig_hyst_steps[0]))
+static const uint32_t trig_holdoff_steps[] = { 0, 20, 100, 500, 2000, 10000 };
+#define TRIG_HOLDOFF_STEP_COUNT (sizeof(trig_holdoff_steps) / sizeof(trig_holdoff_steps[0]))
+
+/* 自动滚动门限档位(ms), 最后一档高于最慢时基的扫描时间, 即自动方式下不滚动 */
+static const uint32_t roll_threshold_steps[] = { 1000, 2500, 4000, ROLL_DEFAULT_THRESHOLD_MS };
+#define ROLL_THRESHOLD_STEP_COUNT (sizeof(roll_threshold_steps) / sizeof(roll_threshold_steps[0]))
+
+/* 方波占空比档位, 0.1% */
+static const uint16_t dac_duty_steps[] = { 100, 250, 500, 750, 900 };
+#define DAC_FREQ_STEP_COUNT (sizeof(dac_freq_steps) / sizeof(dac_freq_steps[0]))
+
 /* 外部变量声明 */
 extern uint16_t dac_amplitude;
-extern uint16_t dac_frequency_divider;
+extern uint32_t dac_frequency_mhz;
+extern uint8_t dac_wave_sel;
+extern uint16_t dac_duty;
+extern uint8_t dac_ch2_on;
+extern uint8_t dac_ch2_shape;
+extern uint16_t dac_ch2_phase;
+extern uint8_t dac_ch2_ratio;
 extern uint16_t dac_offset;
+extern uint32_t acq_sample_rate;
+extern uint32_t trigger_holdoff_us;
+extern uint8_t segment_mode;
+extern uint16_t segment_view;
+extern uint8_t ets_mode;
+extern uint8_t hires_mode;
+extern uint8_t bode_mode;
+extern uint8_t dac_hw_kind;
+extern uint8_t dac_hw_overlay;
+extern uint8_t dac_hw_bits;
+
+/* 按钮和提示行的界面元素, 只重画有变化的部分 */
+static ui_button_t ui_btn[BUTTON_COUNT];
+static ui_text_t ui_action;
+static ui_text_t ui_help;
+static ui_text_t ui_selected;
+static uint8_t ui_ready = 0;
+
+static void buttons_ui_init(void)
+{
+    for(int i = 0; i < BUTTON_COUNT; i++) {
+        ui_button_init(&ui_btn[i], virtual_buttons[i].x, virtual_buttons[i].y,
+                       virtual_buttons[i].width, virtual_buttons[i].height, virtual_buttons[i].text,
+                       virtual_buttons[i].color, virtual_buttons[i].highlight_color);
+    }
+    ui_text_init(&ui_action, 20, 660, 450, 16, BLUE, WHITE);
+    ui_text_init(&ui_help, 20, 680, 280, 16, BLACK, WHITE);
+    ui_text_init(&ui_selected, 300, 680, 150, 16, BLUE, WHITE);
+    ui_text_set(&ui_help, "KEY0: Select   KEY1: Press");
+    ui_ready = 1;
+}
 
 /* 绘制虚拟按钮 */
 void draw_virtual_buttons(void)
 {
+    char selected_str[50];
+    
+    if(!ui_ready) buttons_ui_init();
+    
     for(int i = 0; i < BUTTON_COUNT; i++) {
-        uint16_t bg_color = (i == selected_button) ? virtual_buttons[i].highlight_color : virtual_buttons[i].color;
-        uint16_t text_color = (i == selected_button) ? BLACK : WHITE;
-        
-        /* 绘制按钮背景 */
-        lcd_fill(virtual_buttons[i].x, virtual_buttons[i].y, 
-                 virtual_buttons[i].x + virtual_buttons[i].width, 
-                 virtual_buttons[i].y + virtual_buttons[i].height, 
-                 bg_color);
-        
-        /* 绘制按钮边框 */
-        lcd_draw_line(virtual_buttons[i].x, virtual_buttons[i].y, 
-                      virtual_buttons[i].x + virtual_buttons[i].width, virtual_buttons[i].y, BLACK);
-        lcd_draw_line(virtual_buttons[i].x, virtual_buttons[i].y, 
-                      virtual_buttons[i].x, virtual_buttons[i].y + virtual_buttons[i].height, BLACK);
-        lcd_draw_line(virtual_buttons[i].x + virtual_buttons[i].width, virtual_buttons[i].y, 
-                      virtual_buttons[i].x + virtual_buttons[i].width, virtual_buttons[i].y + virtual_buttons[i].height, BLACK);
-        lcd_draw_line(virtual_buttons[i].x, virtual_buttons[i].y + virtual_buttons[i].height, 
-                      virtual_buttons[i].x + virtual_buttons[i].width, virtual_buttons[i].y + virtual_buttons[i].height, BLACK);
-        
-        /* 绘制按钮文字 */
-        uint16_t text_x = virtual_buttons[i].x + (virtual_buttons[i].width - strlen(virtual_buttons[i].text) * 8) / 2;
-        uint16_t text_y = virtual_buttons[i].y + (virtual_buttons[i].height - 16) / 2;
-        lcd_show_string(text_x, text_y, virtual_buttons[i].width, 16, 16, virtual_buttons[i].text, text_color);
+        ui_button_select(&ui_btn[i], i == selected_button);
     }
     
-    /* 显示操作说明 */
-    lcd_fill(20, 720, 450, 740, WHITE);
-    lcd_show_string(20, 720, 300, 16, 16, "KEY0: Select   KEY1: Press", BLACK);
-    
     /* 显示当前选中的按钮 */
-    char selected_str[50];
     sprintf(selected_str, "Selected: %s", virtual_buttons[selected_button].text);
-    lcd_show_string(300, 720, 150, 16, 16, selected_str, BLUE);
+    ui_text_set(&ui_selected, selected_str);
+    
+    ui_flush();
 }
 
 /* 切换选中的按钮 */
@@ -71,20 +187,41 @@ void press_selected_button(void)
 {
     char action_str[50] = "";
     
+    /* 改变采集模式或发生器输出方式的按钮先退出波特图测量 */
+    if(bode_mode && (selected_button == 4 || (selected_button >= 11 && selected_button <= 19) || selected_button == 21 ||
+                     selected_button == 26)) {
+        bode_mode_set(0);
+    }
+    
+    /* 选择DMA输出波形的按钮退出内置发生器的单独输出, 叠加的抖动保留 */
+    if(dac_hw_kind != DAC_HWGEN_OFF && !dac_hw_overlay &&
+       ((selected_button >= 16 && selected_button <= 19) || selected_button == 26)) {
+        dac_hw_preset = 0;
+        dac_hw_kind = DAC_HWGEN_OFF;
+    }
+    
     switch(selected_button) {
         case 0:  /* Freq+ */
-            if(dac_frequency_divider > 1) {
-                dac_frequency_divider--;
-                sprintf(action_str, "Freq+ Applied: %d", dac_frequency_divider);
+            if(dac_frequency_mhz < dac_freq_steps[DAC_FREQ_STEP_COUNT - 1]) {
+                uint8_t i = 0;
+                while(dac_freq_steps[i] <= dac_frequency_mhz) i++;
+                dac_frequency_mhz = dac_freq_steps[i];
+                generator_update();
+                sprintf(action_str, "Freq+ Applied: %lu.%03luHz", dac_wave_get_frequency() / 1000U,
+                        dac_wave_get_frequency() % 1000U);
             } else {
                 sprintf(action_str, "Freq+ Max reached");
             }
             break;
             
         case 1:  /* Freq- */
-            if(dac_frequency_divider < 32) {
-                dac_frequency_divider++;
-                sprintf(action_str, "Freq- Applied: %d", dac_frequency_divider);
+            if(dac_frequency_mhz > dac_freq_steps[0]) {
+                uint8_t i = DAC_FREQ_STEP_COUNT - 1;
+                while(dac_freq_steps[i] >= dac_frequency_mhz) i--;
+                dac_frequency_mhz = dac_freq_steps[i];
+                generator_update();
+                sprintf(action_str, "Freq- Applied: %lu.%03luHz", dac_wave_get_frequency() / 1000U,
+                        dac_wave_get_frequency() % 1000U);
             } else {
                 sprintf(action_str, "Freq- Min reached");
             }
@@ -93,6 +230,7 @@ void press_selected_button(void)
         case 2:  /* Volt+ */
             if(dac_amplitude < 3600) {
                 dac_amplitude += 200;
+                generator_update();
                 sprintf(action_str, "Volt+ Applied: %d", dac_amplitude);
             } else {
                 sprintf(action_str, "Volt+ Max reached");
@@ -102,28 +240,406 @@ void press_selected_button(void)
         case 3:  /* Volt- */
             if(dac_amplitude > 400) {
                 dac_amplitude -= 200;
+                generator_update();
                 sprintf(action_str, "Volt- Applied: %d", dac_amplitude);
             } else {
                 sprintf(action_str, "Volt- Min reached");
             }
             break;
             
-        case 4:  /* Reset */
+        case 4:  /* Mode - 切换采集模式 */
+        {
+            acq_mode_t next = (acq_mode_t)((adc_acq_get_mode() + 1) % ACQ_MODE_COUNT);
+            if(next == ACQ_MODE_SCAN) {
+                /* 多通道扫描只支持普通触发记录 */
+                peak_configure(1);
+                ets_mode = 0;
+                hires_mode = 0;
+                if(segment_mode) {
+                    segment_stop();
+                    segment_mode = 0;
+                }
+            }
+            acq_sample_rate = adc_acq_start(next, ACQ_DEFAULT_SAMPLE_RATE);
+            capture_restart();      /* 看门狗触发只在单ADC模式下可用 */
+            average_reset();
+            init_waveform_display();
+            if(next == ACQ_MODE_SCAN) {
+                sprintf(action_str, "Mode: Scan %dch %luS/s/ch", adc_scan_get_count(), acq_sample_rate);
+            } else {
+                sprintf(action_str, "Mode: %s %luS/s", acq_mode_name(next), acq_sample_rate);
+            }
+            break;
+        }
+            
+        case 5:  /* Trig - 切换扫描方式 Auto/Normal/Single, 并重新布防 */
+        {
+            trigger_sweep_t next = (trigger_sweep_t)((trigger_get_sweep() + 1) % TRIGGER_SWEEP_COUNT);
+            trigger_set_sweep(next);
+            capture_restart();
+            average_reset();
+            sprintf(action_str, "Trigger: %s", trigger_sweep_name(next));
+            break;
+        }
+            
+        case 6:  /* Edge - 切换触发边沿 */
+        {
+            trigger_edge_t next = (trigger_edge_t)((trigger_get_edge() + 1) % TRIGGER_EDGE_COUNT);
+            trigger_set_edge(next);
+            capture_restart();
+            average_reset();
+            sprintf(action_str, "Edge: %s", trigger_edge_name(next));
+            break;
+        }
+            
+        case 7:  /* Src - 切换软件/看门狗触发 */
+        {
+            trigger_source_t next = (trigger_source_t)((trigger_get_source() + 1) % TRIGGER_SOURCE_COUNT);
+            trigger_set_source(next);
+            capture_restart();
+            average_reset();
+            if(next == TRIGGER_SOURCE_AWD && !adc_trigger_awd_active()) {
+                sprintf(action_str, "Source: AWD n/a, using SW");
+            } else {
+                sprintf(action_str, "Source: %s", trigger_source_name(next));
+            }
+            break;
+        }
+            
+        case 8:  /* Peak - 峰值检测抽取比例 关/4/16/64/256 */
+        {
+            uint16_t factor = peak_get_factor() * 4;
+            if(factor > PEAK_MAX_FACTOR) factor = 1;
+            peak_configure(factor);
+            if(factor > 1) {
+                ets_mode = 0;
+                hires_mode = 0;
+            }
+            capture_restart();
+            average_reset();
+            if(factor > 1) {
+                sprintf(action_str, "Peak detect: 1/%d", factor);
+            } else {
+                sprintf(action_str, "Peak detect: Off");
+            }
+            break;
+        }
+            
+        case 9:  /* Avg - 平均方式 关/4/16/64/256次/指数1/8/指数1/32 */
+        {
+            static const uint8_t avg_steps[][2] = {
+                {AVERAGE_OFF, 0}, {AVERAGE_BLOCK, 2}, {AVERAGE_BLOCK, 4}, {AVERAGE_BLOCK, 6},
+                {AVERAGE_BLOCK, 8}, {AVERAGE_EMA, 3}, {AVERAGE_EMA, 5}
+            };
+            static uint8_t avg_step = 0;
+            
+            avg_step = (avg_step + 1) % (sizeof(avg_steps) / sizeof(avg_steps[0]));
+            average_configure((average_mode_t)avg_steps[avg_step][0], avg_steps[avg_step][1]);
+            capture_restart();      /* 平均开/关时切换数据块处理函数 */
+            if(average_get_mode() == AVERAGE_BLOCK) {
+                sprintf(action_str, "Average: %d records", 1 << average_get_log2());
+            } else if(average_get_mode() == AVERAGE_EMA) {
+                sprintf(action_str, "Average: EMA 1/%d", 1 << average_get_log2());
+            } else {
+                sprintf(action_str, "Average: Off");
+            }
+            break;
+        }
+            
+        case 10: /* Roll - 滚动显示 自动/开/关 */
+        {
+            roll_mode_t next = (roll_mode_t)((roll_get_mode() + 1) % ROLL_MODE_COUNT);
+            roll_set_mode(next);
+            if(next == ROLL_AUTO) {
+                sprintf(action_str, "Roll: Auto (>=%lums)", roll_get_threshold_ms());
+            } else {
+                sprintf(action_str, "Roll: %s", roll_mode_name(next));
+            }
+            break;
+        }
+            
+        case 11: /* Seg - 分段采集: 开始 -> 逐段浏览 -> 叠加显示 -> 关闭 */
+            if(!segment_mode && adc_acq_get_mode() == ACQ_MODE_SCAN) {
+                sprintf(action_str, "Segmented: n/a in Scan");
+            } else if(!segment_mode) {
+                peak_configure(1);      /* 分段记录保存原始采样 */
+                ets_mode = 0;
+                hires_mode = 0;
+                segment_mode = 1;
+                segment_view = 0;
+                capture_restart();
+                sprintf(action_str, "Segmented: capturing %d", SEGMENT_DEFAULT_COUNT);
+            } else if(segment_running()) {
+                segment_stop();
+                segment_mode = 0;
+                capture_restart();
+                init_waveform_display();
+                sprintf(action_str, "Segmented: aborted");
+            } else if(segment_view < segment_count()) {
+                segment_view++;
+                if(segment_view < segment_done()) {
+                    sprintf(action_str, "Segment %d/%d", segment_view + 1, segment_done());
+                } else {
+                    segment_view = segment_count();
+                    sprintf(action_str, "Segments: overlay");
+                }
+            } else {
+                segment_mode = 0;
+                capture_restart();
+                init_waveform_display();
+                sprintf(action_str, "Segmented: Off");
+            }
+            break;
+            
+        case 12: /* ETS - 等效时间采样 关/10x/25x/50x */
+        {
+            static const uint8_t ets_steps[] = { 0, 10, 25, 50 };
+            static uint8_t ets_step = 0;
+            
+            ets_step = (ets_step + 1) % sizeof(ets_steps);
+            ets_mode = ets_steps[ets_step];
+            if(ets_mode) {
+                /* 等效采样需要单ADC(TIM8定时)采集, 记录保存原始采样 */
+                peak_configure(1);
+                hires_mode = 0;
+                if(segment_mode) {
+                    segment_stop();
+                    segment_mode = 0;
+                }
+                if(adc_acq_get_mode() != ACQ_MODE_SINGLE) {
+                    acq_sample_rate = adc_acq_start(ACQ_MODE_SINGLE, ACQ_DEFAULT_SAMPLE_RATE);
+                }
+            }
+            capture_restart();
+            average_reset();
+            init_waveform_display();
+            if(ets_mode) {
+                sprintf(action_str, "ETS: x%d, %luS/s eq (trig in PC6)", ets_mode, acq_sample_rate * ets_mode);
+            } else {
+                sprintf(action_str, "ETS: Off");
+            }
+            break;
+        }
+            
+        case 13: /* Chan - 扫描通道数 2/3/4 */
+        {
+            uint8_t count = adc_scan_get_count() + 1;
+            if(count > SCAN_MAX_CHANNELS) count = 2;
+            adc_scan_set_count(count);
+            if(adc_acq_get_mode() == ACQ_MODE_SCAN) {
+                acq_sample_rate = adc_acq_start(ACQ_MODE_SCAN, ACQ_DEFAULT_SAMPLE_RATE);
+                capture_restart();
+                init_waveform_display();
+            }
+            sprintf(action_str, "Scan channels: %d", count);
+            break;
+        }
+            
+        case 14: /* HiRes - 过采样高分辨率 关/CIC/CIC+FIR */
+            hires_mode = (hires_mode + 1) % 3;
+            if(hires_mode) {
+                /* ADC以最高采样率运行, 抽取比随扫描时间自动选择 */
+                peak_configure(1);
+                ets_mode = 0;
+                if(segment_mode) {
+                    segment_stop();
+                    segment_mode = 0;
+                }
+                if(adc_acq_get_mode() != ACQ_MODE_SINGLE || acq_sample_rate != ACQ_MAX_SAMPLE_RATE) {
+                    acq_sample_rate = adc_acq_start(ACQ_MODE_SINGLE, ACQ_MAX_SAMPLE_RATE);
+                }
+            } else {
+                acq_sample_rate = adc_acq_start(ACQ_MODE_SINGLE, ACQ_DEFAULT_SAMPLE_RATE);
+            }
+            capture_restart();
+            average_reset();
+            init_waveform_display();
+            if(hires_mode) {
+                sprintf(action_str, "HiRes: R%d %dbit%s", hires_get_decimation(), hires_bits(),
+                        (hires_mode == 2) ? " +FIR" : "");
+            } else {
+                sprintf(action_str, "HiRes: Off");
+            }
+            break;
+            
+        case 15: /* Reset */
             dac_amplitude = 1800;
-            dac_frequency_divider = 8;
+            dac_frequency_mhz = DAC_DEFAULT_FREQ_HZ * 1000U;
             dac_offset = 2048;
+            dac_wave_sel = DDS_TRIANGLE;
+            dac_duty = 500;
+            dac_ch2_on = 0;
+            dac_ch2_shape = DDS_SINE;
+            dac_sweep_preset = 0;
+            dac_hw_preset = 0;
+            dac_hw_kind = DAC_HWGEN_OFF;
+            dac_hw_overlay = 0;
+            dds_sweep_stop();
+            generator_update();
             sprintf(action_str, "Reset Applied");
             init_waveform_display();
             break;
             
+        case 16: /* Wave - DDS正弦/三角/锯齿/方波, 固定正弦波形表, 有上传的波形时再加一档任意波形 */
+            dac_wave_sel = (dac_wave_sel + 1) % (DDS_SHAPE_COUNT + (dac_arb_length() ? 2 : 1));
+            generator_update();
+            if(dac_dds_active()) {
+                uint32_t cyc = dds_cycles_per_sample_x100();
+                sprintf(action_str, "Wave: DDS %s %lu.%02lu cyc/pt", dds_shape_name(dds_get_shape(0)),
+                        cyc / 100U, cyc % 100U);
+            } else if(dac_wave_get_shape() == DAC_SHAPE_ARB) {
+                sprintf(action_str, "Wave: Arb %u pts", dac_wave_get_length());
+            } else {
+                sprintf(action_str, "Wave: Table sine %u pts", dac_wave_get_length());
+            }
+            break;
+            
+        case 17: /* Duty - 方波占空比 */
+            {
+                uint8_t i = 0;
+                while(i < sizeof(dac_duty_steps) / sizeof(dac_duty_steps[0]) && dac_duty_steps[i] <= dac_duty) i++;
+                dac_duty = (i < sizeof(dac_duty_steps) / sizeof(dac_duty_steps[0])) ? dac_duty_steps[i] : dac_duty_steps[0];
+            }
+            generator_update();
+            sprintf(action_str, "Duty: %u.%u%%%s", dac_duty / 10, dac_duty % 10,
+                    (dac_wave_sel == DDS_SQUARE) ? "" : " (Square only)");
+            break;
+            
+        case 18: /* CH2 - 关闭, 或按预设相位差/频率倍数在PA5输出, 波形由Wave2选择 */
+            if(!dac_ch2_on) {
+                dac_ch2_on = 1;
+                dac_ch2_preset = 0;
+            } else if(++dac_ch2_preset >= DAC_CH2_PRESET_COUNT) {
+                dac_ch2_on = 0;
+            }
+            dac_ch2_phase = dac_ch2_presets[dac_ch2_preset].phase;
+            dac_ch2_ratio = dac_ch2_presets[dac_ch2_preset].ratio;
+            if(dac_ch2_on && dac_wave_sel >= DDS_SHAPE_COUNT) {
+                dac_wave_sel = DDS_SINE;     /* 双通道只在DDS方式下输出 */
+            }
+            generator_update();
+            if(dac_ch2_on) {
+                uint32_t cyc = dds_cycles_per_sample_x100();
+                sprintf(action_str, "CH2: %s x%u %u.%udeg %lu.%02lu cyc/pt",
+                        dds_shape_name((dds_shape_t)dac_ch2_shape), dac_ch2_ratio,
+                        dac_ch2_phase / 10, dac_ch2_phase % 10, cyc / 100U, cyc % 100U);
+            } else {
+                sprintf(action_str, "CH2: Off");
+            }
+            break;
+            
+        case 19: /* Sweep - 扫频, 只在DDS方式下 */
+            dac_sweep_preset = (dac_sweep_preset + 1) % DAC_SWEEP_PRESET_COUNT;
+            if(dac_sweep_presets[dac_sweep_preset].kind == DDS_SWEEP_OFF) {
+                dds_sweep_stop();
+            } else {
+                if(dac_wave_sel >= DDS_SHAPE_COUNT) {
+                    dac_wave_sel = DDS_SINE;
+                    generator_update();
+                }
+                dds_sweep_start(dac_sweep_presets[dac_sweep_preset].kind,
+                                dac_sweep_presets[dac_sweep_preset].f_start_mhz,
+                                dac_sweep_presets[dac_sweep_preset].f_stop_mhz,
+                                dac_sweep_presets[dac_sweep_preset].duration_ms,
+                                dac_sweep_presets[dac_sweep_preset].steps,
+                                dac_sweep_presets[dac_sweep_preset].log, DAC_DDS_HALF);
+            }
+            sprintf(action_str, "Sweep: %s", dac_sweep_presets[dac_sweep_preset].name);
+            break;
+            
+        case 20: /* Bode - 波特图: 关闭 -> 连续扫描 -> 直通校准 -> 关闭 */
+            dac_sweep_preset = 0;
+            bode_mode_set((bode_mode + 1) % 3);
+            if(bode_mode == 1) {
+                sprintf(action_str, "Bode: %u pts %lu-%luHz%s", bode_points(), bode_start_freq() / 1000U,
+                        bode_stop_freq() / 1000U, bode_cal_valid() ? " (cal)" : "");
+            } else if(bode_mode == 2) {
+                sprintf(action_str, "Bode: Cal, wire DAC->ADC thru");
+            } else {
+                sprintf(action_str, "Bode: Off");
+            }
+            break;
+            
+        case 21: /* HwGen - DAC内置三角波/噪声发生器: 单独输出或叠加在DMA输出上作抖动 */
+            dac_hw_preset = (dac_hw_preset + 1) % DAC_HW_PRESET_COUNT;
+            dac_hw_kind = dac_hw_presets[dac_hw_preset].kind;
+            dac_hw_overlay = dac_hw_presets[dac_hw_preset].overlay;
+            if(dac_hw_overlay) {
+                dac_hw_bits = dac_hw_presets[dac_hw_preset].bits;
+            }
+            if(dac_hw_kind != DAC_HWGEN_OFF && !dac_hw_overlay) {
+                dac_sweep_preset = 0;
+                dds_sweep_stop();
+            }
+            generator_update();
+            if(dac_hwgen_active()) {
+                sprintf(action_str, "HwGen: %s %lu.%03luHz %luS/s", dac_hw_presets[dac_hw_preset].name,
+                        dac_wave_get_frequency() / 1000U, dac_wave_get_frequency() % 1000U, dac_wave_get_rate());
+            } else {
+                sprintf(action_str, "HwGen: %s", dac_hw_presets[dac_hw_preset].name);
+            }
+            break;
+            
+        case 22: /* Level - 触发电平按TRIGGER_LEVEL_STEP递增, 超过满量程回到最低档 */
+        {
+            uint16_t level = trigger_get_level() + TRIGGER_LEVEL_STEP;
+            if(level > 4095) level = TRIGGER_LEVEL_STEP;
+            trigger_set_level(level, trigger_get_hysteresis());
+            capture_restart();
+            average_reset();
+            sprintf(action_str, "Level: %u (%lumV)", level, (uint32_t)level * 3300U / 4095U);
+            break;
+        }
+            
+        case 23: /* Hyst - 触发迟滞宽度 */
+        {
+            uint8_t i = 0;
+            while(i < TRIG_HYST_STEP_COUNT && trig_hyst_steps[i] <= trigger_get_hysteresis()) i++;
+            if(i >= TRIG_HYST_STEP_COUNT) i = 0;
+            trigger_set_level(trigger_get_level(), trig_hyst_steps[i]);
+            capture_restart();
+            average_reset();
+            sprintf(action_str, "Hysteresis: +/-%u LSB", trig_hyst_steps[i]);
+            break;
+        }
+            
+        case 24: /* Hold - 触发释抑时间, 按当前采样率换算为采样数 */
+        {
+            uint8_t i = 0;
+            while(i < TRIG_HOLDOFF_STEP_COUNT && trig_holdoff_steps[i] <= trigger_holdoff_us) i++;
+            if(i >= TRIG_HOLDOFF_STEP_COUNT) i = 0;
+            trigger_holdoff_us = trig_holdoff_steps[i];
+            capture_restart();
+            average_reset();
+            sprintf(action_str, "Holdoff: %luus (%lu samples)", trigger_holdoff_us, trigger_get_holdoff());
+            break;
+        }
+            
+        case 25: /* RollT - 自动滚动门限 */
+        {
+            uint8_t i = 0;
+            while(i < ROLL_THRESHOLD_STEP_COUNT && roll_threshold_steps[i] <= roll_get_threshold_ms()) i++;
+            if(i >= ROLL_THRESHOLD_STEP_COUNT) i = 0;
+            roll_set_threshold_ms(roll_threshold_steps[i]);
+            sprintf(action_str, "Roll threshold: %lums (sweep %lums)", roll_get_threshold_ms(), waveform_sweep_ms());
+            break;
+        }
+            
+        case 26: /* Wave2 - 通道2的DDS波形 */
+            dac_ch2_shape = (dac_ch2_shape + 1) % DDS_SHAPE_COUNT;
+            generator_update();
+            sprintf(action_str, "CH2 wave: %s%s", dds_shape_name((dds_shape_t)dac_ch2_shape),
+                    dac_ch2_on ? "" : " (CH2 off)");
+            break;
+            
         default:
             sprintf(action_str, "Unknown button");
             break;
     }
     
     /* 显示动作提示 */
-    lcd_fill(20, 700, 450, 720, WHITE);
-    lcd_show_string(20, 700, 450, 16, 16, action_str, BLUE);
+    if(!ui_ready) buttons_ui_init();
+    ui_text_set(&ui_action, action_str);
     
     draw_virtual_buttons();
 }
\ No newline at end of file
@@ -0,0 +1,245 @@
+#include "capture.h"
+
+/* 环形缓冲 */
+static uint16_t capture_ring[CAPTURE_RING_SIZE];
+static uint32_t write_pos = 0;          /* 下一个写入位置(不取模, 便于计算距离) */
+
+/* 记录参数 */
+static uint16_t record_len = 460;
+static uint16_t pre_len = 230;          /* 记录中触发点之前的采样数 */
+
+/* 运行状态 - 在DMA中断中更新, 主循环查询 */
+static volatile capture_state_t state = CAPTURE_IDLE;
+static uint32_t pre_count = 0;          /* 布防后已写入的采样数 */
+static uint32_t post_remaining = 0;     /* 触发后还需采集的采样数(含触发点) */
+static uint32_t trigger_pos = 0;        /* 触发点在环形缓冲中的绝对位置 */
+static volatile uint8_t force_pending = 0;
+
+/* 默认触发: 电平上升穿越 */
+static uint16_t trigger_level = 2048;
+static uint16_t last_sample = 0;
+
+static int32_t capture_level_trigger(const uint16_t *samples, uint16_t n)
+{
+  uint16_t i;
+
+  for(i = 0; i < n; i++) {
+    uint16_t prev = last_sample;
+
+    last_sample = samples[i];
+    if(prev < trigger_level && last_sample >= trigger_level) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+static capture_trigger_fn trigger_fn = capture_level_trigger;
+
+/* 把n个采样写入环形缓冲 */
+static void capture_write(const uint16_t *samples, uint16_t n)
+{
+  while(n--) {
+    capture_ring[write_pos & CAPTURE_RING_MASK] = *samples++;
+    write_pos++;
+  }
+}
+
+/* 非布防阶段也把数据交给触发检测, 使其内部状态(上一采样, 释抑计数等)保持连续, 结果忽略 */
+static void capture_scan(const uint16_t *samples, uint16_t n)
+{
+  int32_t hit;
+
+  while(n > 0) {
+    hit = trigger_fn(samples, n);
+    if(hit < 0) break;
+    samples += hit + 1;
+    n -= hit + 1;
+  }
+}
+
+/**
+ * @brief       设置记录长度和预触发深度
+ * @param       len: 记录长度(采样点), 不超过CAPTURE_MAX_RECORD
+ * @param       pretrigger_pct: 预触发深度 0~100%, 触发点本身总是包含在记录内
+ * @param       align: 记录长度和预触发深度向下取整到align的整数倍(峰值检测的min/max对为2), 一般为1
+ *   @note      只能在记录完成后/布防前调用
+ */
+void capture_configure(uint16_t len, uint8_t pretrigger_pct, uint8_t align)
+{
+  if(align < 1) align = 1;
+  if(len < 2 * align) len = 2 * align;
+  if(len > CAPTURE_MAX_RECORD) len = CAPTURE_MAX_RECORD;
+  if(pretrigger_pct > 100) pretrigger_pct = 100;
+
+  record_len = len - len % align;
+  pre_len = (uint32_t)record_len * pretrigger_pct / 100;
+  if(pre_len > record_len - align) pre_len = record_len - align;
+  pre_len -= pre_len % align;
+}
+
+/* 设置触发检测函数, 传入NULL恢复默认的电平上升沿触发 */
+void capture_set_trigger(capture_trigger_fn fn)
+{
+  trigger_fn = fn ? fn : capture_level_trigger;
+}
+
+/* 默认触发函数的触发电平 */
+void capture_set_level(uint16_t level)
+{
+  trigger_level = level;
+}
+
+/* 布防: 丢弃旧记录, 重新开始填充预触发数据 */
+void capture_arm(void)
+{
+  pre_count = 0;
+  post_remaining = 0;
+  force_pending = 0;
+  state = CAPTURE_PRETRIGGER;
+}
+
+/**
+ * @brief       记录完成后立即重新布防, 不重新填充预触发数据
+ *   @note      刚完成的记录已经连续写入了record_len个采样, 环形缓冲中触发点之前的
+ *              pre_len个采样总是有效的, 因此直接进入等待触发状态, 没有死区.
+ *              触发检测状态保持连续. 只能在capture_ready()之后调用(可在中断中).
+ */
+void capture_arm_continue(void)
+{
+  force_pending = 0;
+  post_remaining = 0;
+  pre_count = pre_len;
+  state = CAPTURE_ARMED;
+}
+
+/* 停止采集, 已冻结的记录保持不变 */
+void capture_disarm(void)
+{
+  state = CAPTURE_IDLE;
+  force_pending = 0;
+}
+
+/* 强制触发: 在下一次写入数据时以第一个采样作为触发点(用于无触发时的自动扫描) */
+void capture_force(void)
+{
+  force_pending = 1;
+}
+
+/**
+ * @brief       写入一段连续采样并推进状态机
+ *   @note      一般在DMA半传输/全传输中断中调用, 每次处理一个半缓冲.
+ */
+void capture_push(const uint16_t *samples, uint16_t n)
+{
+  capture_feed(samples, n);
+}
+
+/**
+ * @brief       同capture_push(), 但在记录完成时立即返回
+ * @retval      已处理的采样数; 小于n时记录已完成, 其余采样留给调用者(如分段采集重新布防后继续)
+ */
+uint16_t capture_feed(const uint16_t *samples, uint16_t n)
+{
+  uint16_t off = 0;
+  int32_t hit;
+
+  while(off < n && state != CAPTURE_DONE) {
+    switch(state) {
+      case CAPTURE_PRETRIGGER:
+      {
+        uint32_t need = pre_len - pre_count;
+        uint16_t chunk = ((uint32_t)(n - off) < need) ? (n - off) : (uint16_t)need;
+
+        capture_write(samples + off, chunk);
+        capture_scan(samples + off, chunk);
+        pre_count += chunk;
+        off += chunk;
+        if(pre_count >= pre_len) {
+          state = CAPTURE_ARMED;
+        }
+        break;
+      }
+
+      case CAPTURE_ARMED:
+        if(force_pending) {
+          force_pending = 0;
+          capture_scan(samples + off, 1);
+          hit = 0;
+        } else {
+          hit = trigger_fn(samples + off, n - off);
+        }
+
+        if(hit < 0) {
+          capture_write(samples + off, n - off);
+          off = n;
+        } else {
+          /* 触发点本身作为后触发部分的第一个采样 */
+          capture_write(samples + off, (uint16_t)hit + 1);
+          off += hit + 1;
+          trigger_pos = write_pos - 1;
+          post_remaining = record_len - pre_len - 1;
+          state = (post_remaining > 0) ? CAPTURE_POSTTRIGGER : CAPTURE_DONE;
+        }
+        break;
+
+      case CAPTURE_POSTTRIGGER:
+      {
+        uint16_t chunk = ((uint32_t)(n - off) < post_remaining) ? (n - off) : (uint16_t)post_remaining;
+
+        capture_write(samples + off, chunk);
+        capture_scan(samples + off, chunk);
+        post_remaining -= chunk;
+        off += chunk;
+        if(post_remaining == 0) {
+          state = CAPTURE_DONE;
+        }
+        break;
+      }
+
+      default:    /* IDLE: 不写入 */
+        off = n;
+        break;
+    }
+  }
+  return off;
+}
+
+capture_state_t capture_state(void)
+{
+  return state;
+}
+
+/* 是否已有完整的冻结记录 */
+uint8_t capture_ready(void)
+{
+  return state == CAPTURE_DONE;
+}
+
+uint16_t capture_record_length(void)
+{
+  return record_len;
+}
+
+/* 触发点在记录中的下标, 即预触发采样数 */
+uint16_t capture_trigger_index(void)
+{
+  return pre_len;
+}
+
+/* 读取冻结记录中的第index个采样 */
+uint16_t capture_read(uint16_t index)
+{
+  return capture_ring[(trigger_pos - pre_len + index) & CAPTURE_RING_MASK];
+}
+
+/* 把冻结记录按时间顺序复制出来 */
+void capture_copy_record(uint16_t *dst, uint16_t len)
+{
+  uint16_t i;
+
+  if(len > record_len) len = record_len;
+  for(i = 0; i < len; i++) {
+    dst[i] = capture_read(i);
+  }
+}
@@ -25,10 +25,49 @@
 #include "adc.h"
 #include "math.h"
 #include "tim.h"
-uint16_t g_dac_sin_buf[4096];  
+#include "string.h"
+#include "dds.h"
+
+/* 正在由DMA循环输出的波形表, 以及主循环准备新波形用的暂存表.
+ * 暂存表同时作为上传任意波形的非活动表, 上传的波形在暂存表被其它波形占用前一直保留.
+ * 双通道DDS时前DAC_DDS_HALF*2个字作为32位DMA缓冲, 需4字节对齐 */
+__ALIGNED(4) uint16_t g_dac_sin_buf[DAC_WAVE_MAX_LEN];
+static uint16_t dac_wave_stage[DAC_WAVE_MAX_LEN];
+
+static dac_wave_shape_t dac_wave_shape = DAC_SHAPE_TRIANGLE;
+static uint16_t dac_wave_amplitude = 1800;
+static uint16_t dac_wave_offset = 2048;
+static uint16_t dac_wave_len = DAC_WAVE_MAX_LEN;
+static uint32_t dac_wave_ticks = 72;            /* TIM7周期, 72MHz计数 */
+static uint32_t dac_wave_freq_mhz = 0;          /* 实际输出频率, mHz */
+static uint8_t dac_wave_running = 0;
+static uint8_t dac_wave_dds = 0;                /* 1: DDS实时填充, 0: 循环输出固定波形表 */
+static uint8_t dac_wave_dual = 0;               /* DDS同时输出通道2(PA5) */
+static uint8_t dac_wave_sync = 0;               /* 1: 与ADC3共用TIM8 TRGO触发, TIM7不使用 */
+static uint8_t dac_mark_next = 0;               /* 刚填充的半个缓冲以扫频同步标记开始 */
+static uint16_t dac_arb_len = 0;                /* 暂存表中任意波形的点数, 0为无效 */
+static uint8_t dac_arb_loading = 0;             /* 正在上传, 暂存表由上传占用 */
+static uint8_t dac_stage_deferred = 0;          /* 上传期间改变了波形参数, 上传结束后再生成 */
+static uint8_t dac_hw_alone = 0;                /* 1: 内置发生器单独输出, 不使用DMA */
+static dac_hwgen_t dac_hw_kind = DAC_HWGEN_OFF; /* 单独输出的波形 */
+static uint16_t dac_hw_base = 0;                /* 单独输出时DHR的值, 即波形的下限 */
+static uint16_t dac_hw_steps = 2;               /* 单独输出时一个周期的触发次数 */
+static dac_hwgen_t dac_hw_over_kind = DAC_HWGEN_OFF;   /* 叠加在DMA输出上的波形 */
+static uint8_t dac_hw_over_bits = 1;
+
+static void dac_sweep_mark(void);
+static void dac_dds_refill(uint8_t half);
+static void dac_wave_stage_update(void);
+static void dac_wave_irq_enable(uint8_t on);
+static void dac_hw_apply(dac_hwgen_t kind, uint8_t bits);
+
+/* 暂存表更新状态: 0无, 1等待半传输中断复制前半, 2等待传输完成中断复制后半.
+ * 波形表方式下DMA半传输/传输完成中断只在不为0时打开 */
+static volatile uint8_t dac_wave_pending = 0;
 /* USER CODE END 0 */
 
 DAC_HandleTypeDef hdac;
+DMA_HandleTypeDef hdma_dac_ch1;
 
 /* DAC init function */
 void MX_DAC_Init(void)
@@ -54,12 +93,19 @@ void MX_DAC_Init(void)
 
   /** DAC channel OUT1 config
   */
-  sConfig.DAC_Trigger = DAC_TRIGGER_NONE;
+  sConfig.DAC_Trigger = DAC_TRIGGER_T7_TRGO;
   sConfig.DAC_OutputBuffer = DAC_OUTPUTBUFFER_DISABLE;
   if (HAL_DAC_ConfigChannel(&hdac, &sConfig, DAC_CHANNEL_1) != HAL_OK)
   {
     Error_Handler();
   }
+
+  /** DAC channel OUT2 config
+  */
+  if (HAL_DAC_ConfigChannel(&hdac, &sConfig, DAC_CHANNEL_2) != HAL_OK)
+  {
+    Error_Handler();
+  }
   /* USER CODE BEGIN DAC_Init 2 */
 
   /* USER CODE END DAC_Init 2 */
@@ -81,11 +127,29 @@ void HAL_DAC_MspInit(DAC_HandleTypeDef* dacHandle)
     __HAL_RCC_GPIOA_CLK_ENABLE();
     /**DAC GPIO Configuration
     PA4     ------> DAC_OUT1
+    PA5     ------> DAC_OUT2
     */
-    GPIO_InitStruct.Pin = GPIO_PIN_4;
+    GPIO_InitStruct.Pin = GPIO_PIN_4|GPIO_PIN_5;
     GPIO_InitStruct.Mode = GPIO_MODE_ANALOG;
     HAL_GPIO_Init(GPIOA, &GPIO_InitStruct);
 
+    /* DAC DMA Init */
+    /* DAC_CH1 Init */
+    hdma_dac_ch1.Instance = DMA2_Channel3;
+    hdma_dac_ch1.Init.Direction = DMA_MEMORY_TO_PERIPH;
+    hdma_dac_ch1.Init.PeriphInc = DMA_PINC_DISABLE;
+    hdma_dac_ch1.Init.MemInc = DMA_MINC_ENABLE;
+    hdma_dac_ch1.Init.PeriphDataAlignment = DMA_PDATAALIGN_HALFWORD;
+    hdma_dac_ch1.Init.MemDataAlignment = DMA_MDATAALIGN_HALFWORD;
+    hdma_dac_ch1.Init.Mode = DMA_CIRCULAR;
+    hdma_dac_ch1.Init.Priority = DMA_PRIORITY_MEDIUM;
+    if (HAL_DMA_Init(&hdma_dac_ch1) != HAL_OK)
+    {
+      Error_Handler();
+    }
+
+    __HAL_LINKDMA(dacHandle,DMA_Handle1,hdma_dac_ch1);
+
   /* USER CODE BEGIN DAC_MspInit 1 */
 
   /* USER CODE END DAC_MspInit 1 */
@@ -105,9 +169,12 @@ void HAL_DAC_MspDeInit(DAC_HandleTypeDef* dacHandle)
 
     /**DAC GPIO Configuration
     PA4     ------> DAC_OUT1
+    PA5     ------> DAC_OUT2
     */
-    HAL_GPIO_DeInit(GPIOA, GPIO_PIN_4);
+    HAL_GPIO_DeInit(GPIOA, GPIO_PIN_4|GPIO_PIN_5);
 
+    /* DAC DMA DeInit */
+    HAL_DMA_DeInit(dacHandle->DMA_Handle1);
   /* USER CODE BEGIN DAC_MspDeInit 1 */
 
   /* USER CODE END DAC_MspDeInit 1 */
@@ -116,7 +183,621 @@ void HAL_DAC_MspDeInit(DAC_HandleTypeDef* dacHandle)
 
 /* USER CODE BEGIN 1 */
 
+/**
+ * @brief       按波形参数填充一张波形表
+ * @param       buf   : 波形表
+ * @param       len   : 点数(偶数)
+ * @param       shape : 波形
+ * @param       amp   : 峰峰值(0~4095)
+ * @param       offset: 中心值(0~4095), 超出0~4095的部分被削去
+ */
+static void dac_wave_fill(uint16_t *buf, uint16_t len, dac_wave_shape_t shape, uint16_t amp, uint16_t offset)
+{
+  int32_t lo = (int32_t)offset - amp / 2;
+  uint16_t i;
+
+  if(shape == DAC_SHAPE_ARB) {
+    /* 任意波形不按参数生成, 从暂存表取上传的点 */
+    if(buf != dac_wave_stage) memcpy(buf, dac_wave_stage, len * sizeof(uint16_t));
+    return;
+  }
+
+  for(i = 0; i < len; i++) {
+    int32_t v;
+
+    if(shape == DAC_SHAPE_SINE) {
+      v = offset + (int32_t)lrintf(amp * 0.5f * sinf(6.2831853f * i / len));
+    } else if(i < len / 2) {
+      v = lo + (int32_t)amp * 2 * i / len;
+    } else {
+      v = lo + (int32_t)amp * 2 * (len - i) / len;
+    }
+    if(v < 0) v = 0;
+    if(v > 4095) v = 4095;
+    buf[i] = v;
+  }
+}
+
+/* 给定频率下的波形表点数: 不超过DAC_WAVE_MAX_RATE点/秒的最长的2的幂, 任意波形为上传的点数 */
+static uint16_t dac_wave_length_for(uint32_t freq_mhz)
+{
+  uint16_t len = DAC_WAVE_MAX_LEN;
+
+  if(dac_wave_shape == DAC_SHAPE_ARB) return dac_arb_len;
+  while(len > DAC_WAVE_MIN_LEN && (uint64_t)freq_mhz * len > (uint64_t)DAC_WAVE_MAX_RATE * 1000U) {
+    len >>= 1;
+  }
+  return len;
+}
+
+/* 按频率和当前点数求TIM7周期并写入, 更新实际频率 */
+static void dac_wave_apply_period(uint32_t freq_mhz)
+{
+  uint64_t div = (uint64_t)freq_mhz * dac_wave_len;
+  uint64_t ticks = ((uint64_t)SystemCoreClock * 1000U + div / 2) / div;
+
+  if(ticks < SystemCoreClock / DAC_WAVE_MAX_RATE) ticks = SystemCoreClock / DAC_WAVE_MAX_RATE;
+  if(ticks > 0xFFFFFFFFU) ticks = 0xFFFFFFFFU;
+
+  dac_wave_ticks = tim7_set_period((uint32_t)ticks);
+  dac_wave_freq_mhz = (uint32_t)((uint64_t)SystemCoreClock * 1000U / ((uint64_t)dac_wave_ticks * dac_wave_len));
+}
+
+/* 停止TIM7触发和DMA输出, 关闭内置发生器 */
+static void dac_wave_stop(void)
+{
+  if(dac_wave_running) {
+    HAL_TIM_Base_Stop(&htim7);
+    if(dac_hw_alone) {
+      HAL_DAC_Stop(&hdac, DAC_CHANNEL_1);
+    } else {
+      HAL_DAC_Stop_DMA(&hdac, DAC_CHANNEL_1);
+    }
+    if(dac_wave_dual) {
+      __HAL_DAC_DISABLE(&hdac, DAC_CHANNEL_2);
+    }
+    dac_wave_running = 0;
+  }
+  dac_hw_apply(DAC_HWGEN_OFF, 1);
+  dac_hw_alone = 0;
+  dac_wave_pending = 0;
+}
+
+/* DMA传输宽度: 单通道写DHR12R1为半字, 双通道写DHR12RD为字. 只在DMA停止时调用 */
+static void dac_dma_set_width(uint8_t word)
+{
+  hdma_dac_ch1.Init.PeriphDataAlignment = word ? DMA_PDATAALIGN_WORD : DMA_PDATAALIGN_HALFWORD;
+  hdma_dac_ch1.Init.MemDataAlignment = word ? DMA_MDATAALIGN_WORD : DMA_MDATAALIGN_HALFWORD;
+  if (HAL_DMA_Init(&hdma_dac_ch1) != HAL_OK)
+  {
+    Error_Handler();
+  }
+}
+
+/* 选择两个通道的触发源, 只在通道停止时调用 */
+static void dac_set_trigger(uint32_t trigger)
+{
+  DAC_ChannelConfTypeDef sConfig = {0};
+
+  sConfig.DAC_Trigger = trigger;
+  sConfig.DAC_OutputBuffer = DAC_OUTPUTBUFFER_DISABLE;
+  if (HAL_DAC_ConfigChannel(&hdac, &sConfig, DAC_CHANNEL_1) != HAL_OK ||
+      HAL_DAC_ConfigChannel(&hdac, &sConfig, DAC_CHANNEL_2) != HAL_OK)
+  {
+    Error_Handler();
+  }
+}
+
+/**
+ * @brief       从g_dac_sin_buf的第一个点开始循环输出dac_wave_len个点
+ *   @note      TIM7 TRGO触发DAC通道1转换, DMA2通道3循环地把缓冲写入DHR12R1,
+ *              每个输出点不需要CPU参与, 输出点间隔由定时器决定, 没有软件抖动.
+ *              双通道时两个通道都由TIM7 TRGO触发, 通道1的DMA请求每次把一个字写入DHR12RD,
+ *              同时更新两个通道, dac_wave_len为字数.
+ */
+static void dac_wave_run(void)
+{
+  /* 定时器停止时立即装载新的预分频值和周期, 计数从0开始 */
+  htim7.Instance->EGR = TIM_EGR_UG;
+  htim7.Instance->CNT = 0;
+
+  dac_set_trigger(dac_wave_sync ? DAC_TRIGGER_T8_TRGO : DAC_TRIGGER_T7_TRGO);
+  if(!dac_wave_sync) {
+    dac_hw_apply(dac_hw_over_kind, dac_hw_over_bits);   /* 与ADC同步测量时不叠加 */
+  }
+  dac_dma_set_width(dac_wave_dual);
+  if(dac_wave_dual) {
+    /* HAL_DAC_Start_DMA只能写单通道的寄存器, 双通道时直接启动DMA, 回调沿用HAL的通道1回调 */
+    hdma_dac_ch1.XferCpltCallback = DAC_DMAConvCpltCh1;
+    hdma_dac_ch1.XferHalfCpltCallback = DAC_DMAHalfConvCpltCh1;
+    hdma_dac_ch1.XferErrorCallback = DAC_DMAErrorCh1;
+    HAL_DMA_Start_IT(&hdma_dac_ch1, (uint32_t)g_dac_sin_buf, (uint32_t)&hdac.Instance->DHR12RD, dac_wave_len);
+    SET_BIT(hdac.Instance->CR, DAC_CR_DMAEN1);
+    __HAL_DAC_ENABLE(&hdac, DAC_CHANNEL_1);
+    __HAL_DAC_ENABLE(&hdac, DAC_CHANNEL_2);
+  } else {
+    HAL_DAC_Start_DMA(&hdac, DAC_CHANNEL_1, (const uint32_t *)g_dac_sin_buf, dac_wave_len, DAC_ALIGN_12B_R);
+  }
+  if(!dac_wave_dds) {
+    dac_wave_irq_enable(0);     /* 波形表循环输出不需要CPU, 有更新时再打开 */
+  }
+  if(!dac_wave_sync) {
+    HAL_TIM_Base_Start(&htim7);
+  }
+  dac_wave_running = 1;
+}
+
+/* 打开/关闭DMA半传输和传输完成中断; 打开前清除旧的标志, 从下一个半传输开始响应 */
+static void dac_wave_irq_enable(uint8_t on)
+{
+  if(on) {
+    __HAL_DMA_CLEAR_FLAG(&hdma_dac_ch1, __HAL_DMA_GET_HT_FLAG_INDEX(&hdma_dac_ch1) |
+                                        __HAL_DMA_GET_TC_FLAG_INDEX(&hdma_dac_ch1));
+    __HAL_DMA_ENABLE_IT(&hdma_dac_ch1, DMA_IT_HT | DMA_IT_TC);
+  } else {
+    __HAL_DMA_DISABLE_IT(&hdma_dac_ch1, DMA_IT_HT | DMA_IT_TC);
+  }
+}
+
+/**
+ * @brief       按当前波形参数重新生成波形表并重新启动输出
+ *   @note      输出会中断一个很短的时间, 只在波形表点数改变或从DDS切换过来时使用.
+ * @param       freq_mhz: 输出频率, 单位mHz
+ */
+static void dac_wave_restart(uint32_t freq_mhz)
+{
+  dac_wave_stop();
+  dac_wave_dds = 0;
+  dac_wave_dual = 0;
+  dac_wave_sync = 0;
+  if(dac_wave_shape == DAC_SHAPE_ARB && dac_arb_len == 0) dac_wave_shape = DAC_SHAPE_TRIANGLE;
+
+  dac_wave_len = dac_wave_length_for(freq_mhz);
+  dac_wave_fill(g_dac_sin_buf, dac_wave_len, dac_wave_shape, dac_wave_amplitude, dac_wave_offset);
+  dac_wave_apply_period(freq_mhz);
+  dac_wave_run();
+}
+
+/**
+ * @brief       以DDS方式启动波形发生器
+ *   @note      g_dac_sin_buf的前2*DAC_DDS_HALF个点作为DMA环形缓冲, TIM7固定以DDS_DEFAULT_RATE触发,
+ *              DMA每输出完半个缓冲由dds_fill()重新填充. 波形, 频率和幅度用dds_set_xxx()设置,
+ *              改变频率时相位连续, 约一到两个半缓冲(1.3~2.6ms)后生效.
+ *              双通道时缓冲为2*DAC_DDS_HALF个字, 由dds_fill_dual()填充, 通道2在PA5输出.
+ * @param       dual: 1同时输出通道2
+ * @retval      实际输出频率, 单位mHz
+ */
+uint32_t dac_dds_start(uint8_t dual)
+{
+  dac_wave_stop();
+  dac_wave_dds = 1;
+  dac_wave_dual = dual ? 1 : 0;
+  dac_wave_sync = 0;
+
+  dac_wave_len = DAC_DDS_HALF * 2;
+  dac_wave_ticks = tim7_set_period(SystemCoreClock / DDS_DEFAULT_RATE);
+  dds_set_rate(SystemCoreClock / dac_wave_ticks);
+  dds_reset_phase();
+  dac_dds_refill(0);
+  dac_sweep_mark();               /* 前半个缓冲立即开始输出 */
+  dac_dds_refill(1);
+  dac_wave_run();
+  return dds_get_frequency();
+}
+
+/**
+ * @brief       以DDS方式启动单通道输出, 由TIM8 TRGO触发, 与ADC3同步
+ *   @note      DMA准备好后等待TIM8启动(见adc_acq_start_held()). 相位和输出点计数归零,
+ *              DAC的第j个输出点在TIM8第j+1个更新事件时出现在PA4, ADC第k个采样与DAC第k-1个点同时.
+ * @param       rate: TIM8的触发频率, 即ADC采样率
+ * @retval      实际输出频率, 单位mHz
+ */
+uint32_t dac_dds_start_synced(uint32_t rate)
+{
+  dac_wave_stop();
+  dac_wave_dds = 1;
+  dac_wave_dual = 0;
+  dac_wave_sync = 1;
+
+  dac_wave_len = DAC_DDS_HALF * 2;
+  dac_wave_ticks = SystemCoreClock / rate;
+  dds_set_rate(rate);
+  dds_reset_phase();
+  dac_dds_refill(0);
+  dac_sweep_mark();
+  dac_dds_refill(1);
+  dac_wave_run();
+  return dds_get_frequency();
+}
+
+/* 当前是否与ADC共用TIM8触发 */
+uint8_t dac_dds_synced(void)
+{
+  return dac_wave_running && dac_wave_dds && dac_wave_sync;
+}
+
+/* 当前是否以DDS方式输出 */
+uint8_t dac_dds_active(void)
+{
+  return dac_wave_running && dac_wave_dds;
+}
+
+/* 当前是否双通道输出 */
+uint8_t dac_dds_dual(void)
+{
+  return dac_wave_running && dac_wave_dds && dac_wave_dual;
+}
+
+/**
+ * @brief       按给定参数启动波形发生器
+ * @param       shape   : 波形
+ * @param       freq_mhz: 输出频率, 单位mHz, 限制在DAC_WAVE_MIN_FREQ_MHZ~DAC_WAVE_MAX_FREQ_MHZ
+ * @param       amp     : 峰峰值
+ * @param       offset  : 中心值
+ * @retval      实际输出频率, 单位mHz
+ */
+uint32_t dac_wave_start(dac_wave_shape_t shape, uint32_t freq_mhz, uint16_t amp, uint16_t offset)
+{
+  if(freq_mhz < DAC_WAVE_MIN_FREQ_MHZ) freq_mhz = DAC_WAVE_MIN_FREQ_MHZ;
+  if(freq_mhz > DAC_WAVE_MAX_FREQ_MHZ) freq_mhz = DAC_WAVE_MAX_FREQ_MHZ;
+  if(shape >= DAC_SHAPE_COUNT) shape = DAC_SHAPE_TRIANGLE;
+  if(shape == DAC_SHAPE_ARB && (dac_arb_len == 0 || dac_arb_loading)) shape = DAC_SHAPE_TRIANGLE;
+
+  dac_wave_shape = shape;
+  dac_wave_amplitude = amp;
+  dac_wave_offset = offset;
+  dac_wave_restart(freq_mhz);
+  return dac_wave_freq_mhz;
+}
+
+/**
+ * @brief       改变输出频率
+ *   @note      DDS方式下只改写频率字. 波形表点数不变时只改写TIM7的预装载周期, 在当前输出点结束时生效, 输出连续无毛刺;
+ *              点数需要改变时(频率跨过2的幂的边界)重新生成波形表并重新启动DMA.
+ * @param       freq_mhz: 输出频率, 单位mHz
+ * @retval      实际输出频率, 单位mHz
+ */
+uint32_t dac_wave_set_frequency(uint32_t freq_mhz)
+{
+  if(freq_mhz < DAC_WAVE_MIN_FREQ_MHZ) freq_mhz = DAC_WAVE_MIN_FREQ_MHZ;
+  if(freq_mhz > DAC_WAVE_MAX_FREQ_MHZ) freq_mhz = DAC_WAVE_MAX_FREQ_MHZ;
+
+  if(dac_wave_running && dac_wave_dds) {
+    return dds_set_frequency(freq_mhz);
+  }
+  if(!dac_wave_running || (dac_wave_shape != DAC_SHAPE_ARB && dac_wave_length_for(freq_mhz) != dac_wave_len)) {
+    dac_wave_restart(freq_mhz);
+  } else {
+    dac_wave_apply_period(freq_mhz);
+  }
+  return dac_wave_freq_mhz;
+}
+
+/**
+ * @brief       改变波形和幅度, 输出不中断
+ *   @note      新波形先生成到暂存表, 由DMA半传输中断复制到刚输出完的前半张表, 传输完成中断复制后半张,
+ *              新波形从下一个完整周期开始输出, 不会出现新旧混合的周期.
+ *              若上一次更新已复制了前半张, 不等待, 只记下参数, 换表完成后由dac_wave_poll()生成.
+ *              任意波形点数固定, 与其它波形之间切换用dac_wave_start().
+ * @param       shape : 波形
+ * @param       amp   : 峰峰值
+ * @param       offset: 中心值
+ */
+void dac_wave_set_shape(dac_wave_shape_t shape, uint16_t amp, uint16_t offset)
+{
+  if(shape >= DAC_SHAPE_COUNT || shape == DAC_SHAPE_ARB) shape = DAC_SHAPE_TRIANGLE;
+  if(shape == dac_wave_shape && amp == dac_wave_amplitude && offset == dac_wave_offset) return;
+
+  dac_wave_shape = shape;
+  dac_wave_amplitude = amp;
+  dac_wave_offset = offset;
+
+  if(dac_wave_dds) return;       /* DDS方式下只记下参数, 切回波形表时生成 */
+  if(!dac_wave_running) {
+    dac_wave_fill(g_dac_sin_buf, dac_wave_len, shape, amp, offset);
+    return;
+  }
+  if(dac_arb_loading) {
+    dac_stage_deferred = 1;      /* 暂存表正在接收上传, 结束后再生成 */
+    return;
+  }
+  dac_wave_stage_update();
+}
+
+/* 按当前参数生成暂存表, 从下一个完整周期开始输出. 暂存表中的任意波形随之失效 */
+static void dac_wave_stage_update(void)
+{
+  /* 尚未开始复制的更新直接取消; 已复制一半的不能改写暂存表, 推迟到换表完成后 */
+  __disable_irq();
+  if(dac_wave_pending == 1) dac_wave_pending = 0;
+  __enable_irq();
+  if(dac_wave_pending != 0) {
+    dac_stage_deferred = 1;
+    return;
+  }
+
+  dac_wave_fill(dac_wave_stage, dac_wave_len, dac_wave_shape, dac_wave_amplitude, dac_wave_offset);
+  dac_arb_len = 0;
+  dac_wave_pending = 1;
+  dac_wave_irq_enable(1);
+}
+
+/**
+ * @brief       生成推迟的波形更新, 在主循环中定期调用
+ *   @note      dac_wave_set_shape()遇到正在换表时只记下参数, 换表完成(最多半个周期)后在这里生成
+ */
+void dac_wave_poll(void)
+{
+  if(!dac_stage_deferred || dac_wave_pending != 0 || dac_arb_loading) return;
+
+  dac_stage_deferred = 0;
+  if(dac_wave_running && !dac_wave_dds && dac_wave_shape != DAC_SHAPE_ARB) {
+    dac_wave_stage_update();
+  }
+}
+
+/**
+ * @brief       开始上传任意波形, 返回供上传写入的暂存表
+ *   @note      暂存表正在复制到输出表时(最多一个周期)不等待, 返回NULL, 上传方收到BUSY后重试.
+ *              上传期间暂存表不再用于其它波形的更新, 此前上传的任意波形失效,
+ *              正在输出的任意波形继续由输出表输出.
+ * @param       len: 点数, 偶数, DAC_WAVE_MIN_LEN~DAC_WAVE_MAX_LEN
+ * @retval      暂存表, 点数不合法或正在换表时为NULL
+ */
+uint16_t *dac_arb_begin(uint16_t len)
+{
+  if(len < DAC_WAVE_MIN_LEN || len > DAC_WAVE_MAX_LEN || (len & 1)) return NULL;
+  if(dac_wave_pending != 0) return NULL;
+  dac_arb_loading = 1;
+  dac_arb_len = 0;
+  return dac_wave_stage;
+}
+
+/**
+ * @brief       结束上传
+ *   @note      正在输出同样点数的任意波形时, 由DMA半传输/传输完成中断在周期边界把新表换入,
+ *              输出不中断, 不会出现新旧混合的周期. 点数不同时以原频率重新启动输出.
+ *              输出其它波形时只保存, 由dac_wave_start(DAC_SHAPE_ARB, ...)选用.
+ * @param       len: 上传的点数, 0为放弃
+ * @retval      1成功
+ */
+uint8_t dac_arb_end(uint16_t len)
+{
+  dac_arb_loading = 0;
+  dac_arb_len = (len >= DAC_WAVE_MIN_LEN && len <= DAC_WAVE_MAX_LEN && !(len & 1)) ? len : 0;
+
+  if(dac_wave_running && !dac_wave_dds && dac_wave_shape == DAC_SHAPE_ARB && dac_arb_len != 0) {
+    if(dac_arb_len == dac_wave_len) {
+      dac_wave_pending = 1;
+      dac_wave_irq_enable(1);
+    } else {
+      dac_wave_restart(dac_wave_freq_mhz);
+    }
+  } else if(dac_stage_deferred && dac_wave_running && !dac_wave_dds && dac_wave_shape != DAC_SHAPE_ARB) {
+    dac_wave_stage_update();
+  }
+  dac_stage_deferred = 0;
+  return len == 0 || dac_arb_len != 0;
+}
+
+/* 暂存表中可用的任意波形点数, 0为没有 */
+uint16_t dac_arb_length(void)
+{
+  return dac_arb_loading ? 0 : dac_arb_len;
+}
+
+/* 设置通道1内置发生器的波形和幅度位数(1~12), 幅度为2^bits-1. 只改写WAVE1/MAMP1, 可在输出时调用 */
+static void dac_hw_apply(dac_hwgen_t kind, uint8_t bits)
+{
+  uint32_t mamp = (uint32_t)(bits - 1) << DAC_CR_MAMP1_Pos;
+
+  if(kind == DAC_HWGEN_TRIANGLE) {
+    HAL_DACEx_TriangleWaveGenerate(&hdac, DAC_CHANNEL_1, mamp);
+  } else if(kind == DAC_HWGEN_NOISE) {
+    HAL_DACEx_NoiseWaveGenerate(&hdac, DAC_CHANNEL_1, mamp);
+  } else {
+    CLEAR_BIT(hdac.Instance->CR, DAC_CR_WAVE1 | DAC_CR_MAMP1);
+  }
+}
+
+/**
+ * @brief       用DAC内置的三角波/噪声发生器单独输出
+ *   @note      DHR固定为波形下限, TIM7每次触发时硬件把三角波计数器或LFSR加到DHR上, 不使用DMA和CPU.
+ *              三角波一个周期触发2*(2^bits-1)次, 计数器在0~2^bits-1之间往返;
+ *              噪声每个设定周期触发DAC_HWGEN_NOISE_STEPS次, LFSR只保留低bits位.
+ *              触发率不超过DAC_WAVE_MAX_RATE, 幅度位数大时实际频率低于设定值.
+ * @param       kind    : DAC_HWGEN_TRIANGLE或DAC_HWGEN_NOISE
+ * @param       freq_mhz: 三角波频率或噪声的设定频率, 单位mHz
+ * @param       bits    : 幅度位数1~12, 峰峰值2^bits-1
+ * @param       offset  : 中心值, 波形超出0~4095时整体平移到范围内
+ * @retval      实际频率, 单位mHz
+ */
+uint32_t dac_hwgen_start(dac_hwgen_t kind, uint32_t freq_mhz, uint8_t bits, uint16_t offset)
+{
+  uint32_t range;
+  int32_t base;
+  uint64_t div, ticks;
+
+  if(kind != DAC_HWGEN_TRIANGLE && kind != DAC_HWGEN_NOISE) kind = DAC_HWGEN_TRIANGLE;
+  if(bits < 1) bits = 1;
+  if(bits > 12) bits = 12;
+  if(freq_mhz < DAC_WAVE_MIN_FREQ_MHZ) freq_mhz = DAC_WAVE_MIN_FREQ_MHZ;
+
+  dac_wave_stop();
+  dac_wave_dds = 0;
+  dac_wave_dual = 0;
+  dac_wave_sync = 0;
+
+  range = (1U << bits) - 1;
+  dac_hw_kind = kind;
+  dac_hw_steps = (kind == DAC_HWGEN_TRIANGLE) ? 2 * range : DAC_HWGEN_NOISE_STEPS;
+
+  /* TIM7周期 = SystemCoreClock / (f * 每周期触发次数) */
+  div = (uint64_t)freq_mhz * dac_hw_steps;
+  ticks = ((uint64_t)SystemCoreClock * 1000U + div / 2) / div;
+  if(ticks < SystemCoreClock / DAC_WAVE_MAX_RATE) ticks = SystemCoreClock / DAC_WAVE_MAX_RATE;
+  if(ticks > 0xFFFFFFFFU) ticks = 0xFFFFFFFFU;
+  dac_wave_ticks = tim7_set_period((uint32_t)ticks);
+  dac_wave_freq_mhz = (uint32_t)((uint64_t)SystemCoreClock * 1000U / ((uint64_t)dac_wave_ticks * dac_hw_steps));
+
+  base = (int32_t)offset - (int32_t)(range / 2);
+  if(base < 0) base = 0;
+  if(base > (int32_t)(4095 - range)) base = 4095 - range;
+  dac_hw_base = base;
+
+  htim7.Instance->EGR = TIM_EGR_UG;
+  htim7.Instance->CNT = 0;
+  dac_set_trigger(DAC_TRIGGER_T7_TRGO);
+  dac_hw_apply(kind, bits);
+  HAL_DAC_SetValue(&hdac, DAC_CHANNEL_1, DAC_ALIGN_12B_R, dac_hw_base);
+  HAL_DAC_Start(&hdac, DAC_CHANNEL_1);
+  HAL_TIM_Base_Start(&htim7);
+  dac_hw_alone = 1;
+  dac_wave_running = 1;
+  return dac_wave_freq_mhz;
+}
+
+/**
+ * @brief       在DMA输出的波形(波形表或DDS)上叠加内置发生器, 用于抖动
+ *   @note      每个输出点由同一个触发加上三角波计数器或LFSR的低bits位. 硬件相加不饱和,
+ *              波形上限需留出2^bits-1的余量. 与ADC同步测量(波特图)时不叠加.
+ * @param       kind: DAC_HWGEN_OFF关闭
+ * @param       bits: 叠加幅度位数1~12
+ */
+void dac_hwgen_overlay(dac_hwgen_t kind, uint8_t bits)
+{
+  if(kind >= DAC_HWGEN_COUNT) kind = DAC_HWGEN_OFF;
+  if(bits < 1) bits = 1;
+  if(bits > 12) bits = 12;
+
+  dac_hw_over_kind = kind;
+  dac_hw_over_bits = bits;
+  if(dac_wave_running && !dac_hw_alone && !dac_wave_sync) {
+    dac_hw_apply(kind, bits);
+  }
+}
+
+/* 内置发生器是否在单独输出 */
+uint8_t dac_hwgen_active(void)
+{
+  return dac_wave_running && dac_hw_alone;
+}
+
+/* 单独输出时为输出的波形, 否则为叠加的波形 */
+dac_hwgen_t dac_hwgen_get_kind(void)
+{
+  return dac_hwgen_active() ? dac_hw_kind : dac_hw_over_kind;
+}
+
+const char *dac_hwgen_name(dac_hwgen_t kind)
+{
+  static const char *const names[DAC_HWGEN_COUNT] = { "Off", "HwTri", "HwNoise" };
+  return (kind < DAC_HWGEN_COUNT) ? names[kind] : "?";
+}
+
+/**
+ * @brief       扫频同步标记输出(PC7)
+ *   @note      DDS填充的是刚输出完的半个缓冲, 它要在下一次半缓冲中断时才开始输出.
+ *              扫频的每一级都从半缓冲的第一个点开始, 所以在该半缓冲开始输出时拉高PC7,
+ *              下一次中断时拉低, 上升沿与新一级的第一个输出点只差中断响应时间.
+ */
+static void dac_sweep_mark(void)
+{
+  if(dac_mark_next) {
+    SWEEP_MARK_GPIO_Port->BSRR = SWEEP_MARK_Pin;
+  } else {
+    SWEEP_MARK_GPIO_Port->BSRR = (uint32_t)SWEEP_MARK_Pin << 16;
+  }
+}
+
+/* DDS方式: 重新填充刚输出完的半个缓冲, half为0(前半)或1(后半) */
+static void dac_dds_refill(uint8_t half)
+{
+  if(dac_wave_dual) {
+    dds_fill_dual((uint32_t *)g_dac_sin_buf + half * DAC_DDS_HALF, DAC_DDS_HALF);
+  } else {
+    dds_fill(&g_dac_sin_buf[half * DAC_DDS_HALF], DAC_DDS_HALF);
+  }
+  dac_mark_next = dds_sweep_take_marker();
+}
+
+/* DMA已输出前半张表, 正在输出后半张 */
+void HAL_DAC_ConvHalfCpltCallbackCh1(DAC_HandleTypeDef *hdac)
+{
+  (void)hdac;
+  if(dac_wave_dds) {
+    dac_sweep_mark();
+    dac_dds_refill(0);
+  } else if(dac_wave_pending == 1) {
+    memcpy(g_dac_sin_buf, dac_wave_stage, dac_wave_len / 2 * sizeof(uint16_t));
+    dac_wave_pending = 2;
+  }
+}
+
+/* DMA已输出后半张表, 回到表头 */
+void HAL_DAC_ConvCpltCallbackCh1(DAC_HandleTypeDef *hdac)
+{
+  (void)hdac;
+  if(dac_wave_dds) {
+    dac_sweep_mark();
+    dac_dds_refill(1);
+  } else if(dac_wave_pending == 2) {
+    memcpy(&g_dac_sin_buf[dac_wave_len / 2], &dac_wave_stage[dac_wave_len / 2],
+           dac_wave_len / 2 * sizeof(uint16_t));
+    dac_wave_pending = 0;
+    dac_wave_irq_enable(0);
+  }
+}
+
+/* 实际输出频率, 单位mHz */
+uint32_t dac_wave_get_frequency(void)
+{
+  if(dac_wave_dds) return dds_get_frequency();
+  return dac_wave_freq_mhz;
+}
 
+/* 波形表点数 */
+uint16_t dac_wave_get_length(void)
+{
+  return dac_wave_len;
+}
+
+/* 输出点速率, 点/秒 */
+uint32_t dac_wave_get_rate(void)
+{
+  return SystemCoreClock / dac_wave_ticks;
+}
+
+dac_wave_shape_t dac_wave_get_shape(void)
+{
+  return dac_wave_shape;
+}
+
+/**
+ * @brief       波形在某一时刻的输出值, 用于在屏幕上画出发生器的参考迹线
+ * @param       idx : 采样序号
+ * @param       rate: 采样率, 第idx个采样的时刻为 idx/rate 秒, 以波形表起点为0时刻
+ * @retval      该时刻的波形表值
+ */
+uint16_t dac_wave_value_at(uint32_t idx, uint32_t rate)
+{
+  uint32_t pos;
+
+  if(rate == 0) return g_dac_sin_buf[0];
+  if(dac_hwgen_active()) {
+    /* 三角波按触发次数算出计数器的值, 噪声无法预知, 取当前输出值 */
+    uint32_t range = dac_hw_steps / 2;
+    if(dac_hw_kind != DAC_HWGEN_TRIANGLE) return HAL_DAC_GetValue(&hdac, DAC_CHANNEL_1);
+    pos = (uint32_t)((uint64_t)idx * (SystemCoreClock / dac_wave_ticks) / rate % dac_hw_steps);
+    return dac_hw_base + ((pos < range) ? pos : (dac_hw_steps - pos));
+  }
+  if(dac_wave_dds) {
+    /* 相位 = t * f * 2^32 = idx * M * fs / rate */
+    return dds_sample(0, (uint32_t)((uint64_t)idx * dds_get_tuning_word() * dds_get_rate() / rate));
+  }
+  pos = (uint32_t)((uint64_t)idx * dac_wave_freq_mhz * dac_wave_len / ((uint64_t)rate * 1000U) % dac_wave_len);
+  return g_dac_sin_buf[pos];
+}
 
 /**
  * @brief       设置DAC_OUT1输出三角波
@@ -158,29 +839,4 @@ void dac_triangular_wave(uint16_t maxval, uint16_t dt, uint16_t samples, uint16_
         }
     }
 }
-
-/**
- * @brief       产生正弦波函序列
- *   @note      需保证: maxval > samples/2
- *
- * @param       maxval : 最大值(0 < maxval < 2048)
- * @param       samples: 采样点的个数
- *
- * @retval      无
- */
-void dac_creat_sin_buf(uint16_t maxval, uint16_t samples)
-{
-    uint8_t i;
-    float inc = (2 * 3.1415962) / samples; /* 计算增量（一个周期DAC_SIN_BUF个点）*/
-    float outdata = 0;
-
-    for (i = 0; i < samples; i++)
-    {
-        outdata = maxval * (1 + sin(inc * i)); /* 计算以dots个点为周期的每个点的值，放大maxval倍，并偏移到正数区域 */
-        if (outdata > 4095)
-            outdata = 4095; /* 上限限定 */
-        //g_dac_sin_buf[i] = outdata;
-        HAL_DAC_SetValue(&hdac,DAC_CHANNEL_1,DAC_ALIGN_12B_R,outdata);
-    }
-}
 /* USER CODE END 1 */
@@ -0,0 +1,616 @@
+#include "dds.h"
+#include <math.h>
+
+/* 正弦表, Q15, 多一点(等于第0点)供插值时取下一点, RAM占用 (DDS_LUT_SIZE+1)*2 字节 */
+static int16_t dds_lut[DDS_LUT_SIZE + 1];
+
+/* 递推生成正弦表用的常数: cos(2pi/N), sin(2pi/N), Q30 */
+#if DDS_LUT_BITS == 10
+#define DDS_STEP_COS_Q30    1073721611
+#define DDS_STEP_SIN_Q30    6588356
+#elif DDS_LUT_BITS == 11
+#define DDS_STEP_COS_Q30    1073736771
+#define DDS_STEP_SIN_Q30    3294193
+#elif DDS_LUT_BITS == 12
+#define DDS_STEP_COS_Q30    1073740561
+#define DDS_STEP_SIN_Q30    1647099
+#else
+#error "DDS_LUT_BITS must be 10, 11 or 12"
+#endif
+
+#define DDS_FRAC_SHIFT      (32 - DDS_LUT_BITS - 16)   /* 表下标之后取16位作插值系数 */
+
+/* 每个通道的波形参数 */
+typedef struct {
+    dds_shape_t shape;
+    int32_t amp;
+    int32_t offset;
+    uint32_t duty_phase;        /* 方波高电平结束处的相位 */
+    uint16_t duty;              /* 0.1% */
+} dds_channel_t;
+
+static volatile dds_channel_t dds_ch[DDS_CHANNELS] = {
+    { DDS_SINE, 1800, 2048, 0x80000000U, 500 },
+    { DDS_SINE, 1800, 2048, 0x80000000U, 500 }
+};
+
+static uint32_t dds_rate = DDS_DEFAULT_RATE;
+static uint32_t dds_freq_mhz = 1000000U;
+static volatile uint32_t dds_phase = 0;             /* 通道1的相位 */
+static volatile uint32_t dds_step = 0;              /* 频率字M */
+static volatile uint8_t dds_interp = 1;
+
+/* 通道2相位 = 通道1相位 * dds_ratio + dds_phase_offset */
+static volatile uint32_t dds_phase_offset = 0;
+static volatile uint8_t dds_ratio = 1;
+static uint16_t dds_phase_deg10 = 0;
+
+static dds_clock_fn dds_clock = 0;
+static uint32_t dds_fill_cycles = 0;
+static uint16_t dds_fill_len = 0;
+static uint32_t dds_sample_count = 0;               /* 已生成的输出点数 */
+
+/* 当前频率字开始生效的输出点序号和该点的相位, 供按输出相位做相关运算的模块使用 */
+static volatile uint32_t dds_origin_step = 0;
+static volatile uint32_t dds_origin_sample = 0;
+static volatile uint32_t dds_origin_phase = 0;
+static volatile uint32_t dds_origin_seq = 0;        /* 每次更新后加一, 读取时据此检测被中断修改 */
+
+/* 扫频状态, 只在填充函数(DMA中断)中推进 */
+static volatile dds_sweep_kind_t sweep_kind = DDS_SWEEP_OFF;
+static uint8_t sweep_log = 0;
+static uint32_t sweep_m_start, sweep_m_stop;        /* 起止频率字 */
+static uint32_t sweep_m;                            /* 阶梯扫频: 当前频率字 */
+static uint64_t sweep_ratio_q28;                    /* 对数阶梯: 相邻两级频率字之比, Q36.28, 比值可达2^31 */
+static uint64_t sweep_m64;                          /* 连续扫频: 频率字, Q32.32 */
+static int64_t sweep_dm64;                          /* 线性连续扫频: 每段的增量, Q32.32 */
+static int32_t sweep_k_q30;                         /* 对数连续扫频: 每段的相对增量, Q30 */
+static uint32_t sweep_total, sweep_step_len, sweep_pos;
+static uint16_t sweep_steps, sweep_step_idx;
+
+/* 同步标记: 每一级(连续扫频时每1/steps扫描时间)开始时记录 */
+static volatile uint8_t sweep_marker = 0;
+static volatile uint32_t sweep_marker_count = 0;
+static volatile uint32_t sweep_marker_sample = 0;
+static volatile uint32_t sweep_marker_freq = 0;
+
+/**
+ * @brief       生成正弦表
+ *   @note      (cos, sin)以Q30每次旋转2pi/N, 得到1/4周期, 再按对称性展开.
+ *              逐点旋转的舍入误差只线性累积, 与理想正弦的偏差在Q15的1LSB以内.
+ */
+void dds_init(void)
+{
+  int64_t x = 1LL << 30, y = 0;
+  uint32_t i, q = DDS_LUT_SIZE / 4;
+
+  dds_lut[0] = 0;
+  for(i = 1; i <= q; i++) {
+    int64_t xn = (x * DDS_STEP_COS_Q30 - y * DDS_STEP_SIN_Q30 + (1LL << 29)) >> 30;
+    int64_t yn = (y * DDS_STEP_COS_Q30 + x * DDS_STEP_SIN_Q30 + (1LL << 29)) >> 30;
+    int32_t v;
+
+    x = xn;
+    y = yn;
+    v = (int32_t)((y * 32767 + (1LL << 29)) >> 30);
+    if(v > 32767) v = 32767;
+    dds_lut[i] = v;
+  }
+
+  for(i = 1; i < q; i++) {
+    dds_lut[2 * q - i] = dds_lut[i];
+  }
+  dds_lut[2 * q] = 0;
+  for(i = 1; i < 2 * q; i++) {
+    dds_lut[2 * q + i] = -dds_lut[i];
+  }
+  dds_lut[DDS_LUT_SIZE] = dds_lut[0];
+
+  dds_set_frequency(dds_freq_mhz);
+}
+
+/* 设置输出点速率, 频率字按当前频率重新计算 */
+void dds_set_rate(uint32_t sample_rate)
+{
+  if(sample_rate == 0) sample_rate = 1;
+  dds_rate = sample_rate;
+  dds_set_frequency(dds_freq_mhz);
+}
+
+/**
+ * @brief       设置输出频率
+ *   @note      M = round(f * 2^32 / fs), 只改写频率字, 相位连续. 频率上限为fs/2.
+ * @param       freq_mhz: 频率, 单位mHz
+ * @retval      实际频率, 单位mHz
+ */
+uint32_t dds_set_frequency(uint32_t freq_mhz)
+{
+  uint64_t div = (uint64_t)dds_rate * 1000U;
+  uint64_t m;
+
+  if((uint64_t)freq_mhz * 2 > div) freq_mhz = (uint32_t)(div / 2);
+  dds_freq_mhz = freq_mhz;
+
+  m = (((uint64_t)freq_mhz << 32) + div / 2) / div;
+  if(m > 0x80000000U) m = 0x80000000U;
+  if(sweep_kind == DDS_SWEEP_OFF) {
+    dds_step = (uint32_t)m;     /* 扫频时只记下频率, 停止扫频后生效 */
+  }
+  return dds_get_frequency();
+}
+
+/* ch: 0为通道1, 1为通道2 */
+void dds_set_shape(uint8_t ch, dds_shape_t shape)
+{
+  if(ch >= DDS_CHANNELS) return;
+  if(shape >= DDS_SHAPE_COUNT) shape = DDS_SINE;
+  dds_ch[ch].shape = shape;
+}
+
+/* 方波占空比, 单位0.1%, 0~1000 */
+void dds_set_duty(uint8_t ch, uint16_t duty_permille)
+{
+  if(ch >= DDS_CHANNELS) return;
+  if(duty_permille > 1000) duty_permille = 1000;
+  dds_ch[ch].duty = duty_permille;
+  dds_ch[ch].duty_phase = (duty_permille == 1000) ? 0xFFFFFFFFU :
+                          (uint32_t)(((uint64_t)duty_permille << 32) / 1000U);
+}
+
+/* 峰峰值和中心值, 12位DAC码, 超出0~4095的部分被削去 */
+void dds_set_level(uint8_t ch, uint16_t amp, uint16_t offset)
+{
+  if(ch >= DDS_CHANNELS) return;
+  dds_ch[ch].amp = amp;
+  dds_ch[ch].offset = offset;
+}
+
+/**
+ * @brief       设置通道2相对通道1的相位差
+ *   @note      两个通道由同一个相位累加器导出, 相位差是精确的, 不随时间漂移.
+ * @param       deg_x10: 相位差, 单位0.1度, 0~3599
+ */
+void dds_set_phase_offset(uint16_t deg_x10)
+{
+  deg_x10 %= 3600;
+  dds_phase_deg10 = deg_x10;
+  dds_phase_offset = (uint32_t)(((uint64_t)deg_x10 << 32) / 3600U);
+}
+
+/* 通道2频率为通道1的k倍(1~8), 用于李萨如图形 */
+void dds_set_ratio(uint8_t k)
+{
+  if(k < 1) k = 1;
+  if(k > 8) k = 8;
+  dds_ratio = k;
+}
+
+/* 正弦查表时是否线性插值 */
+void dds_set_interp(uint8_t enable)
+{
+  dds_interp = enable ? 1 : 0;
+}
+
+void dds_set_clock(dds_clock_fn clock)
+{
+  dds_clock = clock;
+}
+
+/* 相位归零, 下一个输出点从波形起点开始, 输出点计数也归零 */
+void dds_reset_phase(void)
+{
+  dds_phase = 0;
+  dds_sample_count = 0;
+  dds_origin_step = 0;
+}
+
+/* 波形值 -32768~32767 缩放到DAC码 */
+static inline uint16_t dds_scale(int32_t w, int32_t amp, int32_t offset)
+{
+  int32_t v = offset + ((w * amp) >> 16);
+
+  if(v < 0) v = 0;
+  if(v > 4095) v = 4095;
+  return (uint16_t)v;
+}
+
+/* 给定相位处的波形值, -32768~32767 */
+static inline int32_t dds_wave(uint32_t phase, dds_shape_t shape, uint8_t interp, uint32_t duty)
+{
+  switch(shape) {
+    case DDS_SINE:
+      if(interp) {
+        uint32_t idx = phase >> (32 - DDS_LUT_BITS);
+        int32_t frac = (phase >> DDS_FRAC_SHIFT) & 0xFFFF;
+        int32_t s0 = dds_lut[idx];
+        return s0 + (((dds_lut[idx + 1] - s0) * frac) >> 16);
+      }
+      return dds_lut[phase >> (32 - DDS_LUT_BITS)];
+    case DDS_TRIANGLE:
+      /* 相位0为最低点, 半周期处为最高点 */
+      return (int32_t)((phase ^ (uint32_t)((int32_t)phase >> 31)) >> 15) - 32768;
+    case DDS_SAWTOOTH:
+      return (int32_t)(phase >> 16) - 32768;
+    default:
+      return (phase < duty) ? 32767 : -32768;
+  }
+}
+
+/**
+ * @brief       生成一个通道的n个输出点
+ *   @note      参数在循环前读入局部变量, 每种波形一个内层循环, 循环内只有累加, 查表/移位和缩放.
+ * @param       dst   : 输出, 每隔stride个半字写一个点
+ * @param       n     : 点数
+ * @param       stride: 1为单通道缓冲, 2为双通道交织缓冲
+ * @param       ch    : 通道
+ * @param       phase : 第一个点的相位
+ * @param       step  : 频率字
+ */
+static void dds_render(uint16_t *dst, uint16_t n, uint8_t stride, uint8_t ch, uint32_t phase, uint32_t step)
+{
+  int32_t amp = dds_ch[ch].amp, offset = dds_ch[ch].offset;
+  uint32_t duty = dds_ch[ch].duty_phase;
+  uint16_t *end = dst + (uint32_t)n * stride;
+
+  switch(dds_ch[ch].shape) {
+    case DDS_SINE:
+      if(dds_interp) {
+        for(; dst < end; dst += stride, phase += step) {
+          *dst = dds_scale(dds_wave(phase, DDS_SINE, 1, 0), amp, offset);
+        }
+      } else {
+        for(; dst < end; dst += stride, phase += step) {
+          *dst = dds_scale(dds_wave(phase, DDS_SINE, 0, 0), amp, offset);
+        }
+      }
+      break;
+    case DDS_TRIANGLE:
+      for(; dst < end; dst += stride, phase += step) {
+        *dst = dds_scale(dds_wave(phase, DDS_TRIANGLE, 0, 0), amp, offset);
+      }
+      break;
+    case DDS_SAWTOOTH:
+      for(; dst < end; dst += stride, phase += step) {
+        *dst = dds_scale(dds_wave(phase, DDS_SAWTOOTH, 0, 0), amp, offset);
+      }
+      break;
+    default:
+      for(; dst < end; dst += stride, phase += step) {
+        *dst = dds_scale(dds_wave(phase, DDS_SQUARE, 0, duty), amp, offset);
+      }
+      break;
+  }
+}
+
+/**
+ * @brief       推进扫频, 设置接下来一段输出点的频率字
+ *   @note      阶梯扫频在每一级开始时更新频率字: 线性为起点加 i*(M2-M1)/(S-1), 对数为上一级乘以固定比值.
+ *              连续扫频每DDS_SWEEP_CHUNK点更新一次: 线性加固定增量, 对数加 M*k (k为每段的相对增量),
+ *              都只有加法, 移位和整数乘法, 没有除法和浮点.
+ * @param       len  : 剩余待生成的点数
+ * @param       index: 下一个点的序号(dds_sample_count计数)
+ * @retval      频率字不变的点数, 不超过len
+ */
+static uint16_t dds_sweep_advance(uint16_t len, uint32_t index)
+{
+  uint32_t seg = (sweep_kind == DDS_SWEEP_CHIRP) ? DDS_SWEEP_CHUNK : sweep_step_len;
+  uint32_t left;
+
+  if(sweep_pos == 0) {
+    sweep_step_idx = 0;
+    sweep_m = sweep_m_start;
+    sweep_m64 = (uint64_t)sweep_m_start << 32;
+  } else if(sweep_kind == DDS_SWEEP_CHIRP && sweep_pos % DDS_SWEEP_CHUNK == 0) {
+    if(sweep_log) {
+      sweep_m64 += (uint64_t)((int64_t)(sweep_m64 >> 30) * sweep_k_q30);
+    } else {
+      sweep_m64 += (uint64_t)sweep_dm64;
+    }
+  }
+
+  if(sweep_pos % sweep_step_len == 0 && sweep_pos != 0) {
+    sweep_step_idx++;
+    if(sweep_kind == DDS_SWEEP_STEP) {
+      if(sweep_step_idx >= sweep_steps - 1) {
+        sweep_m = sweep_m_stop;     /* 最后一级对准终点, 不累积误差 */
+      } else if(sweep_log) {
+        /* 整数部分和小数部分分开乘, 每个乘积都不超过64位 */
+        sweep_m = (uint32_t)((uint64_t)sweep_m * (uint32_t)(sweep_ratio_q28 >> 28) +
+                             (((uint64_t)sweep_m * (uint32_t)(sweep_ratio_q28 & 0x0FFFFFFFU) + (1U << 27)) >> 28));
+      } else {
+        sweep_m = sweep_m_start + (int32_t)(((int64_t)sweep_m_stop - sweep_m_start) * sweep_step_idx / (sweep_steps - 1));
+      }
+    }
+  }
+  dds_step = (sweep_kind == DDS_SWEEP_CHIRP) ? (uint32_t)(sweep_m64 >> 32) : sweep_m;
+
+  if(sweep_pos % sweep_step_len == 0) {
+    sweep_marker_sample = index;
+    sweep_marker_freq = dds_get_frequency();
+    sweep_marker_count++;
+    sweep_marker = 1;
+  }
+
+  left = seg - sweep_pos % seg;
+  if(left < len) len = left;
+  sweep_pos += len;
+  if(sweep_pos >= sweep_total) sweep_pos = 0;     /* 扫描结束, 从起点重新开始 */
+  return len;
+}
+
+/* 生成n个点, 扫频时按频率字不变的段分别生成 */
+static void dds_generate(uint16_t *dst, uint16_t n, uint8_t dual)
+{
+  uint32_t phase = dds_phase;
+  uint8_t k = dds_ratio;
+  uint16_t done = 0;
+
+  while(done < n) {
+    uint16_t len = n - done;
+    uint32_t step;
+
+    if(sweep_kind != DDS_SWEEP_OFF) {
+      len = dds_sweep_advance(len, dds_sample_count + done);
+    }
+    step = dds_step;
+    if(step != dds_origin_step) {
+      dds_origin_step = step;
+      dds_origin_sample = dds_sample_count + done;
+      dds_origin_phase = phase;
+      dds_origin_seq++;
+    }
+
+    if(dual) {
+      dds_render(dst + 2 * done, len, 2, 0, phase, step);
+      dds_render(dst + 2 * done + 1, len, 2, 1, phase * k + dds_phase_offset, step * k);
+    } else {
+      dds_render(dst + done, len, 1, 0, phase, step);
+    }
+    phase += step * len;
+    done += len;
+  }
+  dds_phase = phase;
+  dds_sample_count += n;
+}
+
+/**
+ * @brief       填充通道1的n个输出点, 在DAC DMA中断中调用
+ *   @note      设置了周期计数器时记录本次填充的耗时.
+ * @param       dst: 输出缓冲, 12位右对齐
+ * @param       n  : 点数
+ */
+void dds_fill(uint16_t *dst, uint16_t n)
+{
+  uint32_t t0 = dds_clock ? dds_clock() : 0;
+
+  dds_generate(dst, n, 0);
+
+  if(dds_clock) {
+    dds_fill_cycles = dds_clock() - t0;
+    dds_fill_len = n;
+  }
+}
+
+/**
+ * @brief       填充双通道的n个输出点, 在DAC DMA中断中调用
+ *   @note      每个字的低半字为通道1, 高半字为通道2, 与DHR12RD的位置一致, 用32位DMA写入.
+ * @param       dst: 输出缓冲
+ * @param       n  : 点数(字)
+ */
+void dds_fill_dual(uint32_t *dst, uint16_t n)
+{
+  uint32_t t0 = dds_clock ? dds_clock() : 0;
+
+  dds_generate((uint16_t *)dst, n, 1);
+
+  if(dds_clock) {
+    dds_fill_cycles = dds_clock() - t0;
+    dds_fill_len = n;
+  }
+}
+
+/* 频率(mHz)对应的频率字 */
+static uint32_t dds_tuning_word(uint32_t freq_mhz)
+{
+  uint64_t div = (uint64_t)dds_rate * 1000U;
+  uint64_t m;
+
+  if((uint64_t)freq_mhz * 2 > div) freq_mhz = (uint32_t)(div / 2);
+  m = (((uint64_t)freq_mhz << 32) + div / 2) / div;
+  if(m > 0x80000000U) m = 0x80000000U;
+  if(m == 0) m = 1;
+  return (uint32_t)m;
+}
+
+/**
+ * @brief       开始扫频, 到终点后从起点重新开始
+ *   @note      扫描时间按block取整, 每一级的长度是block的整数倍, 同步标记总在填充块的第一个点,
+ *              调用者可在该块开始输出时产生GPIO脉冲. 比值和增量在这里一次算好(可用浮点),
+ *              之后逐点/逐段只做整数运算.
+ * @param       kind       : DDS_SWEEP_STEP阶梯, DDS_SWEEP_CHIRP连续
+ * @param       f_start_mhz: 起始频率, mHz
+ * @param       f_stop_mhz : 终止频率, mHz, 可低于起始频率
+ * @param       duration_ms: 一次扫描的时间
+ * @param       steps      : 阶梯数(连续扫频时为同步标记数), 至少2
+ * @param       log        : 1对数间隔, 0线性间隔
+ * @param       block      : 每次填充的点数, 为DDS_SWEEP_CHUNK的整数倍
+ */
+void dds_sweep_start(dds_sweep_kind_t kind, uint32_t f_start_mhz, uint32_t f_stop_mhz,
+                     uint32_t duration_ms, uint16_t steps, uint8_t log, uint16_t block)
+{
+  uint32_t total;
+  float span;
+
+  sweep_kind = DDS_SWEEP_OFF;
+  if(kind == DDS_SWEEP_OFF) return;
+
+  if(steps < 2) steps = 2;
+  if(block < DDS_SWEEP_CHUNK) block = DDS_SWEEP_CHUNK;
+  block -= block % DDS_SWEEP_CHUNK;
+
+  sweep_m_start = dds_tuning_word(f_start_mhz);
+  sweep_m_stop = dds_tuning_word(f_stop_mhz);
+  sweep_log = log ? 1 : 0;
+  sweep_steps = steps;
+
+  total = (uint32_t)((uint64_t)duration_ms * dds_rate / 1000U);
+  sweep_step_len = total / steps / block * block;
+  if(sweep_step_len < block) sweep_step_len = block;
+  sweep_total = sweep_step_len * steps;
+
+  span = logf((float)sweep_m_stop / (float)sweep_m_start);
+  if(kind == DDS_SWEEP_STEP) {
+    /* 频率字在1~2^31之间, 比值不超过2^31, Q28下不超过2^59, 转换为64位无溢出 */
+    sweep_ratio_q28 = (uint64_t)(expf(span / (steps - 1)) * 268435456.0f + 0.5f);
+  } else {
+    uint32_t chunks = sweep_total / DDS_SWEEP_CHUNK;
+    sweep_dm64 = (((int64_t)sweep_m_stop - sweep_m_start) << 32) / (int64_t)chunks;
+    sweep_k_q30 = (int32_t)lrintf(expm1f(span / chunks) * 1073741824.0f);
+  }
+
+  sweep_pos = 0;
+  sweep_marker = 0;
+  sweep_marker_count = 0;
+  sweep_kind = kind;
+}
+
+/* 停止扫频, 恢复dds_set_frequency()设置的频率 */
+void dds_sweep_stop(void)
+{
+  sweep_kind = DDS_SWEEP_OFF;
+  dds_set_frequency(dds_freq_mhz);
+}
+
+dds_sweep_kind_t dds_sweep_get_kind(void)
+{
+  return sweep_kind;
+}
+
+/* 上一次填充是否以同步标记开始, 读后清除 */
+uint8_t dds_sweep_take_marker(void)
+{
+  uint8_t m = sweep_marker;
+  sweep_marker = 0;
+  return m;
+}
+
+/* 自扫频开始以来的同步标记数 */
+uint32_t dds_sweep_marker_count(void)
+{
+  return sweep_marker_count;
+}
+
+/* 最近一个同步标记的输出点序号, 乘以输出点周期即为时间戳 */
+uint32_t dds_sweep_marker_sample(void)
+{
+  return sweep_marker_sample;
+}
+
+/* 最近一个同步标记处的频率, mHz */
+uint32_t dds_sweep_marker_freq(void)
+{
+  return sweep_marker_freq;
+}
+
+/* 当前级序号, 0 ~ steps-1 */
+uint16_t dds_sweep_step_index(void)
+{
+  return sweep_step_idx;
+}
+
+/* 已生成的输出点数 */
+uint32_t dds_get_sample_count(void)
+{
+  return dds_sample_count;
+}
+
+/**
+ * @brief       当前频率字从哪个输出点开始生效
+ *   @note      频率字只在填充时切换, 切换处的输出点序号和相位在这里记下. 之后第j个输出点的相位为
+ *              phase + (j - sample) * M, 调用者可据此得到每个输出点的准确相位. 可在主循环中调用.
+ * @param       sample: 输出, 频率字开始生效的输出点序号(dds_get_sample_count()计数)
+ * @param       phase : 输出, 该点的通道1相位
+ * @retval      频率字M, 0表示自相位归零以来还没有填充过
+ */
+uint32_t dds_get_origin(uint32_t *sample, uint32_t *phase)
+{
+  uint32_t seq, step;
+
+  do {
+    seq = dds_origin_seq;
+    step = dds_origin_step;
+    *sample = dds_origin_sample;
+    *phase = dds_origin_phase;
+  } while(seq != dds_origin_seq);
+  return step;
+}
+
+/* Q15正弦表, DDS_LUT_SIZE+1点, 下标为相位的高DDS_LUT_BITS位 */
+const int16_t *dds_sine_table(void)
+{
+  return dds_lut;
+}
+
+/* 通道1相位为phase时该通道的输出值(DAC码), 用于画参考迹线, 不改变累加器 */
+uint16_t dds_sample(uint8_t ch, uint32_t phase)
+{
+  if(ch >= DDS_CHANNELS) return 0;
+  if(ch == 1) phase = phase * dds_ratio + dds_phase_offset;
+  return dds_scale(dds_wave(phase, dds_ch[ch].shape, dds_interp, dds_ch[ch].duty_phase),
+                   dds_ch[ch].amp, dds_ch[ch].offset);
+}
+
+uint32_t dds_get_rate(void)
+{
+  return dds_rate;
+}
+
+uint32_t dds_get_tuning_word(void)
+{
+  return dds_step;
+}
+
+/* 实际输出频率 M * fs / 2^32, 单位mHz */
+uint32_t dds_get_frequency(void)
+{
+  return (uint32_t)(((uint64_t)dds_step * dds_rate * 1000U + (1ULL << 31)) >> 32);
+}
+
+dds_shape_t dds_get_shape(uint8_t ch)
+{
+  return (ch < DDS_CHANNELS) ? dds_ch[ch].shape : DDS_SINE;
+}
+
+uint16_t dds_get_duty(uint8_t ch)
+{
+  return (ch < DDS_CHANNELS) ? dds_ch[ch].duty : 0;
+}
+
+/* 通道2相对通道1的相位差, 0.1度 */
+uint16_t dds_get_phase_offset(void)
+{
+  return dds_phase_deg10;
+}
+
+uint8_t dds_get_ratio(void)
+{
+  return dds_ratio;
+}
+
+uint8_t dds_get_interp(void)
+{
+  return dds_interp;
+}
+
+/* 最近一次填充平均每点耗时(周期计数, 双通道时为每对点), 乘以100 */
+uint32_t dds_cycles_per_sample_x100(void)
+{
+  if(dds_fill_len == 0) return 0;
+  return dds_fill_cycles * 100U / dds_fill_len;
+}
+
+const char *dds_shape_name(dds_shape_t shape)
+{
+  static const char *const names[DDS_SHAPE_COUNT] = { "Sine", "Tri", "Saw", "Square" };
+  return (shape < DDS_SHAPE_COUNT) ? names[shape] : "?";
+}
@@ -0,0 +1,193 @@
+#include "ets.h"
+#include "capture.h"
+
+/* 时间网格: 每格的累加和与次数, RAM占用 460*(4+2) = 2760字节 */
+static uint32_t ets_sum[ETS_MAX_BINS];
+static uint16_t ets_cnt[ETS_MAX_BINS];
+
+static uint8_t ets_factor = 10;
+static uint16_t ets_bins = ETS_MAX_BINS;
+static uint16_t ets_pre_bins = ETS_MAX_BINS / 2;    /* 过电平时刻所在的格 */
+static uint16_t ets_rec_len = ETS_MAX_BINS / 10 + 4;
+static uint32_t ets_records = 0;
+static volatile uint32_t ets_seq = 0;    /* 每次修改网格后加一, 主循环据此检测读取期间被中断修改 */
+
+/* 中断中使用: 当前记录的亚采样偏移和记录缓冲 */
+static volatile uint16_t ets_pending_frac = 0;
+static uint16_t ets_rec[ETS_MAX_RECORD];
+
+/**
+ * @brief       设置等效采样倍数和网格
+ * @param       factor        : 每个实际采样间隔细分的格数, ETS_MIN_FACTOR~ETS_MAX_FACTOR
+ * @param       bins          : 网格点数(显示点数)
+ * @param       pretrigger_pct: 过电平时刻在网格中的位置 0~100%
+ */
+void ets_configure(uint8_t factor, uint16_t bins, uint8_t pretrigger_pct)
+{
+  if(factor < ETS_MIN_FACTOR) factor = ETS_MIN_FACTOR;
+  if(factor > ETS_MAX_FACTOR) factor = ETS_MAX_FACTOR;
+  if(bins > ETS_MAX_BINS) bins = ETS_MAX_BINS;
+  if(bins < 2) bins = 2;
+  if(pretrigger_pct > 100) pretrigger_pct = 100;
+
+  ets_factor = factor;
+  ets_bins = bins;
+  ets_pre_bins = (uint32_t)bins * pretrigger_pct / 100;
+
+  /* 一条记录需要覆盖整个网格, 两端各多留一个采样 */
+  ets_rec_len = (bins + factor - 1) / factor + 2;
+  if(ets_rec_len > ETS_MAX_RECORD) ets_rec_len = ETS_MAX_RECORD;
+
+  ets_reset();
+}
+
+/* 清空网格 */
+void ets_reset(void)
+{
+  uint16_t i;
+
+  for(i = 0; i < ETS_MAX_BINS; i++) {
+    ets_sum[i] = 0;
+    ets_cnt[i] = 0;
+  }
+  ets_records = 0;
+}
+
+uint8_t ets_get_factor(void)
+{
+  return ets_factor;
+}
+
+/* 网格点数 */
+uint16_t ets_get_bins(void)
+{
+  return ets_bins;
+}
+
+/* 触发采集引擎应使用的记录长度(实际采样点) */
+uint16_t ets_record_length(void)
+{
+  return ets_rec_len;
+}
+
+/* 已累计的记录数 */
+uint32_t ets_record_count(void)
+{
+  return ets_records;
+}
+
+/**
+ * @brief       把一条触发记录按亚采样偏移放入时间网格
+ *   @note      过电平时刻 tc = (trig_idx - 1) + frac/factor (以采样间隔为单位),
+ *              第i个采样落在 pre_bins + (i - trig_idx + 1)*factor - frac 格.
+ * @param       record  : 记录
+ * @param       len     : 记录长度
+ * @param       trig_idx: 记录中第一个过电平之后的采样的下标
+ * @param       frac    : 过电平时刻在 trig_idx-1 与 trig_idx 两个采样之间的位置, 0~factor(四舍五入)
+ */
+void ets_add_record(const uint16_t *record, uint16_t len, uint16_t trig_idx, uint16_t frac)
+{
+  int32_t bin = (int32_t)ets_pre_bins - ((int32_t)trig_idx - 1) * ets_factor - frac;
+  uint8_t decay = 0;
+  uint16_t i;
+
+  for(i = 0; i < len; i++, bin += ets_factor) {
+    if(bin < 0) continue;
+    if(bin >= ets_bins) break;
+    ets_sum[bin] += record[i];
+    if(++ets_cnt[bin] >= ETS_DECAY_COUNT) decay = 1;
+  }
+
+  if(decay) {
+    /* 次数减半(至少保留1次), 累加和按比例缩小, 保持每格的平均值不变.
+     * 累加和不超过4095*ETS_DECAY_COUNT, 乘以一半次数仍在32位内 */
+    for(i = 0; i < ets_bins; i++) {
+      uint16_t cnt = ets_cnt[i];
+
+      if(cnt > 1) {
+        uint16_t half = (cnt + 1) >> 1;
+        ets_sum[i] = (ets_sum[i] * half + cnt / 2) / cnt;
+        ets_cnt[i] = half;
+      }
+    }
+  }
+  ets_records++;
+  ets_seq++;
+}
+
+/**
+ * @brief       由网格重建波形
+ *   @note      有数据的格取平均值, 空格用两侧最近的有效格线性插值, 两端空格取最近的有效值.
+ *              可在主循环中调用: 每格的累加和与次数成对读取, 读取期间网格被中断修改时重读该格.
+ * @param       out: 输出, ets_bins个点
+ * @retval      有数据的格数, 可用来判断覆盖程度
+ */
+uint16_t ets_reconstruct(uint16_t *out)
+{
+  int32_t last = -1;
+  uint16_t filled = 0;
+  uint16_t i, j;
+
+  for(i = 0; i < ets_bins; i++) {
+    uint32_t sum, seq;
+    uint16_t cnt;
+
+    do {
+      seq = ets_seq;
+      sum = ets_sum[i];
+      cnt = ets_cnt[i];
+    } while(seq != ets_seq);
+    if(cnt == 0) continue;
+
+    out[i] = sum / cnt;
+    filled++;
+
+    if(last < 0) {
+      for(j = 0; j < i; j++) out[j] = out[i];
+    } else if(i - last > 1) {
+      int32_t v0 = out[last], dv = (int32_t)out[i] - v0, span = i - last;
+      for(j = last + 1; j < i; j++) {
+        out[j] = v0 + dv * (int32_t)(j - last) / span;
+      }
+    }
+    last = i;
+  }
+
+  if(last < 0) {
+    for(i = 0; i < ets_bins; i++) out[i] = 2048;
+  } else {
+    for(j = last + 1; j < ets_bins; j++) out[j] = out[last];
+  }
+  return filled;
+}
+
+/* 记下本次触发的亚采样偏移(0~factor), 由硬件触发检测函数在找到触发点时调用 */
+void ets_note_trigger(uint16_t frac)
+{
+  ets_pending_frac = frac;
+}
+
+/**
+ * @brief       等效时间采样的数据块处理函数, 在DMA中断中调用
+ *   @note      记录完成后立即放入网格并重新布防, 同一数据块中剩余的采样继续送入触发采集
+ */
+void ets_push(const uint16_t *samples, uint16_t n)
+{
+  while(n > 0) {
+    uint16_t used = capture_feed(samples, n);
+
+    samples += used;
+    n -= used;
+
+    if(capture_ready()) {
+      uint16_t len = capture_record_length();
+
+      if(len > ETS_MAX_RECORD) len = ETS_MAX_RECORD;
+      capture_copy_record(ets_rec, len);
+      ets_add_record(ets_rec, len, capture_trigger_index(), ets_pending_frac);
+      capture_arm();
+    } else if(used == 0) {
+      break;
+    }
+  }
+}
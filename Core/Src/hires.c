@@ -0,0 +1,188 @@
+#include "hires.h"
+#include "capture.h"
+#include "trigger.h"
+
+/* 抽取比, 1表示关闭高分辨率模式 */
+static uint16_t hires_r = 1;
+static uint8_t hires_log2r = 0;
+static uint8_t hires_shift = 0;        /* CIC输出右移位数, 缩放到16位 */
+static uint8_t hires_fir_on = 0;
+
+/* CIC状态, 跨数据块连续 */
+static uint32_t integ1 = 0, integ2 = 0;
+static uint32_t comb1 = 0, comb2 = 0;
+static uint16_t phase = 0;
+static uint8_t primed = 0;              /* 梳状器延迟已装入有效数据 */
+
+/* FIR补偿状态: 前两个CIC输出 */
+static int32_t fir_x1 = 0, fir_x2 = 0;
+static uint8_t fir_fill = 0;
+
+/**
+ * @brief       设置抽取比和FIR补偿
+ * @param       decimation: 抽取比R, 取2的整数次幂 HIRES_MIN_DECIMATION~HIRES_MAX_DECIMATION, 1为关闭
+ * @param       fir       : 1为使用FIR补偿
+ *   @note      参数不变时不复位滤波器状态, 以免每次重新布防都产生启动暂态
+ */
+void hires_configure(uint16_t decimation, uint8_t fir)
+{
+  uint8_t log2r = 0;
+
+  if(decimation > 1) {
+    if(decimation < HIRES_MIN_DECIMATION) decimation = HIRES_MIN_DECIMATION;
+    if(decimation > HIRES_MAX_DECIMATION) decimation = HIRES_MAX_DECIMATION;
+    while((2U << log2r) <= decimation) log2r++;
+    decimation = 1U << log2r;
+  } else {
+    decimation = 1;
+  }
+  fir = fir ? 1 : 0;
+
+  if(decimation == hires_r && fir == hires_fir_on) return;
+
+  hires_r = decimation;
+  hires_log2r = log2r;
+  hires_shift = (log2r >= 2) ? (2 * log2r - 4) : 0;
+  hires_fir_on = fir;
+  hires_reset();
+}
+
+uint16_t hires_get_decimation(void)
+{
+  return hires_r;
+}
+
+uint8_t hires_get_fir(void)
+{
+  return hires_fir_on;
+}
+
+/* 标称有效位数 12 + log2(R)/2 */
+uint8_t hires_bits(void)
+{
+  return 12 + hires_log2r / 2;
+}
+
+/* 按扫描时间选择抽取比 */
+uint16_t hires_select_decimation(uint32_t sweep_ms)
+{
+  if(sweep_ms >= HIRES_SWEEP_MS_16BIT) return 256;
+  if(sweep_ms >= HIRES_SWEEP_MS_15BIT) return 64;
+  return 16;
+}
+
+/* 清除滤波器状态 */
+void hires_reset(void)
+{
+  integ1 = integ2 = 0;
+  comb1 = comb2 = 0;
+  phase = 0;
+  primed = 0;
+  fir_x1 = fir_x2 = 0;
+  fir_fill = 0;
+}
+
+/* FIR补偿, 输出比输入延迟一个点; 前两个输入只装入延迟线, 返回0 */
+static uint8_t hires_fir(int32_t x, uint16_t *out)
+{
+  int32_t y;
+
+  if(fir_fill < 2) {
+    fir_fill++;
+    fir_x2 = fir_x1;
+    fir_x1 = x;
+    return 0;
+  }
+
+  y = fir_x1 + ((2 * fir_x1 - fir_x2 - x + 4) >> 3);
+  if(y < 0) y = 0;
+  if(y > 0xFFFF) y = 0xFFFF;
+  *out = y;
+  fir_x2 = fir_x1;
+  fir_x1 = x;
+  return 1;
+}
+
+/**
+ * @brief       对一段采样做CIC抽取, 结果写回buf开头
+ *   @note      第j个输出在读入第(j+1)*R-1个采样之后才写入, 写位置总在读位置之前, 可原地处理.
+ *              启动后的第一个抽取点只用于装入梳状器延迟, 不输出.
+ * @param       buf: 采样数据, 处理后前若干个元素为16位输出
+ * @param       n  : 采样个数
+ * @retval      输出点数
+ */
+uint16_t hires_process(uint16_t *buf, uint16_t n)
+{
+  uint32_t i1 = integ1, i2 = integ2;
+  uint16_t r = hires_r, ph = phase;
+  uint16_t i, m = 0;
+
+  for(i = 0; i < n; i++) {
+    i1 += buf[i];
+    i2 += i1;
+    if(++ph < r) continue;
+    ph = 0;
+
+    {
+      uint32_t c1 = i2 - comb1;
+      uint32_t c2 = c1 - comb2;
+
+      comb1 = i2;
+      comb2 = c1;
+      if(primed < 2) {
+        primed++;
+        continue;
+      }
+      if(hires_shift > 0) {
+        c2 = (c2 + (1U << (hires_shift - 1))) >> hires_shift;
+      }
+      if(c2 > 0xFFFF) c2 = 0xFFFF;
+
+      if(hires_fir_on) {
+        m += hires_fir(c2, &buf[m]);
+      } else {
+        buf[m++] = c2;
+      }
+    }
+  }
+
+  integ1 = i1;
+  integ2 = i2;
+  phase = ph;
+  return m;
+}
+
+/**
+ * @brief       高分辨率模式的数据块处理函数, 在DMA中断中调用
+ *   @note      samples指向DMA缓冲中刚写满的半区, DMA此时正在写另一半, 因此可以原地改写
+ */
+void hires_push(const uint16_t *samples, uint16_t n)
+{
+  uint16_t m = hires_process((uint16_t *)samples, n);
+
+  if(m > 0) {
+    capture_push(samples, m);
+  }
+}
+
+/**
+ * @brief       高分辨率记录的触发检测函数(capture_trigger_fn)
+ *   @note      按每段最多32点右移4位恢复为12位后交给trigger_find(), 触发状态跨段连续
+ */
+int32_t hires_trigger_find(const uint16_t *samples, uint16_t n)
+{
+  uint16_t tmp[32];
+  uint16_t off = 0;
+
+  while(off < n) {
+    uint16_t k = (n - off < 32) ? (n - off) : 32;
+    uint16_t i;
+    int32_t hit;
+
+    for(i = 0; i < k; i++) tmp[i] = samples[off + i] >> 4;
+    hit = trigger_find(tmp, k);
+    if(hit >= 0) return off + hit;
+    off += k;
+  }
+  return -1;
+}
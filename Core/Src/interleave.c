@@ -0,0 +1,83 @@
+#include "interleave.h"
+
+/* 小于该平均绝对偏差(LSB)时信号近似直流, 只修正偏置不修正增益 */
+#define INTERLEAVE_MIN_SWING    32
+
+/* 修正参数复位为单位增益, 零偏置 */
+void interleave_cal_reset(interleave_cal_t *cal)
+{
+  cal->gain_q14 = INTERLEAVE_GAIN_ONE;
+  cal->offset = 0;
+}
+
+/**
+ * @brief       由一段原始交替数据估计ADC2相对ADC1的增益和偏置
+ *   @note      两路采样的是同一输入, 均值之差反映偏置失配, 平均绝对偏差之比反映增益失配.
+ *              全部使用整数运算, 可在DMA回调中直接调用.
+ * @param       words: ADC1->DR原始32位数据
+ * @param       count: 数据个数(即采样对数)
+ * @param       cal  : 输出的修正参数, 估计不可信时不改变
+ * @retval      1: 已更新, 0: 增益比超出INTERLEAVE_GAIN_MIN~INTERLEAVE_GAIN_MAX(如一路未接入), 不采用
+ */
+uint8_t interleave_estimate(const uint32_t *words, uint16_t count, interleave_cal_t *cal)
+{
+  uint32_t sum1 = 0, sum2 = 0;
+  uint32_t dev1 = 0, dev2 = 0;
+  uint32_t gain = INTERLEAVE_GAIN_ONE;
+  int32_t mean1, mean2, d;
+  uint16_t i;
+
+  if(count == 0) return 0;
+
+  for(i = 0; i < count; i++) {
+    sum1 += words[i] & 0xFFFF;
+    sum2 += words[i] >> 16;
+  }
+  mean1 = sum1 / count;
+  mean2 = sum2 / count;
+
+  for(i = 0; i < count; i++) {
+    d = (int32_t)(words[i] & 0xFFFF) - mean1;
+    dev1 += (d < 0) ? -d : d;
+    d = (int32_t)(words[i] >> 16) - mean2;
+    dev2 += (d < 0) ? -d : d;
+  }
+
+  if(dev2 >= (uint32_t)INTERLEAVE_MIN_SWING * count) {
+    /* 先在64位中比较, 比值达到4.0时Q14已放不进16位 */
+    uint64_t g = ((uint64_t)dev1 << 14) / dev2;
+
+    if(g < INTERLEAVE_GAIN_MIN || g > INTERLEAVE_GAIN_MAX) return 0;
+    gain = (uint32_t)g;
+  } else if(dev1 >= (uint32_t)INTERLEAVE_MIN_SWING * count) {
+    return 0;                   /* ADC1有信号而ADC2近似直流 */
+  }
+  cal->gain_q14 = (uint16_t)gain;
+  cal->offset = (int16_t)(mean1 - ((mean2 * (int32_t)gain) >> 14));
+  return 1;
+}
+
+/**
+ * @brief       原地解交替并修正ADC2
+ *   @note      每次读写一个32位字, 处理后内存中按uint16_t解读即为时间顺序的采样序列
+ *              (ADC2在前, ADC1在后), 上层显示/触发代码无需区分单ADC或双ADC模式.
+ * @param       words: ADC1->DR原始32位数据, 原地改写
+ * @param       count: 数据个数
+ * @param       cal  : 修正参数
+ */
+void interleave_unpack(uint32_t *words, uint16_t count, const interleave_cal_t *cal)
+{
+  uint16_t i;
+  int32_t a2;
+
+  for(i = 0; i < count; i++) {
+    uint32_t w = words[i];
+
+    a2 = (int32_t)(((w >> 16) * cal->gain_q14) >> 14) + cal->offset;
+    if(a2 < 0) a2 = 0;
+    if(a2 > 4095) a2 = 4095;
+
+    /* 小端: 低半字在前 */
+    words[i] = ((w & 0xFFFF) << 16) | (uint32_t)a2;
+  }
+}
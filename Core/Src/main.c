@@ -20,6 +20,7 @@
 #include "main.h"
 #include "adc.h"
 #include "dac.h"
+#include "dma.h"
 #include "tim.h"
 #include "usart.h"
 #include "gpio.h"
@@ -32,7 +33,21 @@
 #include "lcd.h"
 #include "delay.h"
 #include "touch.h"
+#include "acquisition.h"
+#include "capture.h"
+#include "trigger.h"
+#include "peak.h"
+#include "average.h"
+#include "segment.h"
+#include "ets.h"
+#include "scan.h"
+#include "hires.h"
+#include "dds.h"
+#include "bode.h"
+#include "upload.h"
+#include "ui.h"
 #include <stdio.h>
+#include <string.h>
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -59,6 +74,14 @@
 /* Private function prototypes -----------------------------------------------*/
 void SystemClock_Config(void);
 /* USER CODE BEGIN PFP */
+static void display_record_column(uint16_t idx, uint16_t *adc_min, uint16_t *adc_max);
+static void display_hires_record(void);
+static void hires_average_push(const uint16_t *samples, uint16_t n);
+static uint32_t display_column_rate(void);
+static uint32_t dwt_cycles(void);
+static uint16_t *upload_take_bank(uint16_t points);
+static uint8_t upload_commit(uint16_t points);
+static void upload_reply(uint8_t cmd, upload_status_t status, uint16_t value);
 
 /* USER CODE END PFP */
 
@@ -67,12 +90,76 @@ void SystemClock_Config(void);
 /* DAC波形控制参数 */
 uint16_t dac_amplitude = 1800;
 uint16_t dac_offset = 2048;
-uint16_t dac_frequency_divider = 8;
-uint16_t dac_min_value = 200;
-uint16_t dac_max_value = 3800;
+uint32_t dac_frequency_mhz = DAC_DEFAULT_FREQ_HZ * 1000U;
+uint8_t dac_wave_sel = DDS_TRIANGLE;    /* 0~DDS_SHAPE_COUNT-1: DDS波形, DDS_SHAPE_COUNT: 固定正弦波形表, +1: 上传的任意波形 */
+uint16_t dac_duty = 500;                /* 方波占空比, 0.1% */
+uint8_t dac_ch2_on = 0;                 /* 通道2(PA5)输出, 只在DDS方式下有效 */
+uint8_t dac_ch2_shape = DDS_SINE;       /* 通道2的DDS波形, 占空比与通道1相同 */
+uint16_t dac_ch2_phase = 900;           /* 通道2相对通道1的相位差, 0.1度 */
+uint8_t dac_ch2_ratio = 1;              /* 通道2频率倍数 */
+uint8_t dac_hw_kind = DAC_HWGEN_OFF;    /* DAC内置发生器: 关闭/三角波/噪声 */
+uint8_t dac_hw_overlay = 0;             /* 1: 叠加在DMA输出的波形上作抖动, 0: 单独输出 */
+uint8_t dac_hw_bits = 2;                /* 叠加的幅度位数, 单独输出时由dac_amplitude决定 */
+
+/* 采集参数 */
+uint32_t acq_sample_rate = 0;
+uint8_t capture_pretrigger_pct = 50;
+uint32_t trigger_holdoff_us = 0;        /* 触发释抑时间, 布防时按采样率换算为采样数 */
+
+/* 当前正在扫描显示的触发记录, 峰值检测模式下每列为一对(min, max) */
+static uint16_t display_record[WAVE_WIDTH * 2];
+static uint16_t display_record_len = 0;
+static uint8_t display_record_peak = 0;
+
+/* 多通道扫描采集: 各通道与触发记录对齐的数据 */
+static uint16_t display_scan[SCAN_MAX_CHANNELS][WAVE_WIDTH];
+
+/* 分段采集: segment_view为正在浏览的分段, 等于分段数时叠加显示全部分段 */
+uint8_t segment_mode = 0;
+uint16_t segment_view = 0;
+static uint8_t segment_overlay_drawn = 0;
+static uint8_t segment_reported = 0;
+
+/* 高分辨率模式: 0关闭, 1 CIC, 2 CIC+FIR补偿; hires_mean为最近一条记录的16位平均值 */
+uint8_t hires_mode = 0;
+static uint32_t hires_mean = 0;
+
+/* 平均: average_hooked表示记录由average_push()在中断中累加, average_seen为显示过的记录总数 */
+static uint8_t average_hooked = 0;
+static uint32_t average_seen = 0;
+
+/* 等效时间采样倍数, 0为关闭 */
+uint8_t ets_mode = 0;
+static uint16_t ets_filled = 0;
+
+/* 波特图测量: 0关闭, 1连续扫描, 2扫描一次并保存为直通校准, 完成后转为1 */
+uint8_t bode_mode = 0;
+static acq_mode_t bode_saved_mode = ACQ_MODE_SINGLE;
+static uint32_t bode_saved_rate = ACQ_DEFAULT_SAMPLE_RATE;
 
 volatile uint8_t timer_flag = 0;
 
+/* 信息行, 只重画变化的字符 */
+static ui_text_t ui_info[2];
+
+/* 界面元素的LCD绘制接口 */
+static void ui_lcd_fill(uint16_t sx, uint16_t sy, uint16_t ex, uint16_t ey, uint16_t color)
+{
+  lcd_fill(sx, sy, ex, ey, color);
+}
+
+static void ui_lcd_text(uint16_t x, uint16_t y, uint16_t width, uint8_t size, const char *str,
+                        uint16_t color, uint16_t bg)
+{
+  uint32_t back = g_back_color;
+
+  g_back_color = bg;
+  lcd_show_string(x, y, width, size, size, (char *)str, color);
+  g_back_color = back;
+}
+
+static const ui_backend_t ui_lcd = { ui_lcd_fill, lcd_draw_rectangle, ui_lcd_text };
+
 void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim)
 {
   if(htim->Instance == TIM6)
@@ -91,9 +178,8 @@ int main(void)
 
   /* USER CODE BEGIN 1 */
   uint16_t dac_value = 0;
-  uint32_t adc_value = 0;
-  uint16_t dac_step = 0;
-  uint8_t direction = 1;  /* DAC输出方向: 1=上升, 0=下降 */
+  uint16_t adc_min = 0, adc_max = 0;
+  uint32_t adc_live = 0;
   /* USER CODE END 1 */
 
   /* MCU Configuration--------------------------------------------------------*/
@@ -114,10 +200,15 @@ int main(void)
 
   /* Initialize all configured peripherals */
   MX_GPIO_Init();
+  MX_DMA_Init();
+  MX_ADC1_Init();
+  MX_ADC2_Init();
   MX_ADC3_Init();
   MX_DAC_Init();
   MX_FSMC_Init();
   MX_TIM6_Init();
+  MX_TIM7_Init();
+  MX_TIM8_Init();
   MX_USART1_UART_Init();
   /* USER CODE BEGIN 2 */
   
@@ -139,29 +230,46 @@ int main(void)
   printf("Touch control: Real touch + KEY simulation\\r\\n");
   printf("KEY0: Reset, KEY1: Test buttons\\r\\n");
   
-  /* 启动DAC */
-  HAL_DAC_Start(&hdac, DAC_CHANNEL_1);
-  
   /* 显示初始界面 */
   lcd_clear(WHITE);
   lcd_show_string(120, 20, 300, 24, 24, "STM32 Oscilloscope", BLACK);
   lcd_show_string(140, 50, 200, 20, 20, "Auto 2-Period Sync", BLACK);
   
-  /* 显示控制说明 */
-  lcd_show_string(50, 90, 200, 16, 16, "KEY0: Reset  KEY1: Test", GRAY);
-  lcd_show_string(50, 110, 200, 16, 16, "Connect DAC to ADC", GRAY);
-  lcd_show_string(50, 130, 200, 16, 16, "Touch buttons for control", GRAY);
-  
   /* 初始化波形显示区域 */
   init_waveform_display();
   
-  /* 绘制虚拟按钮 */
+  /* 信息行和虚拟按钮 */
+  ui_init(&ui_lcd);
+  ui_text_init(&ui_info[0], 20, 615, 450, 16, BLACK, WHITE);
+  ui_text_init(&ui_info[1], 20, 635, 450, 16, BLACK, WHITE);
   draw_virtual_buttons();
   
   /* 启动定时器 */
   HAL_TIM_Base_Start_IT(&htim6);
   
-  printf("DAC/ADC Test Started\r\n");
+  /* DWT周期计数器, 用于测量中断内处理耗时 */
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+  segment_set_clock(dwt_cycles);
+  scan_set_clock(dwt_cycles);
+  dds_set_clock(dwt_cycles);
+  bode_set_clock(dwt_cycles);
+  
+  /* 启动DAC波形发生器: TIM7触发 + DMA输出, DDS在DMA半缓冲中断中填充 */
+  dds_init();
+  generator_update();
+  
+  /* 启动TIM8触发 + DMA循环采集, 触发采集引擎在DMA中断中接收数据 */
+  trigger_set_level(TRIGGER_DEFAULT_LEVEL, TRIGGER_DEFAULT_HYSTERESIS);
+  acq_sample_rate = adc_acq_start(ACQ_MODE_SINGLE, ACQ_DEFAULT_SAMPLE_RATE);
+  capture_restart();
+  
+  /* 串口接收任意波形上传 */
+  upload_init(upload_take_bank, upload_commit, upload_reply);
+  usart_rx_start();
+  
+  printf("DAC/ADC Test Started, ADC %lu S/s\r\n", acq_sample_rate);
   
   /* USER CODE END 2 */
 
@@ -169,87 +277,263 @@ int main(void)
   /* USER CODE BEGIN WHILE */
   while (1)
   {
+    /* 处理DMA已写满的半缓冲, 取最新采样点作为实时读数 */
+    acq_block_t blk;
+    while(acq_get_block(&blk))
+    {
+      adc_live = blk.data[blk.len - 1];
+      acq_release_block();
+    }
+    
+    /* 解析串口DMA已收到的上传数据 */
+    const uint8_t *rx_data;
+    uint16_t rx_len;
+    while((rx_len = usart_rx_get(&rx_data)) > 0)
+    {
+      upload_feed(rx_data, rx_len);
+    }
+    
     /* 检查定时器标志 */
     if(timer_flag)
     {
       timer_flag = 0;
       
-      /* 生成DAC输出 - 可调节三角波 */
-      static uint16_t dac_freq_counter = 0;
+      /* 发生器: 生成换表期间推迟的波形更新 */
+      dac_wave_poll();
       
-      /* 频率控制 - 只有当计数器达到分频值时才更新DAC */
-      if(++dac_freq_counter >= dac_frequency_divider) {
-        dac_freq_counter = 0;
-        
-        /* 计算当前的幅度范围 */
-        dac_min_value = dac_offset - dac_amplitude/2;
-        dac_max_value = dac_offset + dac_amplitude/2;
-        
-        /* 限制范围在DAC有效范围内 */
-        if(dac_min_value < 100) dac_min_value = 100;
-        if(dac_max_value > 3900) dac_max_value = 3900;
-        
-        /* 计算动态步长，确保固定的三角波周期 */
-        uint16_t amplitude_range = dac_max_value - dac_min_value;
-        uint16_t triangle_steps = 100;  /* 固定100步完成一个半周期 */
-        uint16_t dynamic_step = amplitude_range / triangle_steps;
-        if(dynamic_step < 1) dynamic_step = 1;  /* 最小步长 */
+      /* DAC参考迹线: 按扫描位置对应的采样时刻取发生器波形, 滚动显示时改为读取实际输出 */
+      dac_value = dac_wave_value_at(waveform_sweep_index(), display_column_rate());
+      
+      if(bode_mode) {
+        /* 波特图: 相关运算在ADC DMA中断中进行, 每完成一个频点画一段, 一次扫描完成后重新开始 */
+        if(bode_poll()) {
+          bode_point_t pt;
+          uint16_t idx = bode_done() - 1;
+          if(bode_get_point(idx, &pt)) {
+            draw_bode_point(idx, pt.freq_mhz, pt.gain_cdb, pt.phase_x10);
+          }
+        }
+        if(!bode_running()) {
+          if(bode_mode == 2) {
+            bode_cal_store();
+            bode_mode = 1;
+          }
+          draw_bode_frame(bode_start_freq(), bode_stop_freq());
+          dds_set_level(0, dac_amplitude, dac_offset);
+          bode_start(dac_amplitude);
+        }
+      } else if(segment_mode) {
+        /* 分段采集: 在中断中连续采集, 全部完成后逐段浏览或叠加显示 */
+        if(!segment_running() && !segment_reported) {
+          segment_reported = 1;
+          printf("Segments: %u x %u samples, rearm max %lu cycles (%lu ns)\r\n",
+                 segment_done(), segment_length(), segment_rearm_cycles_max(),
+                 segment_rearm_cycles_max() * 1000U / (SystemCoreClock / 1000000U));
+        }
         
-        if(direction)
-        {
-          dac_step += dynamic_step;
-          if(dac_step >= dac_max_value) 
-          {
-            dac_step = dac_max_value;
-            direction = 0;
+        if(segment_view >= segment_count()) {
+          if(!segment_running() && !segment_overlay_drawn) {
+            draw_waveform_overlay(segment_data(0), segment_length(), segment_done());
+            segment_overlay_drawn = 1;
+          }
+        } else {
+          uint16_t sweep_idx = waveform_sweep_index();
+          if(sweep_idx == 0 && segment_view < segment_done()) {
+            display_record_len = segment_length();
+            memcpy(display_record, segment_data(segment_view), display_record_len * sizeof(uint16_t));
+            display_record_peak = 0;
           }
+          display_record_column(sweep_idx, &adc_min, &adc_max);
+          detect_period_and_adjust_timebase(dac_value);
+          draw_waveform_span(dac_value, adc_min, adc_max);
         }
-        else
-        {
-          dac_step -= dynamic_step;
-          if(dac_step <= dac_min_value)
-          {
-            dac_step = dac_min_value;
-            direction = 1;
+      } else if(ets_mode && adc_trigger_ets_active()) {
+        /* 等效时间采样: 记录在中断中不断放入时间网格, 每次扫描开始时重建一次 */
+        uint16_t sweep_idx = waveform_sweep_index();
+        if(sweep_idx == 0) {
+          if(ets_get_bins() != waveform_sweep_length() || capture_state() == CAPTURE_IDLE) {
+            capture_restart();    /* 时基改变, 网格重新开始 */
           }
+          ets_filled = ets_reconstruct(display_record);
+          display_record_len = ets_get_bins();
+          display_record_peak = 0;
         }
-      }
-      
-      /* 设置DAC输出值 */
-      dac_value = dac_step;
-      HAL_DAC_SetValue(&hdac, DAC_CHANNEL_1, DAC_ALIGN_12B_R, dac_value);
-      
-      /* 读取ADC值 (单次采样，最高响应速度) */
-      adc_value = adc_get_result(ADC_CHANNEL_1);
-      
+        display_record_column(sweep_idx, &adc_min, &adc_max);
+        detect_period_and_adjust_timebase(dac_value);
+        draw_waveform_span(dac_value, adc_min, adc_max);
+      } else if(adc_acq_get_mode() != ACQ_MODE_SCAN && waveform_roll_update(hires_mode == 0)) {
+        /* 慢速时基: 滚动显示实时采样, 不使用触发记录; 高分辨率模式的慢速时基仍用触发记录 */
+        dac_value = HAL_DAC_GetValue(&hdac, DAC_CHANNEL_1);
+        detect_period_and_adjust_timebase(dac_value);
+        draw_waveform_roll(dac_value, adc_live);
+      } else {
+        /* 每次扫描开始时换用最新的触发记录, 并按扫描方式决定是否重新布防 */
+        uint16_t sweep_idx = waveform_sweep_index();
+        if(sweep_idx == 0) {
+          trigger_sweep_t sweep = trigger_get_sweep();
+        
+          if(average_hooked) {
+            /* 平均: 记录在中断中累加, 有新记录时读出当前平均结果 */
+            if(average_records() != average_seen) {
+              uint16_t len;
+              
+              average_seen = average_records();
+              __disable_irq();
+              len = average_read(display_record, capture_record_length());
+              __enable_irq();
+              if(len > 0) {
+                display_record_len = len;
+                if(hires_get_decimation() > 1) {
+                  display_hires_record();
+                }
+                display_record_peak = 0;
+              }
+              if(sweep == TRIGGER_SWEEP_SINGLE && average_count() >= (1U << average_get_log2())) {
+                capture_disarm();   /* 单次: 平均满N条后保持 */
+              }
+            } else if(capture_state() == CAPTURE_IDLE && sweep != TRIGGER_SWEEP_SINGLE) {
+              capture_restart();
+            } else if(capture_state() == CAPTURE_ARMED && sweep == TRIGGER_SWEEP_AUTO) {
+              capture_force();
+            }
+          } else if(capture_ready()) {
+            display_record_len = capture_record_length();
+            if(adc_acq_get_mode() == ACQ_MODE_SCAN) {
+              /* 各通道按通道间采样时间差插值到通道0的采样时刻 */
+              for(uint8_t ch = 0; ch < scan_channels(); ch++) {
+                scan_copy_record(ch, display_scan[ch], display_record_len);
+              }
+              display_record_peak = 0;
+            } else if(hires_get_decimation() > 1) {
+              capture_copy_record(display_record, display_record_len);
+              display_hires_record();
+              display_record_peak = 0;
+            } else {
+              capture_copy_record(display_record, display_record_len);
+              display_record_peak = (peak_get_factor() > 1);
+            }
+            if(sweep == TRIGGER_SWEEP_SINGLE) {
+              capture_disarm();   /* 单次: 保持这条记录直到重新布防 */
+            } else {
+              capture_restart();
+            }
+          } else if(capture_state() == CAPTURE_IDLE && sweep != TRIGGER_SWEEP_SINGLE) {
+            capture_restart();
+          } else if(capture_state() == CAPTURE_ARMED && sweep == TRIGGER_SWEEP_AUTO) {
+            capture_force();  /* 自动: 一整次扫描都未触发, 强制触发一次, 保持显示刷新 */
+          }
+        }
+        display_record_column(sweep_idx, &adc_min, &adc_max);
       
-      /* 周期检测和时基自动调整 */
-      detect_period_and_adjust_timebase(dac_value);
+        /* 周期检测和时基自动调整 */
+        detect_period_and_adjust_timebase(dac_value);
       
-      /* 绘制波形点 - 真正的示波器效果 */
-      draw_waveform_point(dac_value, adc_value);
+        if(adc_acq_get_mode() == ACQ_MODE_SCAN) {
+          /* 多通道: 每个通道一条迹线 */
+          uint16_t scan_col[SCAN_MAX_CHANNELS] = {0};
+          if(display_record_len > 0) {
+            uint16_t col = (sweep_idx < display_record_len) ? sweep_idx : (display_record_len - 1);
+            for(uint8_t ch = 0; ch < scan_channels(); ch++) {
+              scan_col[ch] = display_scan[ch][col];
+            }
+          }
+          draw_waveform_scan(dac_value, scan_col, scan_channels());
+        } else {
+          /* 绘制波形点 - 真正的示波器效果, 峰值检测模式下画出该列的min~max竖线 */
+          draw_waveform_span(dac_value, adc_min, adc_max);
+        }
+      }
       
       /* 显示基本信息 (每50次更新一次) */
       static uint16_t info_counter = 0;
       if(++info_counter >= 50) {
         info_counter = 0;
         
-        uint16_t info_y = 650;
-        
-        /* 清除信息显示区域 */
-        lcd_fill(10, info_y - 5, 470, info_y + 40, WHITE);
-        
         /* 显示基本数值 */
-        char info_str[50];
-        sprintf(info_str, "DAC:%d ADC:%lu FreqDiv:%d", dac_value, adc_value, dac_frequency_divider);
-        lcd_show_string(20, info_y, 400, 16, 16, info_str, BLACK);
+        char info_str[64];
+        snprintf(info_str, sizeof info_str, "DAC:%d ADC:%lu %lu.%03luHz %s %s %luS/s", dac_value, adc_live,
+                 dac_wave_get_frequency() / 1000U, dac_wave_get_frequency() % 1000U,
+                 dac_dds_active() ? dds_shape_name(dds_get_shape(0)) :
+                 dac_hwgen_active() ? dac_hwgen_name(dac_hwgen_get_kind()) :
+                 (dac_wave_get_shape() == DAC_SHAPE_ARB) ? "Arb" : "Table",
+                 acq_mode_name(adc_acq_get_mode()), acq_sample_rate);
+        ui_text_set(&ui_info[0], info_str);
         
-        /* 重绘按钮 */
-        draw_virtual_buttons();
+        /* 显示触发状态, 分段采集时显示分段信息 */
+        static const char *const state_names[] = { "Stop", "Pre", "Wait", "Trig'd", "Done" };
+        if(bode_mode) {
+          bode_point_t pt;
+          uint32_t cyc = bode_cycles_per_sample_x100();
+          
+          if(bode_done() > 0 && bode_get_point(bode_done() - 1, &pt)) {
+            uint16_t g = (pt.gain_cdb < 0) ? -pt.gain_cdb : pt.gain_cdb;
+            uint16_t ph = (pt.phase_x10 < 0) ? -pt.phase_x10 : pt.phase_x10;
+            
+            /* 显示宽度56个字符: 频率只显示到Hz, 增益和耗时限制在两位整数, 最长不超过info_str */
+            if(g > 9999) g = 9999;
+            if(ph > 1800) ph = 1800;
+            if(cyc > 9999) cyc = 9999;
+            snprintf(info_str, sizeof info_str, "Bode%s %u/%u %luHz %s%u.%02udB %s%u.%udeg %lu.%02lucyc",
+                     (bode_mode == 2) ? " Cal" : (bode_cal_valid() ? "(cal)" : ""), bode_done(), bode_points(),
+                     (pt.freq_mhz + 500U) / 1000U, (pt.gain_cdb < 0) ? "-" : "", g / 100, g % 100,
+                     (pt.phase_x10 < 0) ? "-" : "", ph / 10, ph % 10, cyc / 100U, cyc % 100U);
+          } else {
+            snprintf(info_str, sizeof info_str, "Bode%s 0/%u", (bode_mode == 2) ? " Cal" : "", bode_points());
+          }
+        } else if(segment_mode) {
+          uint32_t rearm_ns = segment_rearm_cycles_max() * 1000U / (SystemCoreClock / 1000000U);
+          
+          if(segment_running()) {
+            snprintf(info_str, sizeof info_str, "Seg: %u/%u captured", segment_done(), segment_count());
+          } else if(segment_view >= segment_count()) {
+            snprintf(info_str, sizeof info_str, "Seg: overlay %u, rearm %luns", segment_done(), rearm_ns);
+          } else {
+            uint32_t dt_us = (uint32_t)((uint64_t)(segment_timestamp(segment_view) - segment_timestamp(0)) *
+                                        1000000U / acq_sample_rate);
+            snprintf(info_str, sizeof info_str, "Seg: %u/%u t=+%luus rearm %luns", segment_view + 1, segment_done(),
+                     dt_us, rearm_ns);
+          }
+        } else if(adc_acq_get_mode() == ACQ_MODE_SCAN) {
+          uint32_t blk_us = scan_push_cycles_max() / (SystemCoreClock / 1000000U);
+          snprintf(info_str, sizeof info_str, "Scan %uch %luS/s/ch skew %u/32768 blk %luus %s", scan_channels(),
+                   acq_sample_rate, scan_skew_q15(), blk_us, state_names[capture_state()]);
+        } else if(hires_get_decimation() > 1) {
+          uint32_t mean_uv = (uint32_t)((uint64_t)hires_mean * 3300000U / 65520U);
+          snprintf(info_str, sizeof info_str, "HiRes R%u %ubit%s %luS/s mean %lu.%06luV %s", hires_get_decimation(),
+                   hires_bits(), hires_get_fir() ? "+FIR" : "", acq_sample_rate / hires_get_decimation(),
+                   mean_uv / 1000000U, mean_uv % 1000000U, state_names[capture_state()]);
+        } else if(ets_mode && adc_trigger_ets_active()) {
+          snprintf(info_str, sizeof info_str, "ETS x%u %lurec %u/%ubins %luS/s drop%lu", ets_get_factor(),
+                   ets_record_count(), ets_filled, ets_get_bins(), acq_sample_rate * ets_get_factor(),
+                   adc_trigger_ets_dropped());
+        } else {
+          snprintf(info_str, sizeof info_str, "T:%s %s %s L:%u H:%u HO:%luus %s",
+                   trigger_sweep_name(trigger_get_sweep()), trigger_edge_name(trigger_get_edge()),
+                   adc_trigger_awd_active() ? "AWD" : "SW", trigger_get_level(), trigger_get_hysteresis(),
+                   trigger_holdoff_us, state_names[capture_state()]);
+          if(adc_trigger_awd_active()) {
+            char lat_str[24];
+            snprintf(lat_str, sizeof lat_str, " Lat:%u/%lu", adc_trigger_awd_latency(), adc_trigger_awd_violations());
+            strncat(info_str, lat_str, sizeof(info_str) - strlen(info_str) - 1);
+          }
+        }
+        ui_text_set(&ui_info[1], info_str);
+        
+        /* 只重画有变化的字符 */
+        ui_flush();
       }
       
       /* 串口输出数据 */
-      printf("DAC:%d ADC:%lu\r\n", dac_value, adc_value);
+      printf("DAC:%d ADC:%lu\r\n", dac_value, adc_live);
+      
+      /* 扫频同步标记: 输出点序号换算为时间戳, 与PC7脉冲一起供采集端对照 */
+      static uint32_t sweep_marks_reported = 0;
+      if(dds_sweep_get_kind() != DDS_SWEEP_OFF && dds_sweep_marker_count() != sweep_marks_reported) {
+        uint64_t t_us = (uint64_t)dds_sweep_marker_sample() * 1000000U / dds_get_rate();
+        sweep_marks_reported = dds_sweep_marker_count();
+        printf("Sweep mark %lu: t=%luus f=%lu.%03luHz\r\n", sweep_marks_reported, (uint32_t)t_us,
+               dds_sweep_marker_freq() / 1000U, dds_sweep_marker_freq() % 1000U);
+      }
     }
     
     /* 检查KEY0 - 切换参数 */
@@ -334,6 +618,246 @@ void SystemClock_Config(void)
 
 /* USER CODE BEGIN 4 */
 
+/**
+ * @brief       按当前扫描长度和预触发深度重新布防触发采集
+ *   @note      先停止采集再修改参数, DMA中断在此期间写入的数据会被忽略
+ */
+void capture_restart(void)
+{
+  capture_disarm();
+  average_hooked = 0;
+  
+  if(bode_mode) {
+    /* 波特图测量: 数据块全部交给相关运算, 不使用触发采集 */
+    hires_configure(1, 0);
+    acq_set_block_hook(bode_push);
+    return;
+  }
+  
+  /* 高分辨率模式按扫描时间选择抽取比, 抽取比不变时滤波器状态保持连续 */
+  if(hires_mode && adc_acq_get_mode() == ACQ_MODE_SINGLE && !segment_mode && !ets_mode) {
+    hires_configure(hires_select_decimation(waveform_sweep_ms()), hires_mode == 2);
+  } else {
+    hires_configure(1, 0);
+  }
+  
+  /* 高分辨率模式在抽取后的采样上检测触发 */
+  trigger_set_holdoff(TRIGGER_US_TO_SAMPLES(trigger_holdoff_us, acq_sample_rate / hires_get_decimation()));
+  
+  if(adc_acq_get_mode() == ACQ_MODE_SCAN) {
+    /* 多通道扫描: 通道0触发, 各通道记录在拆分后的环形缓冲中 */
+    acq_set_block_hook(scan_push);
+    capture_configure((waveform_sweep_length() < SCAN_MAX_RECORD) ? waveform_sweep_length() : SCAN_MAX_RECORD,
+                      capture_pretrigger_pct, 1);
+  } else if(segment_mode) {
+    /* 分段采集: 记录长度取扫描长度和每段容量中较小者 */
+    segment_configure(SEGMENT_DEFAULT_COUNT, waveform_sweep_length());
+    acq_set_block_hook(segment_push);
+    capture_configure(segment_length(), capture_pretrigger_pct, 1);
+    segment_overlay_drawn = 0;
+    segment_reported = 0;
+  } else if(ets_mode && adc_acq_get_mode() == ACQ_MODE_SINGLE) {
+    /* 等效时间采样: 网格点数为扫描长度, 每条记录只需覆盖网格的1/ets_mode */
+    ets_configure(ets_mode, waveform_sweep_length(), capture_pretrigger_pct);
+    acq_set_block_hook(ets_push);
+    capture_configure(ets_record_length(), capture_pretrigger_pct, 1);
+  } else if(hires_get_decimation() > 1) {
+    average_hooked = (average_get_mode() != AVERAGE_OFF);
+    acq_set_block_hook(average_hooked ? hires_average_push : hires_push);
+    capture_configure(waveform_sweep_length(), capture_pretrigger_pct, 1);
+  } else if(peak_get_factor() > 1) {
+    peak_reset();
+    acq_set_block_hook(peak_push);
+    capture_configure(waveform_sweep_length() * 2, capture_pretrigger_pct, 2);
+  } else {
+    average_hooked = (average_get_mode() != AVERAGE_OFF);
+    acq_set_block_hook(average_hooked ? average_push : capture_push);
+    capture_configure(waveform_sweep_length(), capture_pretrigger_pct, 1);
+  }
+  adc_trigger_set_ets(ets_mode && adc_acq_get_mode() == ACQ_MODE_SINGLE);
+  adc_trigger_rearm();
+  capture_arm();
+  if(segment_mode) {
+    segment_start();
+  }
+}
+
+/**
+ * @brief       按dac_wave_sel, 频率, 幅度和占空比设置DAC波形发生器
+ *   @note      DDS波形之间切换和改变参数时输出连续; 切换到波形表, 从波形表切回DDS或
+ *              打开/关闭通道2时重新启动DMA.
+ *              dac_hw_kind不为关闭且不叠加时由DAC内置发生器单独输出, 幅度取不小于dac_amplitude的2^n-1.
+ */
+void generator_update(void)
+{
+  if(bode_mode) return;     /* 波特图测量占用发生器, 退出时按新参数恢复 */
+  
+  if(dac_hw_kind != DAC_HWGEN_OFF && !dac_hw_overlay) {
+    uint8_t bits = 1;
+    while(bits < 12 && (1U << bits) - 1 < dac_amplitude) bits++;
+    dac_hwgen_start((dac_hwgen_t)dac_hw_kind, dac_frequency_mhz, bits, dac_offset);
+    return;
+  }
+  
+  if(dac_wave_sel < DDS_SHAPE_COUNT) {
+    dds_set_shape(0, (dds_shape_t)dac_wave_sel);
+    dds_set_duty(0, dac_duty);
+    dds_set_level(0, dac_amplitude, dac_offset);
+    dds_set_shape(1, (dds_shape_t)dac_ch2_shape);
+    dds_set_duty(1, dac_duty);
+    dds_set_level(1, dac_amplitude, dac_offset);
+    dds_set_phase_offset(dac_ch2_phase);
+    dds_set_ratio(dac_ch2_ratio);
+    if(!dac_dds_active() || dac_dds_synced() || dac_dds_dual() != dac_ch2_on) {
+      dac_dds_start(dac_ch2_on);
+    }
+    dac_wave_set_frequency(dac_frequency_mhz);
+  } else if(dac_wave_sel > DDS_SHAPE_COUNT) {
+    if(dac_dds_active() || dac_hwgen_active() || dac_wave_get_shape() != DAC_SHAPE_ARB) {
+      dac_wave_start(DAC_SHAPE_ARB, dac_frequency_mhz, dac_amplitude, dac_offset);
+    } else {
+      dac_wave_set_frequency(dac_frequency_mhz);
+    }
+  } else if(dac_dds_active() || dac_hwgen_active() || dac_wave_get_shape() == DAC_SHAPE_ARB) {
+    dac_wave_start(DAC_SHAPE_SINE, dac_frequency_mhz, dac_amplitude, dac_offset);
+  } else {
+    dac_wave_set_frequency(dac_frequency_mhz);
+    dac_wave_set_shape(DAC_SHAPE_SINE, dac_amplitude, dac_offset);
+  }
+  dac_hwgen_overlay((dac_hwgen_t)dac_hw_kind, dac_hw_bits);
+}
+
+/**
+ * @brief       进入, 切换或退出波特图测量
+ *   @note      进入时停止扫频和分段采集, ADC3与DAC改为共用TIM8触发并同时启动, DAC以DDS输出正弦波,
+ *              ADC第k个采样与DAC第k-1个输出点同时, 参考相位由DDS逐点算出.
+ *              退出时恢复原来的采集模式和TIM7触发的波形发生器.
+ * @param       mode: 0关闭, 1连续扫描, 2重新扫描一次并保存为直通校准
+ */
+void bode_mode_set(uint8_t mode)
+{
+  if(mode && !bode_mode) {
+    bode_saved_mode = adc_acq_get_mode();
+    bode_saved_rate = acq_sample_rate;
+    if(segment_mode) {
+      segment_stop();
+      segment_mode = 0;
+    }
+    dds_sweep_stop();
+    bode_mode = mode;
+    
+    /* 先准备好ADC和DAC两边的DMA, 最后启动TIM8 */
+    acq_sample_rate = adc_acq_start_held(BODE_SAMPLE_RATE);
+    bode_stop();
+    capture_restart();
+    dds_set_shape(0, DDS_SINE);
+    dds_set_level(0, dac_amplitude, dac_offset);
+    dac_dds_start_synced(acq_sample_rate);
+    bode_configure(BODE_DEFAULT_START_MHZ, BODE_DEFAULT_STOP_MHZ, BODE_DEFAULT_POINTS);
+    bode_start(dac_amplitude);
+    adc_acq_release();
+    draw_bode_frame(bode_start_freq(), bode_stop_freq());
+  } else if(!mode && bode_mode) {
+    bode_mode = 0;
+    bode_stop();
+    acq_sample_rate = adc_acq_start(bode_saved_mode, bode_saved_rate);
+    generator_update();
+    capture_restart();
+    init_waveform_display();
+  } else if(mode) {
+    bode_mode = mode;
+    if(mode == 2) {
+      draw_bode_frame(bode_start_freq(), bode_stop_freq());
+      dds_set_level(0, dac_amplitude, dac_offset);
+      bode_start(dac_amplitude);
+    }
+  }
+}
+
+/* 取显示记录中第idx列的值, 峰值检测记录取该列的(min, max) */
+static void display_record_column(uint16_t idx, uint16_t *adc_min, uint16_t *adc_max)
+{
+  if(display_record_len == 0) return;
+  
+  if(display_record_peak) {
+    uint16_t pairs = display_record_len / 2;
+    uint16_t col = (idx < pairs) ? idx : (pairs - 1);
+    *adc_min = display_record[col * 2];
+    *adc_max = display_record[col * 2 + 1];
+  } else {
+    *adc_min = *adc_max = display_record[(idx < display_record_len) ? idx : (display_record_len - 1)];
+  }
+}
+
+/* 高分辨率记录为16位, 保留平均值用于读数, 显示时恢复为12位 */
+static void display_hires_record(void)
+{
+  uint32_t sum = 0;
+  
+  if(display_record_len == 0) return;
+  for(uint16_t i = 0; i < display_record_len; i++) {
+    sum += display_record[i];
+    display_record[i] >>= 4;
+  }
+  hires_mean = sum / display_record_len;
+}
+
+/* 高分辨率模式下平均的数据块处理函数: 原地抽取后交给average_push() */
+static void hires_average_push(const uint16_t *samples, uint16_t n)
+{
+  uint16_t m = hires_process((uint16_t *)samples, n);
+  
+  if(m > 0) {
+    average_push(samples, m);
+  }
+}
+
+/* 显示记录中相邻两列的时间间隔的倒数(列/秒), 用于画发生器参考迹线 */
+static uint32_t display_column_rate(void)
+{
+  if(ets_mode && adc_trigger_ets_active()) return acq_sample_rate * ets_get_factor();
+  if(hires_get_decimation() > 1) return acq_sample_rate / hires_get_decimation();
+  if(peak_get_factor() > 1 && adc_acq_get_mode() != ACQ_MODE_SCAN) return acq_sample_rate / peak_get_factor();
+  return acq_sample_rate;
+}
+
+/* DWT周期计数值 */
+static uint32_t dwt_cycles(void)
+{
+  return DWT->CYCCNT;
+}
+
+/* 上传开始: 发生器的暂存表作为非活动表 */
+static uint16_t *upload_take_bank(uint16_t points)
+{
+  return dac_arb_begin(points);
+}
+
+/**
+ * @brief       上传结束
+ *   @note      提交后切换到任意波形, 已在输出任意波形时在周期边界换入新表.
+ *              波特图测量期间只保存, 退出后生效.
+ * @param       points: 点数, 0为放弃
+ */
+static uint8_t upload_commit(uint16_t points)
+{
+  if(!dac_arb_end(points)) return 0;
+  if(points > 0) {
+    dac_wave_sel = DDS_SHAPE_COUNT + 1;
+    dac_ch2_on = 0;
+    if(!dac_hw_overlay) dac_hw_kind = DAC_HWGEN_OFF;
+    dds_sweep_stop();
+    generator_update();
+  }
+  return 1;
+}
+
+/* 上传的每帧回复一行, 上位机据此继续或重发 */
+static void upload_reply(uint8_t cmd, upload_status_t status, uint16_t value)
+{
+  printf("UPL %c %s %u\r\n", cmd, upload_status_name(status), value);
+}
+
 /* USER CODE END 4 */
 
 /**
@@ -1,15 +1,39 @@
 #include "oscilloscope.h"
 #include "lcd.h"
+#include "scan.h"
+#include "ui.h"
 #include "delay.h"
 #include <stdio.h>
 #include <string.h>
+#include <math.h>
 
 /* 静态变量 - 波形显示状态 */
 static uint16_t current_x = WAVE_START_X;
 static uint16_t prev_dac_y = 0;
 static uint16_t prev_adc_y = 0;
+static uint16_t prev_adc_y_top = 0;
+static uint16_t prev_scan_y[SCAN_MAX_CHANNELS];
 static uint8_t wave_initialized = 0;
 
+/* 列合成: 最近三步每条迹线在一列中的范围, [0]为本步; 第0条为DAC, 之后为ADC通道 */
+#define WAVE_TRACES (1 + SCAN_MAX_CHANNELS)
+typedef struct {
+  uint16_t lo, hi;
+  uint16_t color;
+} wave_span_t;
+static wave_span_t wave_span[3][WAVE_TRACES];
+static uint8_t wave_span_n[3];
+
+/* 每列屏上迹线所占的行范围, 分上下两段(DAC, ADC)记录, 行号相对段首; lo > hi 为没有迹线.
+ * 刷新一列时只改写旧范围和新范围覆盖的行, 旧迹线按网格的颜色擦除. 行号row对应y = WAVE_START_Y + 1 + row */
+#define WAVE_BANDS 2
+#define WAVE_BAND_SPLIT (WAVE_HEIGHT / 2 + 1)   /* 下段的第一行 */
+typedef struct {
+  uint8_t lo, hi;
+} wave_range_t;
+static wave_range_t wave_hist[WAVE_WIDTH][WAVE_BANDS];
+static uint16_t wave_col_buf[WAVE_BAND_SPLIT];  /* 一段的像素 */
+
 /* 周期检测和时基控制 */
 static uint16_t timebase_divider = 1;
 static uint16_t sample_counter = 0;
@@ -20,24 +44,64 @@ static uint16_t period_samples = 0;
 static float estimated_frequency = 0.0f;
 static float estimated_period_ms = 0.0f;
 
+/* 滚动显示: 每列保存上一帧的Y坐标, 每次左移一列时只改写变化的像素 */
+static roll_mode_t roll_mode = ROLL_AUTO;
+static uint32_t roll_threshold_ms = ROLL_DEFAULT_THRESHOLD_MS;
+static uint8_t roll_running = 0;
+static uint32_t roll_judged_ms = 0;          /* 上次判断时的扫描时间, 时基不变时不重新判断 */
+static roll_mode_t roll_judged_mode = ROLL_MODE_COUNT;
+static uint8_t roll_judged_auto = 0;
+static uint8_t roll_primed = 0;
+static uint16_t roll_dac_y[WAVE_WIDTH];
+static uint16_t roll_adc_y[WAVE_WIDTH];
+
+static const char *const roll_mode_names[ROLL_MODE_COUNT] = { "Auto", "On", "Off" };
+
+/* 波特图: 对数频率坐标和上一个频点的位置 */
+static float bode_log_start = 0.0f;
+static float bode_log_span = 1.0f;
+static uint16_t bode_prev_x, bode_prev_gy, bode_prev_py;
+static int16_t bode_prev_phase;
+
+/* 多通道扫描采集各通道的迹线颜色 */
+const uint16_t scan_trace_colors[SCAN_MAX_CHANNELS] = { RED, MAGENTA, DARKBLUE, BROWN };
+
 /* DAC波形控制参数 - 外部变量声明 */
 extern uint16_t dac_amplitude;
 extern uint16_t dac_offset;
-extern uint16_t dac_frequency_divider;
-extern uint16_t dac_min_value;
-extern uint16_t dac_max_value;
 
 /* 虚拟按钮相关 */
 extern virtual_button_t virtual_buttons[];
 extern uint8_t selected_button;
 
+/* 显示区域整个重画后(网格之上还有标签等内容), 每列第一次刷新时改写整段 */
+static void waveform_hist_reset(void)
+{
+  uint16_t i;
+  
+  for(i = 0; i < WAVE_WIDTH; i++) {
+    wave_hist[i][0].lo = 0;
+    wave_hist[i][0].hi = WAVE_BAND_SPLIT - 1;
+    wave_hist[i][1].lo = 0;
+    wave_hist[i][1].hi = WAVE_HEIGHT - 2 - WAVE_BAND_SPLIT;
+  }
+}
+
+/* 清除显示区域和下方的标注行. 屏上的内容被改写, 界面元素在下一次ui_flush()时整个重画 */
+static void waveform_clear_area(void)
+{
+  lcd_fill(WAVE_START_X, WAVE_START_Y, WAVE_START_X + WAVE_WIDTH, WAVE_START_Y + WAVE_HEIGHT, WHITE);
+  lcd_fill(0, WAVE_START_Y + WAVE_HEIGHT + 1, 479, WAVE_START_Y + WAVE_HEIGHT + 26, WHITE);
+  ui_invalidate();
+}
+
 /* 初始化波形显示区域 */
 void init_waveform_display(void)
 {
   uint16_t i, x_pos;
   
-  /* 清除波形显示区域 */
-  lcd_fill(WAVE_START_X, WAVE_START_Y, WAVE_START_X + WAVE_WIDTH, WAVE_START_Y + WAVE_HEIGHT, WHITE);
+  /* 清除波形显示区域和下方的标注行(波特图的频率标注位置不同) */
+  waveform_clear_area();
   
   /* 绘制网格线 */
   for(i = 0; i <= 8; i++) {
@@ -80,7 +144,9 @@ void init_waveform_display(void)
     lcd_show_string(x_pos - 15, WAVE_START_Y + WAVE_HEIGHT + 5, 30, 12, 12, time_str, BLACK);
   }
   
+  waveform_hist_reset();
   wave_initialized = 1;
+  roll_primed = 0;      /* 显示区域已清空, 滚动历史需要重新填充 */
 }
 
 /* 周期检测和时基自动调整 */
@@ -123,61 +189,553 @@ void detect_period_and_adjust_timebase(uint16_t dac_value)
   sample_counter++;
 }
 
+/* 一次扫描所需时间(ms) */
+uint32_t waveform_sweep_ms(void)
+{
+  return (uint32_t)waveform_sweep_length() * 10000U / WAVE_TICK_HZ_X10;
+}
+
+/* 当前扫描位置对应的采样序号 */
+uint16_t waveform_sweep_index(void)
+{
+  return (current_x - WAVE_START_X) / timebase_divider;
+}
+
+/* 一次完整扫描包含的采样点数 */
+uint16_t waveform_sweep_length(void)
+{
+  return (WAVE_WIDTH - 1) / timebase_divider;
+}
+
+/* 扫描位置前进一步, 回到左端时返回1 */
+static uint8_t waveform_advance(void)
+{
+  current_x += timebase_divider;
+  
+  if(current_x >= WAVE_START_X + WAVE_WIDTH - timebase_divider) {
+    current_x = WAVE_START_X;
+    rising_edge_detected = 0;
+    period_samples = 0;
+    sample_counter = 0;
+    return 1;
+  }
+  return 0;
+}
+
 /* 绘制单个波形点 */
 void draw_waveform_point(uint16_t dac_value, uint16_t adc_value)
 {
-  uint16_t dac_y, adc_y;
+  draw_waveform_span(dac_value, adc_value, adc_value);
+}
+
+/* 一步的迹线在一列中占的竖直范围: 上一点到本点之间, 上下各加宽1像素 */
+static void waveform_trace_span(wave_span_t *span, uint16_t from_y, uint16_t to_y, uint16_t color)
+{
+  uint16_t lo = to_y, hi = to_y;
+  
+  if(wave_initialized && current_x > WAVE_START_X) {
+    if(from_y < lo) lo = from_y;
+    if(from_y > hi) hi = from_y;
+  }
+  span->lo = lo - 1;
+  span->hi = hi + 1;
+  span->color = color;
+}
+
+/* 网格在第x列第row行的颜色, 与init_waveform_display()画出的网格线和中心线一致 */
+static uint16_t waveform_grid_color(uint16_t x, uint16_t row)
+{
+  uint16_t y = row + 1;
+  
+  if(y == WAVE_HEIGHT / 2) return BLACK;
+  if(y % (WAVE_HEIGHT / 5) == 0) return LGRAY;
+  return ((x - WAVE_START_X) % (WAVE_WIDTH / 8) == 0) ? LGRAY : WHITE;
+}
+
+/**
+ * @brief       刷新一列: 每段只改写旧迹线和新迹线覆盖的行
+ *   @note      这些行先取网格的颜色(擦除旧迹线), 再按迹线顺序画上新迹线, 开一次窗口写入.
+ *              两段都没有迹线时不访问LCD.
+ * @param       x    : 列坐标
+ * @param       depth: 叠加最近几步的迹线
+ */
+static void waveform_compose_column(uint16_t x, uint8_t depth)
+{
+  wave_range_t *hist = wave_hist[x - WAVE_START_X];
+  uint8_t b, s;
+  uint16_t t;
+  int16_t row;
+  
+  for(b = 0; b < WAVE_BANDS; b++) {
+    int16_t first = b ? WAVE_BAND_SPLIT : 0;
+    int16_t last = b ? WAVE_HEIGHT - 2 : WAVE_BAND_SPLIT - 1;
+    int16_t lo = last + 1, hi = first - 1;      /* 新迹线的范围 */
+    int16_t wlo, whi;                           /* 要改写的范围 */
+    
+    for(s = 0; s < depth; s++) {
+      for(t = 0; t < wave_span_n[s]; t++) {
+        int16_t slo = (int16_t)wave_span[s][t].lo - WAVE_START_Y - 1;
+        int16_t shi = (int16_t)wave_span[s][t].hi - WAVE_START_Y - 1;
+        
+        if(slo < first) slo = first;
+        if(shi > last) shi = last;
+        if(slo > shi) continue;
+        if(slo < lo) lo = slo;
+        if(shi > hi) hi = shi;
+      }
+    }
+    
+    wlo = lo;
+    whi = hi;
+    if(hist[b].lo <= hist[b].hi) {
+      if(first + hist[b].lo < wlo) wlo = first + hist[b].lo;
+      if(first + hist[b].hi > whi) whi = first + hist[b].hi;
+    }
+    if(wlo > whi) continue;
+    
+    for(row = wlo; row <= whi; row++) {
+      wave_col_buf[row - wlo] = waveform_grid_color(x, row);
+    }
+    
+    /* 按迹线顺序画: DAC在下, ADC通道依次在上 */
+    for(t = 0; t < WAVE_TRACES; t++) {
+      for(s = 0; s < depth; s++) {
+        int16_t slo, shi;
+        
+        if(t >= wave_span_n[s]) continue;
+        slo = (int16_t)wave_span[s][t].lo - WAVE_START_Y - 1;
+        shi = (int16_t)wave_span[s][t].hi - WAVE_START_Y - 1;
+        if(slo < wlo) slo = wlo;
+        if(shi > whi) shi = whi;
+        for(row = slo; row <= shi; row++) {
+          wave_col_buf[row - wlo] = wave_span[s][t].color;
+        }
+      }
+    }
+    
+    lcd_color_burst(x, WAVE_START_Y + 1 + wlo, 1, whi - wlo + 1, wave_col_buf);
+    
+    if(lo <= hi) {
+      hist[b].lo = lo - first;
+      hist[b].hi = hi - first;
+    } else {
+      hist[b].lo = 0xFF;
+      hist[b].hi = 0;
+    }
+  }
+}
+
+/**
+ * @brief       一步的迹线范围已放入wave_span[0], 刷新当前列附近的几列并前进
+ *   @note      current_x-1 到 current_x+1 三列各合成一次: 左边一列叠加三步, 当前列叠加两步,
+ *              右边一列只有本步. 迹线因此有3像素宽. 上一轮扫描的迹线在同一列刷新时按记录的范围擦除,
+ *              不再提前清空右边的整列, 新旧波形之间没有空白的间隙.
+ */
+static void waveform_render_step(void)
+{
+  int16_t k;
+  
+  /* 扫描回到左端时不与上一轮的最后几步相连 */
+  if(!(wave_initialized && current_x > WAVE_START_X)) {
+    wave_span_n[1] = 0;
+    wave_span_n[2] = 0;
+  }
+  
+  for(k = -1; k <= 1; k++) {
+    int16_t x = current_x + k;
+    
+    /* 不覆盖左右边框 */
+    if(x <= WAVE_START_X || x >= WAVE_START_X + WAVE_WIDTH) continue;
+    waveform_compose_column(x, 2 - k);
+  }
+  
+  memcpy(wave_span[2], wave_span[1], sizeof(wave_span[0]));
+  memcpy(wave_span[1], wave_span[0], sizeof(wave_span[0]));
+  wave_span_n[2] = wave_span_n[1];
+  wave_span_n[1] = wave_span_n[0];
+}
+
+/* 一列画完, 扫描位置前进 */
+static void waveform_column_done(void)
+{
+  waveform_render_step();
+  
+  if(waveform_advance()) {
+    lcd_draw_line(current_x, WAVE_START_Y, current_x, WAVE_START_Y + WAVE_HEIGHT, YELLOW);
+  }
+}
+
+/**
+ * @brief       绘制一列波形, ADC通道画出min~max之间的竖线(峰值检测)
+ *   @note      adc_min == adc_max 时与单点绘制相同; 连接线画到两列范围中靠近上一列的一端
+ */
+void draw_waveform_span(uint16_t dac_value, uint16_t adc_min, uint16_t adc_max)
+{
+  uint16_t dac_y, adc_y, adc_y_top;
+  uint16_t from_y, to_y;
+  wave_span_t *adc_span = &wave_span[0][1];
   
   /* 计算Y坐标 */
   dac_y = WAVE_START_Y + (WAVE_HEIGHT/2) - (dac_value * (WAVE_HEIGHT/2) / 4096);
-  adc_y = WAVE_START_Y + (WAVE_HEIGHT/2) + 10 + (4096 - adc_value) * (WAVE_HEIGHT/2 - 20) / 4096;
+  adc_y = WAVE_START_Y + (WAVE_HEIGHT/2) + 10 + (4096 - adc_min) * (WAVE_HEIGHT/2 - 20) / 4096;
+  adc_y_top = WAVE_START_Y + (WAVE_HEIGHT/2) + 10 + (4096 - adc_max) * (WAVE_HEIGHT/2 - 20) / 4096;
   
-  /* 清除当前X位置的垂直线 */
-  lcd_draw_line(current_x, WAVE_START_Y + 1, current_x, WAVE_START_Y + WAVE_HEIGHT - 1, WHITE);
-  lcd_draw_line(current_x + 1, WAVE_START_Y + 1, current_x + 1, WAVE_START_Y + WAVE_HEIGHT - 1, WHITE);
-  lcd_draw_line(current_x + 2, WAVE_START_Y + 1, current_x + 2, WAVE_START_Y + WAVE_HEIGHT - 1, WHITE);
+  /* DAC连接线 */
+  waveform_trace_span(&wave_span[0][0], prev_dac_y, dac_y, BLUE);
   
-  /* 重绘网格线 */
-  if((current_x - WAVE_START_X) % (WAVE_WIDTH / 8) == 0) {
-    lcd_draw_line(current_x, WAVE_START_Y, current_x, WAVE_START_Y + WAVE_HEIGHT, LGRAY);
+  /* ADC连接线: 两列的范围不重叠时连接相邻的两端 */
+  from_y = prev_adc_y;
+  to_y = adc_y;
+  if(prev_adc_y < adc_y_top) {
+    to_y = adc_y_top;
+  } else if(prev_adc_y_top > adc_y) {
+    from_y = prev_adc_y_top;
   }
-  uint16_t center_y = WAVE_START_Y + WAVE_HEIGHT / 2;
-  lcd_draw_point(current_x, center_y, GRAY);
+  waveform_trace_span(adc_span, from_y, to_y, RED);
   
-  /* 绘制连接线 */
-  if(wave_initialized && current_x > WAVE_START_X) {
-    /* DAC连接线 */
-    for(int thick = -1; thick <= 1; thick++) {
-      lcd_draw_line(current_x - 1, prev_dac_y + thick, current_x, dac_y + thick, BLUE);
-      lcd_draw_line(current_x - 1 + thick, prev_dac_y, current_x + thick, dac_y, BLUE);
-    }
+  /* 峰值检测: min~max竖线 */
+  if(adc_y_top - 1 < adc_span->lo) adc_span->lo = adc_y_top - 1;
+  if(adc_y + 1 > adc_span->hi) adc_span->hi = adc_y + 1;
+  wave_span_n[0] = 2;
+  
+  prev_dac_y = dac_y;
+  prev_adc_y = adc_y;
+  prev_adc_y_top = adc_y_top;
+  
+  waveform_column_done();
+}
+
+/**
+ * @brief       多通道扫描采集: 绘制一列波形, 每个通道一条迹线
+ *   @note      ADC显示区按通道数等分, 通道k画在第k条带内(纵向偏移k个带高), 颜色取scan_trace_colors[k]
+ * @param       dac_value : DAC输出值
+ * @param       adc_values: 各通道本列的采样值
+ * @param       channels  : 通道数
+ */
+void draw_waveform_scan(uint16_t dac_value, const uint16_t *adc_values, uint8_t channels)
+{
+  uint16_t dac_y = WAVE_START_Y + (WAVE_HEIGHT/2) - (dac_value * (WAVE_HEIGHT/2) / 4096);
+  uint16_t lane_h, ch;
+  
+  if(channels < 1) channels = 1;
+  if(channels > SCAN_MAX_CHANNELS) channels = SCAN_MAX_CHANNELS;
+  lane_h = (WAVE_HEIGHT/2 - 20) / channels;
+  
+  waveform_trace_span(&wave_span[0][0], prev_dac_y, dac_y, BLUE);
+  prev_dac_y = dac_y;
+  
+  for(ch = 0; ch < channels; ch++) {
+    uint16_t top = WAVE_START_Y + (WAVE_HEIGHT/2) + 10 + ch * lane_h;
+    uint16_t y = top + (4096 - adc_values[ch]) * lane_h / 4096;
     
-    /* ADC连接线 */
-    for(int thick = -1; thick <= 1; thick++) {
-      lcd_draw_line(current_x - 1, prev_adc_y + thick, current_x, adc_y + thick, RED);
-      lcd_draw_line(current_x - 1 + thick, prev_adc_y, current_x + thick, adc_y, RED);
-    }
+    waveform_trace_span(&wave_span[0][1 + ch], prev_scan_y[ch], y, scan_trace_colors[ch]);
+    prev_scan_y[ch] = y;
   }
+  wave_span_n[0] = 1 + channels;
+  
+  waveform_column_done();
+}
+
+/**
+ * @brief       叠加显示多条连续存放的ADC记录(分段采集浏览)
+ *   @note      重画整个显示区域后逐条画出折线, 颜色循环使用; 扫描位置回到左端
+ * @param       data : 第一条记录, 其余记录紧接其后
+ * @param       len  : 每条记录的采样数
+ * @param       count: 记录条数
+ */
+void draw_waveform_overlay(const uint16_t *data, uint16_t len, uint16_t count)
+{
+  static const uint16_t colors[] = { RED, BLUE, MAGENTA, BROWN, DARKBLUE, BRRED, GRAY, GREEN };
+  uint16_t seg, i, x, y, prev_y = 0;
+  
+  init_waveform_display();
+  current_x = WAVE_START_X;
   
-  /* 绘制当前点 */
-  for(int dx = -1; dx <= 1; dx++) {
-    for(int dy = -1; dy <= 1; dy++) {
-      lcd_draw_point(current_x + dx, dac_y + dy, BLUE);
-      lcd_draw_point(current_x + dx, adc_y + dy, RED);
+  for(seg = 0; seg < count; seg++) {
+    const uint16_t *rec = data + (uint32_t)seg * len;
+    uint16_t color = colors[seg % (sizeof(colors) / sizeof(colors[0]))];
+    
+    for(i = 0; i < len; i++) {
+      x = WAVE_START_X + i * timebase_divider;
+      if(x >= WAVE_START_X + WAVE_WIDTH) break;
+      y = WAVE_START_Y + (WAVE_HEIGHT/2) + 10 + (4096 - rec[i]) * (WAVE_HEIGHT/2 - 20) / 4096;
+      if(i > 0) {
+        lcd_draw_line(x - timebase_divider, prev_y, x, y, color);
+      }
+      prev_y = y;
     }
   }
+}
+
+void roll_set_mode(roll_mode_t mode)
+{
+  if(mode >= ROLL_MODE_COUNT) mode = ROLL_AUTO;
+  roll_mode = mode;
+}
+
+roll_mode_t roll_get_mode(void)
+{
+  return roll_mode;
+}
+
+const char *roll_mode_name(roll_mode_t mode)
+{
+  return (mode < ROLL_MODE_COUNT) ? roll_mode_names[mode] : "?";
+}
+
+/* 设置自动滚动的门限(ms), 不小于ROLL_MIN_THRESHOLD_MS; 下一个节拍按新门限重新判断 */
+void roll_set_threshold_ms(uint32_t ms)
+{
+  if(ms < ROLL_MIN_THRESHOLD_MS) ms = ROLL_MIN_THRESHOLD_MS;
+  roll_threshold_ms = ms;
+  roll_judged_mode = ROLL_MODE_COUNT;
+}
+
+uint32_t roll_get_threshold_ms(void)
+{
+  return roll_threshold_ms;
+}
+
+/**
+ * @brief       判断是否使用滚动显示, 在扫描/滚动之间切换时重画显示区域
+ *   @note      每个节拍调用一次, 只在时基, 滚动方式, 门限或auto_allowed改变时重新判断.
+ *              自动方式带迟滞: 扫描时间不短于roll_threshold_ms时进入滚动,
+ *              短于其ROLL_EXIT_PCT%时才退出, 时基在门限附近来回调整时显示不会反复切换.
+ * @param       auto_allowed: 0时自动方式不滚动. 高分辨率模式打开时传0, 慢速时基由高分辨率
+ *                            的触发记录显示(R=256正是用在这些时基上), 强制滚动(ROLL_ON)不受影响
+ * @retval      1: 滚动显示, 0: 扫描显示
+ */
+uint8_t waveform_roll_update(uint8_t auto_allowed)
+{
+  uint32_t sweep_ms = waveform_sweep_ms();
+  uint8_t want = roll_running;
   
-  prev_dac_y = dac_y;
-  prev_adc_y = adc_y;
+  auto_allowed = auto_allowed ? 1 : 0;
+  if(sweep_ms == roll_judged_ms && roll_mode == roll_judged_mode && auto_allowed == roll_judged_auto) {
+    return roll_running;
+  }
+  roll_judged_ms = sweep_ms;
+  roll_judged_mode = roll_mode;
+  roll_judged_auto = auto_allowed;
   
-  current_x += timebase_divider;
+  if(roll_mode == ROLL_AUTO && !auto_allowed) {
+    want = 0;
+  } else if(roll_mode == ROLL_AUTO) {
+    if(sweep_ms >= roll_threshold_ms) {
+      want = 1;
+    } else if(sweep_ms < roll_threshold_ms / 100U * ROLL_EXIT_PCT) {
+      want = 0;
+    }
+  } else {
+    want = (roll_mode == ROLL_ON);
+  }
   
-  if(current_x >= WAVE_START_X + WAVE_WIDTH - timebase_divider) {
+  if(want != roll_running) {
+    roll_running = want;
     current_x = WAVE_START_X;
-    rising_edge_detected = 0;
-    period_samples = 0;
-    sample_counter = 0;
+    init_waveform_display();
+  }
+  return roll_running;
+}
+
+/* 擦除一列中[y0, y1]范围的像素, 恢复经过的网格线, 中心线和边框 */
+static void roll_erase(uint16_t x, uint16_t y0, uint16_t y1)
+{
+  uint16_t grid = WAVE_HEIGHT / 5;
+  uint16_t center_y = WAVE_START_Y + WAVE_HEIGHT / 2;
+  uint16_t y;
+  
+  lcd_draw_line(x, y0, x, y1, ((x - WAVE_START_X) % (WAVE_WIDTH / 8) == 0) ? LGRAY : WHITE);
+  
+  for(y = WAVE_START_Y + (y0 - WAVE_START_Y + grid - 1) / grid * grid; y <= y1; y += grid) {
+    lcd_draw_point(x, y, (y == WAVE_START_Y || y == WAVE_START_Y + WAVE_HEIGHT) ? BLACK : LGRAY);
+  }
+  if(y0 <= center_y && center_y <= y1) {
+    lcd_draw_point(x, center_y, BLACK);
+  }
+}
+
+/**
+ * @brief       把一列的竖线从[old_lo, old_hi]改为[new_lo, new_hi]
+ *   @note      只擦除旧范围中不再覆盖的部分, 只画新范围中原来没有的部分
+ */
+static void roll_update_column(uint16_t x, uint16_t old_lo, uint16_t old_hi,
+                               uint16_t new_lo, uint16_t new_hi, uint16_t color)
+{
+  if(new_hi < old_lo || new_lo > old_hi) {
+    roll_erase(x, old_lo, old_hi);
+    lcd_draw_line(x, new_lo, x, new_hi, color);
+    return;
+  }
+  
+  if(old_lo < new_lo) roll_erase(x, old_lo, new_lo - 1);
+  if(old_hi > new_hi) roll_erase(x, new_hi + 1, old_hi);
+  if(new_lo < old_lo) lcd_draw_line(x, new_lo, x, old_lo - 1, color);
+  if(new_hi > old_hi) lcd_draw_line(x, old_hi + 1, x, new_hi, color);
+}
+
+/* 把一条Y坐标历史整体左移一列, 新值从右端进入 */
+static void roll_shift_trace(uint16_t *hist, uint16_t new_y, uint16_t color)
+{
+  uint16_t i;
+  uint16_t old_lo, old_hi, new_lo, new_hi;
+  
+  /* 第i列画出hist[i-1]到hist[i]之间的竖线 */
+  for(i = 1; i < WAVE_WIDTH - 1; i++) {
+    uint16_t a = hist[i - 1], b = hist[i], c = hist[i + 1];
     
-    lcd_draw_line(current_x, WAVE_START_Y, current_x, WAVE_START_Y + WAVE_HEIGHT, YELLOW);
+    old_lo = (a < b) ? a : b;
+    old_hi = (a < b) ? b : a;
+    new_lo = (b < c) ? b : c;
+    new_hi = (b < c) ? c : b;
+    roll_update_column(WAVE_START_X + i, old_lo, old_hi, new_lo, new_hi, color);
   }
-}
\ No newline at end of file
+  
+  {
+    uint16_t a = hist[WAVE_WIDTH - 2], b = hist[WAVE_WIDTH - 1];
+    
+    old_lo = (a < b) ? a : b;
+    old_hi = (a < b) ? b : a;
+    new_lo = (b < new_y) ? b : new_y;
+    new_hi = (b < new_y) ? new_y : b;
+    roll_update_column(WAVE_START_X + WAVE_WIDTH - 1, old_lo, old_hi, new_lo, new_hi, color);
+  }
+  
+  for(i = 0; i < WAVE_WIDTH - 1; i++) {
+    hist[i] = hist[i + 1];
+  }
+  hist[WAVE_WIDTH - 1] = new_y;
+}
+
+/**
+ * @brief       滚动显示: 新数据从右端进入, 波形整体左移一列
+ *   @note      竖屏安装时LCD控制器的硬件滚动方向是沿800像素的Y轴, 而时间轴是X轴,
+ *              无法用滚动寄存器实现左移, 因此改为软件条带图: 每列只改写与上一帧不同的像素.
+ *              慢速信号相邻列变化很小, 每次左移改写的像素数远小于整个显示区域.
+ */
+void draw_waveform_roll(uint16_t dac_value, uint16_t adc_value)
+{
+  uint16_t dac_y = WAVE_START_Y + (WAVE_HEIGHT/2) - (dac_value * (WAVE_HEIGHT/2) / 4096);
+  uint16_t adc_y = WAVE_START_Y + (WAVE_HEIGHT/2) + 10 + (4096 - adc_value) * (WAVE_HEIGHT/2 - 20) / 4096;
+  uint16_t i;
+  
+  if(!roll_primed) {
+    /* 首次进入时以当前值填满历史, 画出一条水平线 */
+    for(i = 0; i < WAVE_WIDTH; i++) {
+      roll_dac_y[i] = dac_y;
+      roll_adc_y[i] = adc_y;
+    }
+    lcd_draw_line(WAVE_START_X + 1, dac_y, WAVE_START_X + WAVE_WIDTH - 1, dac_y, BLUE);
+    lcd_draw_line(WAVE_START_X + 1, adc_y, WAVE_START_X + WAVE_WIDTH - 1, adc_y, RED);
+    roll_primed = 1;
+  } else {
+    roll_shift_trace(roll_dac_y, dac_y, BLUE);
+    roll_shift_trace(roll_adc_y, adc_y, RED);
+  }
+  
+  /* 不画扫描线, 但扫描位置照常推进, 周期检测和时基调整继续工作 */
+  waveform_advance();
+}
+/* 波特图横坐标: 对数频率映射到显示宽度 */
+static uint16_t bode_x(uint32_t freq_mhz)
+{
+  float pos = (bode_log_span != 0.0f) ? (logf((float)freq_mhz) - bode_log_start) / bode_log_span : 0.0f;
+  
+  if(pos < 0.0f) pos = 0.0f;
+  if(pos > 1.0f) pos = 1.0f;
+  return WAVE_START_X + (uint16_t)(pos * WAVE_WIDTH + 0.5f);
+}
+
+/* 增益(0.01dB)和相位(0.1度)的纵坐标, 分别在上半和下半区域内限幅 */
+static uint16_t bode_gain_y(int16_t gain_cdb)
+{
+  int32_t y = WAVE_START_Y + (BODE_DB_TOP * 100 - gain_cdb) * (WAVE_HEIGHT / 2) / (BODE_DB_SPAN * 100);
+  
+  if(y < WAVE_START_Y) y = WAVE_START_Y;
+  if(y > WAVE_START_Y + WAVE_HEIGHT / 2) y = WAVE_START_Y + WAVE_HEIGHT / 2;
+  return (uint16_t)y;
+}
+
+static uint16_t bode_phase_y(int16_t phase_x10)
+{
+  return WAVE_START_Y + WAVE_HEIGHT / 2 + (1800 - phase_x10) * (WAVE_HEIGHT / 2) / 3600;
+}
+
+/**
+ * @brief       画波特图坐标
+ *   @note      上半为增益 BODE_DB_TOP ~ BODE_DB_TOP-BODE_DB_SPAN dB, 每格10dB; 下半为相位 +180 ~ -180度, 每格90度.
+ *              横轴为对数频率, 在每个十倍频处画竖线并标注.
+ * @param       f_start_mhz: 左端频率, mHz
+ * @param       f_stop_mhz : 右端频率, mHz
+ */
+void draw_bode_frame(uint32_t f_start_mhz, uint32_t f_stop_mhz)
+{
+  static const char *const decade_names[] = { "1mHz", "10mHz", "0.1Hz", "1Hz", "10Hz", "100Hz", "1kHz", "10kHz", "100kHz" };
+  uint32_t f = 1;
+  uint16_t i, y;
+  
+  bode_log_start = logf((float)f_start_mhz);
+  bode_log_span = logf((float)f_stop_mhz) - bode_log_start;
+  
+  waveform_clear_area();
+  
+  for(i = 1; i < BODE_DB_SPAN / 10; i++) {
+    y = WAVE_START_Y + i * (WAVE_HEIGHT / 2) * 10 / BODE_DB_SPAN;
+    lcd_draw_line(WAVE_START_X, y, WAVE_START_X + WAVE_WIDTH, y, LGRAY);
+  }
+  for(i = 1; i < 4; i++) {
+    y = WAVE_START_Y + WAVE_HEIGHT / 2 + i * (WAVE_HEIGHT / 8);
+    lcd_draw_line(WAVE_START_X, y, WAVE_START_X + WAVE_WIDTH, y, LGRAY);
+  }
+  
+  for(i = 0; i < sizeof(decade_names) / sizeof(decade_names[0]); i++, f *= 10) {
+    uint16_t x;
+    
+    if(f < f_start_mhz || f > f_stop_mhz) continue;
+    x = bode_x(f);
+    lcd_draw_line(x, WAVE_START_Y, x, WAVE_START_Y + WAVE_HEIGHT, LGRAY);
+    lcd_show_string((x > WAVE_START_X + 20) ? x - 20 : WAVE_START_X, WAVE_START_Y + WAVE_HEIGHT + 5, 48, 12, 12,
+                    (char *)decade_names[i], BLACK);
+  }
+  
+  /* 边框和增益/相位分界线 */
+  lcd_draw_rectangle(WAVE_START_X, WAVE_START_Y, WAVE_START_X + WAVE_WIDTH, WAVE_START_Y + WAVE_HEIGHT, BLACK);
+  lcd_draw_line(WAVE_START_X, WAVE_START_Y + WAVE_HEIGHT / 2, WAVE_START_X + WAVE_WIDTH, WAVE_START_Y + WAVE_HEIGHT / 2, BLACK);
+  
+  lcd_show_string(WAVE_START_X + 4, WAVE_START_Y + 4, 60, 12, 12, "+10dB", BLUE);
+  lcd_show_string(WAVE_START_X + 4, WAVE_START_Y + WAVE_HEIGHT / 2 - 16, 60, 12, 12, "-70dB", BLUE);
+  lcd_show_string(WAVE_START_X + 4, WAVE_START_Y + WAVE_HEIGHT / 2 + 4, 60, 12, 12, "+180", RED);
+  lcd_show_string(WAVE_START_X + 4, WAVE_START_Y + WAVE_HEIGHT - 16, 60, 12, 12, "-180", RED);
+  lcd_show_string(80, WAVE_START_Y + WAVE_HEIGHT + 10, 300, 16, 16, "Upper:Gain 10dB/div  Lower:Phase", BLACK);
+}
+
+/**
+ * @brief       画一个频点, 与上一个频点连线
+ *   @note      相位在±180度处折返时不连线. 曲线为3像素宽, 裁剪在边框以内.
+ * @param       index    : 频点序号, 0为第一个点
+ * @param       freq_mhz : 频率
+ * @param       gain_cdb : 增益, 0.01dB
+ * @param       phase_x10: 相位, 0.1度
+ */
+void draw_bode_point(uint16_t index, uint32_t freq_mhz, int16_t gain_cdb, int16_t phase_x10)
+{
+  uint16_t x = bode_x(freq_mhz);
+  uint16_t gy = bode_gain_y(gain_cdb);
+  uint16_t py = bode_phase_y(phase_x10);
+  
+  lcd_set_clip(WAVE_START_X + 1, WAVE_START_Y + 1, WAVE_START_X + WAVE_WIDTH - 1, WAVE_START_Y + WAVE_HEIGHT - 1);
+  if(index == 0) {
+    lcd_draw_thick_line(x, gy, x, gy, 3, BLUE);
+    lcd_draw_thick_line(x, py, x, py, 3, RED);
+  } else {
+    lcd_draw_thick_line(bode_prev_x, bode_prev_gy, x, gy, 3, BLUE);
+    if(phase_x10 - bode_prev_phase <= 1800 && bode_prev_phase - phase_x10 <= 1800) {
+      lcd_draw_thick_line(bode_prev_x, bode_prev_py, x, py, 3, RED);
+    }
+  }
+  lcd_reset_clip();
+  bode_prev_x = x;
+  bode_prev_gy = gy;
+  bode_prev_py = py;
+  bode_prev_phase = phase_x10;
+}
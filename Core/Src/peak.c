@@ -0,0 +1,139 @@
+#include "peak.h"
+#include "acquisition.h"
+#include "capture.h"
+#include "trigger.h"
+#include <string.h>
+
+/* 每factor个原始采样归并为一列, 1表示关闭峰值检测 */
+static uint16_t peak_factor = 1;
+
+/* 跨数据块未完成的列 */
+static uint16_t col_count = 0;
+static uint16_t col_min = 0;
+static uint16_t col_max = 0;
+
+/* 一个半缓冲最多产生 ACQ_HALF_SAMPLES/2+1 列, 每列两个采样 */
+static uint16_t peak_out[ACQ_HALF_SAMPLES + 2];
+
+/* 设置抽取比例, 范围 1~PEAK_MAX_FACTOR */
+void peak_configure(uint16_t factor)
+{
+  if(factor < 1) factor = 1;
+  if(factor > PEAK_MAX_FACTOR) factor = PEAK_MAX_FACTOR;
+  peak_factor = factor;
+  peak_reset();
+}
+
+uint16_t peak_get_factor(void)
+{
+  return peak_factor;
+}
+
+/* 丢弃未完成的列 */
+void peak_reset(void)
+{
+  col_count = 0;
+}
+
+/**
+ * @brief       求一段采样的最小值和最大值
+ *   @note      按32位字读取, 每次加载得到两个采样; 先比较这两个采样, 较小者只和min比较,
+ *              较大者只和max比较, 每两个采样3次比较. Cortex-M3没有SIMD指令, 收益来自
+ *              加载次数减半和比较次数减少. 首尾不对齐的单个采样单独处理.
+ *              字经memcpy读出, 不违反严格别名规则; 地址4字节对齐, GCC编译为单条LDR.
+ * @param       samples: 采样数据, 半字对齐
+ * @param       n      : 采样个数, 大于0
+ * @param       min_out: 最小值
+ * @param       max_out: 最大值
+ */
+void peak_minmax(const uint16_t *samples, uint16_t n, uint16_t *min_out, uint16_t *max_out)
+{
+  uint32_t mn = 0xFFFF, mx = 0;
+  uint16_t i;
+
+  if(((uintptr_t)samples & 2) && n > 0) {
+    mn = mx = *samples++;
+    n--;
+  }
+
+  for(i = n >> 1; i > 0; i--) {
+    uint32_t v, a, b;
+
+    memcpy(&v, samples, sizeof(v));
+    samples += 2;
+    a = v & 0xFFFF;
+    b = v >> 16;
+
+    if(a > b) {
+      uint32_t t = a;
+      a = b;
+      b = t;
+    }
+    if(a < mn) mn = a;
+    if(b > mx) mx = b;
+  }
+
+  if(n & 1) {
+    uint32_t s = *samples;
+
+    if(s < mn) mn = s;
+    if(s > mx) mx = s;
+  }
+
+  *min_out = mn;
+  *max_out = mx;
+}
+
+/**
+ * @brief       归并一段原始采样, 完成的列以(min, max)对送入触发采集引擎
+ *   @note      作为acquisition的数据块处理函数在DMA中断中调用
+ */
+void peak_push(const uint16_t *samples, uint16_t n)
+{
+  uint16_t out = 0;
+
+  while(n > 0) {
+    uint16_t take = peak_factor - col_count;
+    uint16_t mn, mx;
+
+    if(take > n) take = n;
+    peak_minmax(samples, take, &mn, &mx);
+
+    if(col_count == 0) {
+      col_min = mn;
+      col_max = mx;
+    } else {
+      if(mn < col_min) col_min = mn;
+      if(mx > col_max) col_max = mx;
+    }
+    col_count += take;
+    samples += take;
+    n -= take;
+
+    if(col_count >= peak_factor) {
+      peak_out[out++] = col_min;
+      peak_out[out++] = col_max;
+      col_count = 0;
+    }
+  }
+
+  if(out > 0) {
+    capture_push(peak_out, out);
+  }
+}
+
+/**
+ * @brief       峰值检测模式的触发检测函数(capture_trigger_fn)
+ *   @note      在min/max交替的序列上做软件触发: 上升沿由min布防, 由max触发, 窄脉冲同样能触发.
+ *              触发落在max上时退回到同一列的min, 保证记录总是从完整的(min, max)对开始.
+ *              布防状态下capture_push()传入的数据总是从列边界开始, 退回不会越过数据起点.
+ */
+int32_t peak_trigger_find(const uint16_t *samples, uint16_t n)
+{
+  int32_t hit = trigger_find(samples, n);
+
+  if(hit > 0 && ((samples - peak_out + hit) & 1)) {
+    hit--;
+  }
+  return hit;
+}
@@ -0,0 +1,139 @@
+#include "scan.h"
+#include "capture.h"
+
+static uint16_t scan_ring[SCAN_MAX_CHANNELS][SCAN_RING_SIZE];
+
+static uint8_t scan_nch = 2;
+static uint16_t scan_skew = 0;                 /* 相邻通道的采样时间差, 采样周期的Q15比例 */
+static uint8_t scan_phase = 0;                 /* 下一个采样所属的通道 */
+static uint32_t scan_frames = 0;               /* 已写完的帧数(不取模) */
+static volatile uint32_t scan_record_end = 0;  /* 触发记录最后一帧之后的帧序号 */
+
+static scan_clock_fn scan_clock = 0;
+static uint32_t scan_cycles_max = 0;
+
+/**
+ * @brief       设置扫描通道数和通道间采样时间差
+ * @param       channels: 通道数 1~SCAN_MAX_CHANNELS
+ * @param       skew_q15: 相邻通道的采样时间差占采样周期的比例(Q15), 由ADC转换时间和采样率求出
+ */
+void scan_configure(uint8_t channels, uint16_t skew_q15)
+{
+  if(channels < 1) channels = 1;
+  if(channels > SCAN_MAX_CHANNELS) channels = SCAN_MAX_CHANNELS;
+
+  scan_nch = channels;
+  scan_skew = skew_q15;
+  scan_reset();
+}
+
+/* 复位拆分状态, 在启动DMA之前调用 */
+void scan_reset(void)
+{
+  scan_phase = 0;
+  scan_frames = 0;
+  scan_record_end = 0;
+  scan_cycles_max = 0;
+}
+
+void scan_set_clock(scan_clock_fn clock)
+{
+  scan_clock = clock;
+}
+
+uint8_t scan_channels(void)
+{
+  return scan_nch;
+}
+
+uint16_t scan_skew_q15(void)
+{
+  return scan_skew;
+}
+
+/* 把通道0环形缓冲中[from, to)帧送入触发采集, 返回记录完成时的帧序号, 未完成返回0 */
+static uint32_t scan_feed_capture(uint32_t from, uint32_t to)
+{
+  while(from < to) {
+    uint16_t idx = from & SCAN_RING_MASK;
+    uint16_t n = SCAN_RING_SIZE - idx;
+    uint16_t used;
+
+    if(n > to - from) n = to - from;
+    used = capture_feed(&scan_ring[0][idx], n);
+    from += used;
+    if(capture_ready()) return from;
+    if(used == 0) break;
+  }
+  return 0;
+}
+
+/**
+ * @brief       扫描模式的数据块处理函数, 在DMA中断中调用
+ *   @note      每次拆分最多SCAN_CHUNK_FRAMES帧, 随即把新的完整帧送入触发采集. 记录完成后
+ *              停止写环形缓冲(只推进帧内相位), 直到主循环取走记录并重新布防, 因此记录在
+ *              环形缓冲中保持有效.
+ */
+void scan_push(const uint16_t *samples, uint16_t n)
+{
+  uint32_t t0 = scan_clock ? scan_clock() : 0;
+  uint8_t nch = scan_nch, phase = scan_phase;
+
+  while(n > 0 && !capture_ready()) {
+    uint32_t first = scan_frames;
+    uint16_t chunk = SCAN_CHUNK_FRAMES * nch;
+    uint32_t end;
+
+    if(chunk > n) chunk = n;
+    n -= chunk;
+    while(chunk--) {
+      scan_ring[phase][scan_frames & SCAN_RING_MASK] = *samples++;
+      if(++phase >= nch) {
+        phase = 0;
+        scan_frames++;
+      }
+    }
+
+    end = scan_feed_capture(first, scan_frames);
+    if(end) scan_record_end = end;
+  }
+  scan_phase = (phase + n) % nch;
+
+  if(scan_clock) {
+    uint32_t cycles = scan_clock() - t0;
+    if(cycles > scan_cycles_max) scan_cycles_max = cycles;
+  }
+}
+
+/**
+ * @brief       取出一个通道与触发记录对齐的数据, 只能在capture_ready()之后调用
+ *   @note      通道ch的第f帧比通道0晚 d = ch*skew 个采样周期, 通道0第f帧时刻的值为
+ *              x[f] + (x[f-1] - x[f]) * d, 需要记录之前的一帧, 环形缓冲留有余量.
+ * @param       ch : 通道
+ * @param       dst: 输出
+ * @param       len: 长度, 不超过触发记录长度和SCAN_MAX_RECORD
+ */
+void scan_copy_record(uint8_t ch, uint16_t *dst, uint16_t len)
+{
+  const uint16_t *ring = scan_ring[ch];
+  uint32_t f = scan_record_end - len;
+  uint32_t d = (uint32_t)scan_skew * ch;
+  uint16_t prev, i;
+
+  if(ch >= scan_nch) return;
+  if(d > 32767) d = 32767;
+
+  prev = ring[(f - 1) & SCAN_RING_MASK];
+  for(i = 0; i < len; i++, f++) {
+    uint16_t x = ring[f & SCAN_RING_MASK];
+
+    dst[i] = (uint16_t)((int32_t)x + ((((int32_t)prev - (int32_t)x) * (int32_t)d) >> 15));
+    prev = x;
+  }
+}
+
+/* 处理一个数据块的最大耗时(周期计数器的计数) */
+uint32_t scan_push_cycles_max(void)
+{
+  return scan_cycles_max;
+}
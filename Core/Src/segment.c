@@ -0,0 +1,131 @@
+#include "segment.h"
+#include "capture.h"
+
+static uint16_t segment_mem[SEGMENT_MEM_SAMPLES];
+static uint32_t segment_time[SEGMENT_MAX_COUNT];   /* 触发点的采样序号 */
+
+static uint16_t seg_count = 16;
+static uint16_t seg_len = SEGMENT_MEM_SAMPLES / 16;
+static volatile uint16_t seg_done = 0;
+static volatile uint8_t seg_running = 0;
+
+static uint32_t sample_index = 0;               /* 开始采集后送入的采样总数 */
+static segment_clock_fn seg_clock = 0;
+static uint32_t rearm_cycles_max = 0;
+
+/**
+ * @brief       设置分段数和每段长度
+ * @param       count: 分段数 1~SEGMENT_MAX_COUNT
+ * @param       len  : 每段采样数, 不超过 SEGMENT_MEM_SAMPLES/count 和 CAPTURE_MAX_RECORD
+ *   @note      触发采集引擎的记录长度需由调用者按segment_length()设置
+ */
+void segment_configure(uint16_t count, uint16_t len)
+{
+  if(count < 1) count = 1;
+  if(count > SEGMENT_MAX_COUNT) count = SEGMENT_MAX_COUNT;
+  if(len > SEGMENT_MEM_SAMPLES / count) len = SEGMENT_MEM_SAMPLES / count;
+  if(len > CAPTURE_MAX_RECORD) len = CAPTURE_MAX_RECORD;
+  if(len < 2) len = 2;
+
+  seg_running = 0;
+  seg_count = count;
+  seg_len = len;
+  seg_done = 0;
+}
+
+void segment_set_clock(segment_clock_fn clock)
+{
+  seg_clock = clock;
+}
+
+/* 清空已有分段, 开始采集. 调用前触发采集引擎应已布防 */
+void segment_start(void)
+{
+  seg_done = 0;
+  sample_index = 0;
+  rearm_cycles_max = 0;
+  seg_running = 1;
+}
+
+void segment_stop(void)
+{
+  seg_running = 0;
+}
+
+/**
+ * @brief       分段采集的数据块处理函数, 在DMA中断中调用
+ *   @note      一段记录完成后复制到分段存储, 记下时间戳, 立即重新布防并继续处理本块剩余的采样.
+ *              重新布防耗时(从检测到记录完成到重新布防)以周期计数器测量, 保留最大值.
+ */
+void segment_push(const uint16_t *samples, uint16_t n)
+{
+  while(n > 0 && seg_running) {
+    uint16_t used = capture_feed(samples, n);
+
+    samples += used;
+    n -= used;
+    sample_index += used;
+
+    if(capture_ready()) {
+      uint32_t t0 = seg_clock ? seg_clock() : 0;
+      uint16_t post = capture_record_length() - capture_trigger_index();
+
+      capture_copy_record(&segment_mem[seg_done * seg_len], seg_len);
+      segment_time[seg_done] = sample_index - post;
+      seg_done++;
+
+      if(seg_done >= seg_count) {
+        seg_running = 0;
+        capture_disarm();
+      } else {
+        capture_arm_continue();
+      }
+
+      if(seg_clock) {
+        uint32_t cycles = seg_clock() - t0;
+        if(cycles > rearm_cycles_max) rearm_cycles_max = cycles;
+      }
+    } else if(used == 0) {
+      break;      /* 触发采集未布防 */
+    }
+  }
+}
+
+uint8_t segment_running(void)
+{
+  return seg_running;
+}
+
+uint16_t segment_count(void)
+{
+  return seg_count;
+}
+
+/* 已完成的分段数 */
+uint16_t segment_done(void)
+{
+  return seg_done;
+}
+
+uint16_t segment_length(void)
+{
+  return seg_len;
+}
+
+/* 第index段的记录 */
+const uint16_t *segment_data(uint16_t index)
+{
+  return &segment_mem[(uint32_t)index * seg_len];
+}
+
+/* 第index段触发点的采样序号, 从segment_start()开始计数 */
+uint32_t segment_timestamp(uint16_t index)
+{
+  return segment_time[index];
+}
+
+/* 最大重新布防耗时(周期计数器的计数) */
+uint32_t segment_rearm_cycles_max(void)
+{
+  return rearm_cycles_max;
+}
@@ -0,0 +1,277 @@
+#include "trigger.h"
+
+/* 触发参数 */
+static trigger_edge_t trig_edge = TRIGGER_EDGE_RISING;
+static trigger_sweep_t trig_sweep = TRIGGER_SWEEP_AUTO;
+static trigger_source_t trig_source = TRIGGER_SOURCE_SOFTWARE;
+static uint16_t trig_level = TRIGGER_DEFAULT_LEVEL;
+static uint16_t trig_hysteresis = TRIGGER_DEFAULT_HYSTERESIS;
+static uint16_t arm_low = TRIGGER_DEFAULT_LEVEL - TRIGGER_DEFAULT_HYSTERESIS;    /* 上升沿布防门限 */
+static uint16_t arm_high = TRIGGER_DEFAULT_LEVEL + TRIGGER_DEFAULT_HYSTERESIS;   /* 下降沿布防门限 */
+static uint32_t holdoff = 0;
+
+/* 检测状态, 跨数据块保持 */
+static uint8_t armed_rise = 0;
+static uint8_t armed_fall = 0;
+static uint32_t holdoff_left = 0;
+
+static const char *const edge_names[TRIGGER_EDGE_COUNT] = { "Rise", "Fall", "Both" };
+static const char *const sweep_names[TRIGGER_SWEEP_COUNT] = { "Auto", "Norm", "Single" };
+static const char *const source_names[TRIGGER_SOURCE_COUNT] = { "SW", "AWD" };
+
+/* 清除迟滞和释抑状态, 修改参数后调用 */
+void trigger_reset(void)
+{
+  armed_rise = 0;
+  armed_fall = 0;
+  holdoff_left = 0;
+}
+
+void trigger_set_edge(trigger_edge_t edge)
+{
+  if(edge >= TRIGGER_EDGE_COUNT) edge = TRIGGER_EDGE_RISING;
+  trig_edge = edge;
+  trigger_reset();
+}
+
+/**
+ * @brief       设置触发电平和迟滞宽度
+ * @param       level     : 触发电平 0~4095
+ * @param       hysteresis: 迟滞宽度(LSB), 应大于信号噪声的峰峰值的一半
+ */
+void trigger_set_level(uint16_t level, uint16_t hysteresis)
+{
+  if(level > 4095) level = 4095;
+  trig_level = level;
+  trig_hysteresis = hysteresis;
+  arm_low = (level > hysteresis) ? (level - hysteresis) : 0;
+  arm_high = ((uint32_t)level + hysteresis < 4095) ? (level + hysteresis) : 4095;
+  trigger_reset();
+}
+
+/* 释抑采样数, 0表示不释抑 */
+void trigger_set_holdoff(uint32_t samples)
+{
+  holdoff = samples;
+  holdoff_left = 0;
+}
+
+void trigger_set_sweep(trigger_sweep_t sweep)
+{
+  if(sweep >= TRIGGER_SWEEP_COUNT) sweep = TRIGGER_SWEEP_AUTO;
+  trig_sweep = sweep;
+}
+
+/* 触发检测方式, 硬件方式不可用时由调用者退回软件检测 */
+void trigger_set_source(trigger_source_t source)
+{
+  if(source >= TRIGGER_SOURCE_COUNT) source = TRIGGER_SOURCE_SOFTWARE;
+  trig_source = source;
+}
+
+trigger_edge_t trigger_get_edge(void)
+{
+  return trig_edge;
+}
+
+trigger_sweep_t trigger_get_sweep(void)
+{
+  return trig_sweep;
+}
+
+trigger_source_t trigger_get_source(void)
+{
+  return trig_source;
+}
+
+uint16_t trigger_get_level(void)
+{
+  return trig_level;
+}
+
+uint16_t trigger_get_hysteresis(void)
+{
+  return trig_hysteresis;
+}
+
+/* 上升沿布防门限 level-hysteresis */
+uint16_t trigger_get_arm_low(void)
+{
+  return arm_low;
+}
+
+/* 下降沿布防门限 level+hysteresis */
+uint16_t trigger_get_arm_high(void)
+{
+  return arm_high;
+}
+
+uint32_t trigger_get_holdoff(void)
+{
+  return holdoff;
+}
+
+const char *trigger_edge_name(trigger_edge_t edge)
+{
+  return (edge < TRIGGER_EDGE_COUNT) ? edge_names[edge] : "?";
+}
+
+const char *trigger_sweep_name(trigger_sweep_t sweep)
+{
+  return (sweep < TRIGGER_SWEEP_COUNT) ? sweep_names[sweep] : "?";
+}
+
+const char *trigger_source_name(trigger_source_t source)
+{
+  return (source < TRIGGER_SOURCE_COUNT) ? source_names[source] : "?";
+}
+
+/* 释抑期间只更新迟滞布防状态, 不产生触发 */
+static void trigger_track(const uint16_t *samples, uint16_t n)
+{
+  uint16_t i;
+
+  for(i = 0; i < n; i++) {
+    if(samples[i] <= arm_low) {
+      armed_rise = 1;
+      armed_fall = 0;
+    } else if(samples[i] >= arm_high) {
+      armed_fall = 1;
+      armed_rise = 0;
+    }
+  }
+}
+
+/**
+ * @brief       在一段连续采样中查找下一个触发点
+ *   @note      单边沿模式下分成"等待布防"和"等待过电平"两个只做一次比较的内循环,
+ *              状态保存在局部变量中, 每个采样的开销只有一次加载和一次比较.
+ * @param       samples: 采样数据
+ * @param       n      : 采样个数
+ * @retval      触发点偏移, 未触发返回-1
+ */
+int32_t trigger_find(const uint16_t *samples, uint16_t n)
+{
+  uint16_t i = 0;
+  uint16_t level = trig_level;
+  uint16_t lo = arm_low;
+  uint16_t hi = arm_high;
+
+  if(holdoff_left > 0) {
+    uint16_t skip = (holdoff_left < n) ? (uint16_t)holdoff_left : n;
+
+    trigger_track(samples, skip);
+    holdoff_left -= skip;
+    i = skip;
+  }
+
+  switch(trig_edge) {
+    case TRIGGER_EDGE_RISING:
+      if(!armed_rise) {
+        while(i < n && samples[i] > lo) i++;
+        if(i >= n) return -1;
+        armed_rise = 1;
+      }
+      while(i < n && samples[i] < level) i++;
+      if(i >= n) return -1;
+      armed_rise = 0;
+      break;
+
+    case TRIGGER_EDGE_FALLING:
+      if(!armed_fall) {
+        while(i < n && samples[i] < hi) i++;
+        if(i >= n) return -1;
+        armed_fall = 1;
+      }
+      while(i < n && samples[i] > level) i++;
+      if(i >= n) return -1;
+      armed_fall = 0;
+      break;
+
+    default:
+    {
+      uint8_t rise = armed_rise;
+      uint8_t fall = armed_fall;
+
+      for(; i < n; i++) {
+        uint16_t s = samples[i];
+
+        if(rise && s >= level) {
+          rise = 0;
+          fall = (s >= hi);
+          break;
+        }
+        if(fall && s <= level) {
+          fall = 0;
+          rise = (s <= lo);
+          break;
+        }
+        if(s <= lo) rise = 1;
+        else if(s >= hi) fall = 1;
+      }
+      armed_rise = rise;
+      armed_fall = fall;
+      if(i >= n) return -1;
+      break;
+    }
+  }
+
+  holdoff_left = holdoff;
+  return i;
+}
+
+/**
+ * @brief       在已知包含触发点的小窗口内精确定位触发采样
+ *   @note      用于硬件触发标记之后的精确定位. 先从窗口末尾向前找到最近的布防点
+ *              (上升沿: 低于level-hysteresis), 再从布防点向后找第一个过电平的采样;
+ *              布防点在窗口之前时从窗口起点开始查找. 不修改trigger_find()的状态.
+ * @param       samples: 采样数据
+ * @param       from   : 窗口起点
+ * @param       to     : 窗口终点(包含)
+ * @retval      触发点偏移, 窗口内没有过电平的采样返回-1
+ */
+int32_t trigger_refine(const uint16_t *samples, uint16_t from, uint16_t to)
+{
+  uint16_t i = to;
+
+  if(trig_edge == TRIGGER_EDGE_FALLING) {
+    while(i > from && samples[i] < arm_high) i--;
+    for(; i <= to; i++) {
+      if(samples[i] <= trig_level) return i;
+    }
+  } else {
+    while(i > from && samples[i] > arm_low) i--;
+    for(; i <= to; i++) {
+      if(samples[i] >= trig_level) return i;
+    }
+  }
+  return -1;
+}
+
+/**
+ * @brief       由硬件触发标记定位过电平点
+ *   @note      end是标记给出的过电平采样的最晚位置(相对本段起点, 可以在本段之后).
+ *              在整段内用trigger_refine()查找end之前最近的过电平点, 不限制与标记的距离,
+ *              因此测得的延迟不受预设上限的截断, 由调用者与上限比较.
+ * @param       samples: 本段采样数据
+ * @param       n      : 采样数
+ * @param       end    : 过电平采样的最晚位置
+ * @param       latency: 输出过电平点到end的采样数; 过电平点不在本段内时为TRIGGER_LATENCY_UNKNOWN
+ * @retval      触发点偏移; end在本段之后且本段内没有过电平点时返回-1(过电平点可能在下一段开头);
+ *              end在本段内但找不到过电平点时返回end, 段首已过电平(过电平在更早的段中)时返回0
+ */
+int32_t trigger_locate(const uint16_t *samples, uint16_t n, uint16_t end, uint16_t *latency)
+{
+  uint16_t last = (end < n) ? end : (n - 1);
+  int32_t hit;
+
+  *latency = TRIGGER_LATENCY_UNKNOWN;
+  if(n == 0) return -1;
+
+  hit = trigger_refine(samples, 0, last);
+  if(hit < 0) {
+    return (end >= n) ? -1 : end;
+  }
+  if(hit > 0) *latency = end - hit;
+  return hit;
+}
@@ -0,0 +1,203 @@
+#include "ui.h"
+#include <stddef.h>
+#include <string.h>
+
+#define UI_DIRTY            0x01    /* 内容有变化 */
+#define UI_FULL             0x02    /* 屏上内容未知, 整个重画 */
+
+static const ui_backend_t *ui_be = NULL;
+static ui_text_t *ui_texts[UI_MAX_TEXTS];
+static ui_button_t *ui_buttons[UI_MAX_BUTTONS];
+static uint8_t ui_text_count = 0;
+static uint8_t ui_button_count = 0;
+
+/**
+ * @brief       设置绘制接口, 已登记的元素在下一次ui_flush()时整个重画
+ * @param       backend: 绘制接口
+ */
+void ui_init(const ui_backend_t *backend)
+{
+  ui_be = backend;
+  ui_invalidate();
+}
+
+/* 屏幕被其它代码覆盖(如清屏)后调用 */
+void ui_invalidate(void)
+{
+  uint8_t i;
+
+  for(i = 0; i < ui_text_count; i++) ui_texts[i]->flags = UI_DIRTY | UI_FULL;
+  for(i = 0; i < ui_button_count; i++) ui_buttons[i]->flags = UI_DIRTY | UI_FULL;
+}
+
+/**
+ * @brief       初始化并登记文本框, 内容为空
+ * @param       x,y  : 左上角
+ * @param       width: 宽度, 清除和显示都不超出(最后一个字符可以部分超出)
+ * @param       size : 字体 12/16/24/32
+ * @param       color: 文字颜色
+ * @param       bg   : 背景色
+ */
+void ui_text_init(ui_text_t *t, uint16_t x, uint16_t y, uint16_t width, uint8_t size, uint16_t color, uint16_t bg)
+{
+  t->x = x;
+  t->y = y;
+  t->width = width;
+  t->size = size;
+  t->color = color;
+  t->bg = bg;
+  t->shown_color = color;
+  t->text[0] = '\0';
+  t->shown[0] = '\0';
+  t->flags = UI_DIRTY | UI_FULL;
+  if(ui_text_count < UI_MAX_TEXTS) ui_texts[ui_text_count++] = t;
+}
+
+/* 设置内容, 与当前内容相同时不做标记 */
+void ui_text_set(ui_text_t *t, const char *str)
+{
+  if(strncmp(t->text, str, UI_TEXT_MAX - 1) == 0) return;
+  strncpy(t->text, str, UI_TEXT_MAX - 1);
+  t->text[UI_TEXT_MAX - 1] = '\0';
+  t->flags |= UI_DIRTY;
+}
+
+/* 改变文字颜色, 下一次整个重画 */
+void ui_text_set_color(ui_text_t *t, uint16_t color)
+{
+  if(t->color == color) return;
+  t->color = color;
+  t->flags |= UI_DIRTY;
+}
+
+/**
+ * @brief       初始化并登记按钮, 未选中, 文字白色, 选中时黑色, 边框黑色
+ * @param       x,y         : 左上角
+ * @param       width,height: 大小, 边框画在x+width和y+height上
+ * @param       text        : 文字, 只保存指针
+ * @param       color       : 背景色
+ * @param       highlight   : 选中时的背景色
+ */
+void ui_button_init(ui_button_t *b, uint16_t x, uint16_t y, uint16_t width, uint16_t height,
+                    const char *text, uint16_t color, uint16_t highlight)
+{
+  b->x = x;
+  b->y = y;
+  b->width = width;
+  b->height = height;
+  b->text = text;
+  b->color = color;
+  b->highlight = highlight;
+  b->text_color = UI_WHITE;
+  b->highlight_text = UI_BLACK;
+  b->border = UI_BLACK;
+  b->selected = 0;
+  b->flags = UI_DIRTY | UI_FULL;
+  if(ui_button_count < UI_MAX_BUTTONS) ui_buttons[ui_button_count++] = b;
+}
+
+void ui_button_select(ui_button_t *b, uint8_t selected)
+{
+  selected = (selected != 0);
+  if(b->selected == selected) return;
+  b->selected = selected;
+  b->flags |= UI_DIRTY;
+}
+
+/* 从第a个字符起显示n个字符 */
+static void ui_text_run(const ui_text_t *t, uint16_t a, uint16_t n)
+{
+  char buf[UI_TEXT_MAX];
+  uint16_t cw = t->size / 2;
+
+  memcpy(buf, &t->text[a], n);
+  buf[n] = '\0';
+  ui_be->text(t->x + a * cw, t->y, n * cw, t->size, buf, t->color, t->bg);
+}
+
+/**
+ * @brief       重画文本框中变化的部分
+ *   @note      逐字符比较, 每段连续变化的字符画一次; 新内容较短时清除多出的部分.
+ *              颜色改变或屏上内容未知时, 画出全部文字并清除文字之后到宽度为止的区域.
+ * @retval      调用绘制接口的次数
+ */
+static uint16_t ui_text_flush(ui_text_t *t)
+{
+  uint16_t cw = t->size / 2;
+  uint16_t vis = (t->width + cw - 1) / cw;    /* 能显示的字符数 */
+  uint16_t len = (uint16_t)strlen(t->text);
+  uint16_t old = (uint16_t)strlen(t->shown);
+  uint16_t i, a, ops = 0;
+
+  if(len > vis) len = vis;
+
+  if((t->flags & UI_FULL) || t->shown_color != t->color) {
+    if(len > 0) {
+      ui_text_run(t, 0, len);
+      ops++;
+    }
+    old = vis;                  /* 清除到宽度为止 */
+  } else {
+    i = 0;
+    while(i < len) {
+      if(i < old && t->text[i] == t->shown[i]) {
+        i++;
+        continue;
+      }
+      a = i;
+      while(i < len && !(i < old && t->text[i] == t->shown[i])) i++;
+      ui_text_run(t, a, i - a);
+      ops++;
+    }
+  }
+
+  if(old > len) {
+    ui_be->fill(t->x + len * cw, t->y, t->x + old * cw - 1, t->y + t->size - 1, t->bg);
+    ops++;
+  }
+
+  memcpy(t->shown, t->text, len);
+  t->shown[len] = '\0';
+  t->shown_color = t->color;
+  return ops;
+}
+
+/* 整个重画按钮 */
+static uint16_t ui_button_flush(const ui_button_t *b)
+{
+  uint16_t bg = b->selected ? b->highlight : b->color;
+  uint16_t len = (uint16_t)strlen(b->text);
+  uint16_t tx = b->x + (b->width - len * 8) / 2;
+  uint16_t ty = b->y + (b->height - 16) / 2;
+
+  ui_be->fill(b->x, b->y, b->x + b->width, b->y + b->height, bg);
+  ui_be->rect(b->x, b->y, b->x + b->width, b->y + b->height, b->border);
+  ui_be->text(tx, ty, b->width, 16, b->text, b->selected ? b->highlight_text : b->text_color, bg);
+  return 3;
+}
+
+/**
+ * @brief       重画有变化的元素, 在每一帧(或每次修改界面)之后调用
+ * @retval      调用绘制接口的次数, 0表示没有变化
+ */
+uint16_t ui_flush(void)
+{
+  uint16_t ops = 0;
+  uint8_t i;
+
+  if(ui_be == NULL) return 0;
+
+  for(i = 0; i < ui_button_count; i++) {
+    if(ui_buttons[i]->flags & UI_DIRTY) {
+      ops += ui_button_flush(ui_buttons[i]);
+      ui_buttons[i]->flags = 0;
+    }
+  }
+  for(i = 0; i < ui_text_count; i++) {
+    if(ui_texts[i]->flags & UI_DIRTY) {
+      ops += ui_text_flush(ui_texts[i]);
+      ui_texts[i]->flags = 0;
+    }
+  }
+  return ops;
+}
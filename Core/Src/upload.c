@@ -0,0 +1,310 @@
+#include "upload.h"
+#include <stddef.h>
+
+/* 帧接收状态 */
+typedef enum {
+    UPL_HUNT0 = 0,              /* 找第一个同步字节 */
+    UPL_HUNT1,                  /* 找第二个同步字节 */
+    UPL_HEADER,                 /* 命令和长度 */
+    UPL_PAYLOAD,
+    UPL_CRC
+} upl_state_t;
+
+static upload_begin_fn upl_begin = NULL;
+static upload_end_fn upl_end = NULL;
+static upload_reply_fn upl_reply = NULL;
+
+static upl_state_t upl_state = UPL_HUNT0;
+static uint8_t upl_hdr[3];
+static uint8_t upl_payload[UPLOAD_MAX_PAYLOAD];
+static uint16_t upl_pos = 0;            /* 当前字段已收到的字节数 */
+static uint16_t upl_len = 0;            /* 数据长度 */
+static uint16_t upl_crc = 0xFFFF;       /* 从命令字节开始累计的CRC */
+static uint16_t upl_crc_rx = 0;
+static uint32_t upl_errors = 0;
+
+/* 正在上传的表 */
+static uint16_t *upl_table = NULL;
+static uint16_t upl_total = 0;
+static uint16_t upl_received = 0;
+
+static void upload_byte(uint8_t b);
+
+/* 小端16位 */
+static uint16_t upl_get16(const uint8_t *p)
+{
+  return (uint16_t)(p[0] | ((uint16_t)p[1] << 8));
+}
+
+/**
+ * @brief       CRC16-CCITT, 多项式0x1021, 高位在前
+ * @param       crc : 初值, 第一段为0xFFFF, 分段计算时传入上一段的结果
+ * @param       data: 数据
+ * @param       n   : 字节数
+ * @retval      CRC
+ */
+uint16_t upload_crc16(uint16_t crc, const uint8_t *data, uint16_t n)
+{
+  uint8_t i;
+
+  while(n-- > 0) {
+    crc ^= (uint16_t)*data++ << 8;
+    for(i = 0; i < 8; i++) {
+      crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+    }
+  }
+  return crc;
+}
+
+/**
+ * @brief       设置上传的目标和回复函数, 并复位接收状态
+ * @param       begin: 开始上传时取得写入的表
+ * @param       end  : 提交或放弃
+ * @param       reply: 每帧的回复
+ */
+void upload_init(upload_begin_fn begin, upload_end_fn end, upload_reply_fn reply)
+{
+  upl_begin = begin;
+  upl_end = end;
+  upl_reply = reply;
+  upl_state = UPL_HUNT0;
+  upl_table = NULL;
+  upl_total = 0;
+  upl_received = 0;
+  upl_errors = 0;
+}
+
+/* 放弃正在进行的上传, 表交还发生器 */
+void upload_abort(void)
+{
+  if(upl_table != NULL) {
+    upl_table = NULL;
+    if(upl_end != NULL) upl_end(0);
+  }
+  upl_received = 0;
+}
+
+static void upl_send(uint8_t cmd, upload_status_t status, uint16_t value)
+{
+  if(status != UPLOAD_OK) upl_errors++;
+  if(upl_reply != NULL) upl_reply(cmd, status, value);
+}
+
+/* 开始帧: 点数 */
+static void upl_cmd_begin(void)
+{
+  uint16_t points;
+
+  if(upl_len != 2) {
+    upl_send('B', UPLOAD_ERR_FORMAT, 0);
+    return;
+  }
+  points = upl_get16(upl_payload);
+  upload_abort();
+  if(points == 0 || (points & 1) || upl_begin == NULL || (upl_table = upl_begin(points)) == NULL) {
+    upl_send('B', UPLOAD_ERR_BUSY, 0);
+    return;
+  }
+  upl_total = points;
+  upl_received = 0;
+  upl_send('B', UPLOAD_OK, 0);
+}
+
+/* 数据帧: 起始点 + 点 */
+static void upl_cmd_data(void)
+{
+  uint16_t offset, n, i;
+
+  if(upl_len < 4 || (upl_len & 1)) {
+    upl_send('D', UPLOAD_ERR_FORMAT, upl_received);
+    return;
+  }
+  offset = upl_get16(upl_payload);
+  n = (upl_len - 2) / 2;
+  if(upl_table == NULL || offset > upl_received) {
+    upl_send('D', UPLOAD_ERR_SEQ, upl_received);
+    return;
+  }
+  if((uint32_t)offset + n > upl_total) {
+    upl_send('D', UPLOAD_ERR_RANGE, upl_received);
+    return;
+  }
+  for(i = 0; i < n; i++) {
+    if(upl_get16(&upl_payload[2 + i * 2]) > UPLOAD_MAX_VALUE) {
+      upl_send('D', UPLOAD_ERR_RANGE, upl_received);
+      return;
+    }
+  }
+  for(i = 0; i < n; i++) {
+    upl_table[offset + i] = upl_get16(&upl_payload[2 + i * 2]);
+  }
+  if(offset + n > upl_received) upl_received = offset + n;
+  upl_send('D', UPLOAD_OK, upl_received);
+}
+
+/* 结束帧: 整表CRC, 通过后提交 */
+static void upl_cmd_end(void)
+{
+  uint16_t crc = 0xFFFF;
+  uint16_t i;
+
+  if(upl_len != 2) {
+    upl_send('E', UPLOAD_ERR_FORMAT, upl_received);
+    return;
+  }
+  if(upl_table == NULL) {
+    upl_send('E', UPLOAD_ERR_SEQ, 0);
+    return;
+  }
+  if(upl_received != upl_total) {
+    upl_send('E', UPLOAD_ERR_VERIFY, upl_received);
+    return;
+  }
+  for(i = 0; i < upl_total; i++) {
+    uint8_t b[2];
+    b[0] = (uint8_t)upl_table[i];
+    b[1] = (uint8_t)(upl_table[i] >> 8);
+    crc = upload_crc16(crc, b, 2);
+  }
+  if(crc != upl_get16(upl_payload)) {
+    upl_received = 0;             /* 整表重发 */
+    upl_send('E', UPLOAD_ERR_VERIFY, 0);
+    return;
+  }
+
+  upl_table = NULL;
+  if(upl_end == NULL || !upl_end(upl_total)) {
+    upl_send('E', UPLOAD_ERR_BUSY, 0);
+    return;
+  }
+  upl_send('E', UPLOAD_OK, upl_total);
+}
+
+/* 一个完整且CRC正确的帧 */
+static void upl_frame(void)
+{
+  switch(upl_hdr[0]) {
+    case 'B': upl_cmd_begin(); break;
+    case 'D': upl_cmd_data(); break;
+    case 'E': upl_cmd_end(); break;
+    case 'A':
+      upload_abort();
+      upl_send('A', UPLOAD_OK, 0);
+      break;
+    default: break;
+  }
+}
+
+/* 帧头不合理: 同步字节是数据中的巧合, 从帧头的第一个字节起重新找同步字节 */
+static void upl_resync(void)
+{
+  uint8_t hdr[3] = { upl_hdr[0], upl_hdr[1], upl_hdr[2] };
+  uint8_t i;
+
+  upl_state = UPL_HUNT0;
+  for(i = 0; i < 3; i++) {
+    upload_byte(hdr[i]);
+  }
+}
+
+static void upload_byte(uint8_t b)
+{
+  switch(upl_state) {
+    case UPL_HUNT0:
+      if(b == UPLOAD_SYNC0) upl_state = UPL_HUNT1;
+      break;
+
+    case UPL_HUNT1:
+      if(b == UPLOAD_SYNC1) {
+        upl_state = UPL_HEADER;
+        upl_pos = 0;
+        upl_crc = 0xFFFF;
+      } else if(b != UPLOAD_SYNC0) {
+        upl_state = UPL_HUNT0;
+      }
+      break;
+
+    case UPL_HEADER:
+      upl_hdr[upl_pos++] = b;
+      if(upl_pos < 3) break;
+      upl_len = upl_get16(&upl_hdr[1]);
+      if(upl_len > UPLOAD_MAX_PAYLOAD ||
+         (upl_hdr[0] != 'B' && upl_hdr[0] != 'D' && upl_hdr[0] != 'E' && upl_hdr[0] != 'A')) {
+        upl_errors++;
+        upl_resync();
+        break;
+      }
+      upl_crc = upload_crc16(upl_crc, upl_hdr, 3);
+      upl_pos = 0;
+      upl_state = (upl_len > 0) ? UPL_PAYLOAD : UPL_CRC;
+      break;
+
+    case UPL_PAYLOAD:
+      upl_payload[upl_pos++] = b;
+      if(upl_pos >= upl_len) {
+        upl_crc = upload_crc16(upl_crc, upl_payload, upl_len);
+        upl_pos = 0;
+        upl_state = UPL_CRC;
+      }
+      break;
+
+    case UPL_CRC:
+      if(upl_pos++ == 0) {
+        upl_crc_rx = b;
+        break;
+      }
+      upl_crc_rx |= (uint16_t)b << 8;
+      upl_state = UPL_HUNT0;
+      if(upl_crc_rx != upl_crc) {
+        upl_send(upl_hdr[0], UPLOAD_ERR_CRC, upl_received);
+      } else {
+        upl_frame();
+      }
+      break;
+  }
+}
+
+/**
+ * @brief       处理接收到的字节, 在主循环中调用
+ *   @note      数据可以任意分段, 帧可以跨越两次调用. 同步字节之前的字节和帧头不合理的帧被丢弃.
+ * @param       data: 数据
+ * @param       n   : 字节数
+ */
+void upload_feed(const uint8_t *data, uint16_t n)
+{
+  while(n-- > 0) {
+    upload_byte(*data++);
+  }
+}
+
+/* 是否有上传正在进行 */
+uint8_t upload_active(void)
+{
+  return upl_table != NULL;
+}
+
+/* 已连续收到的点数 */
+uint16_t upload_received(void)
+{
+  return upl_received;
+}
+
+/* 本次上传的点数 */
+uint16_t upload_total(void)
+{
+  return upl_total;
+}
+
+/* 出错的帧数 */
+uint32_t upload_frame_errors(void)
+{
+  return upl_errors;
+}
+
+const char *upload_status_name(upload_status_t status)
+{
+  static const char *const names[UPLOAD_STATUS_COUNT] = {
+    "OK", "CRC", "FORMAT", "SEQ", "RANGE", "BUSY", "VERIFY"
+  };
+  return (status < UPLOAD_STATUS_COUNT) ? names[status] : "?";
+}
@@ -21,10 +21,13 @@
 #include "usart.h"
 
 /* USER CODE BEGIN 0 */
-
+/* 接收环形缓冲, DMA循环写入, 主循环按DMA剩余计数读取 */
+static uint8_t usart_rx_buf[USART_RX_BUF_SIZE];
+static volatile uint16_t usart_rx_tail = 0;
 /* USER CODE END 0 */
 
 UART_HandleTypeDef huart1;
+DMA_HandleTypeDef hdma_usart1_rx;
 
 /* USART1 init function */
 
@@ -83,6 +86,26 @@ void HAL_UART_MspInit(UART_HandleTypeDef* uartHandle)
     GPIO_InitStruct.Pull = GPIO_NOPULL;
     HAL_GPIO_Init(GPIOA, &GPIO_InitStruct);
 
+    /* USART1 DMA Init */
+    /* USART1_RX Init */
+    hdma_usart1_rx.Instance = DMA1_Channel5;
+    hdma_usart1_rx.Init.Direction = DMA_PERIPH_TO_MEMORY;
+    hdma_usart1_rx.Init.PeriphInc = DMA_PINC_DISABLE;
+    hdma_usart1_rx.Init.MemInc = DMA_MINC_ENABLE;
+    hdma_usart1_rx.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+    hdma_usart1_rx.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
+    hdma_usart1_rx.Init.Mode = DMA_CIRCULAR;
+    hdma_usart1_rx.Init.Priority = DMA_PRIORITY_LOW;
+    if (HAL_DMA_Init(&hdma_usart1_rx) != HAL_OK)
+    {
+      Error_Handler();
+    }
+
+    __HAL_LINKDMA(uartHandle,hdmarx,hdma_usart1_rx);
+
+    /* USART1 interrupt Init */
+    HAL_NVIC_SetPriority(USART1_IRQn, 3, 0);
+    HAL_NVIC_EnableIRQ(USART1_IRQn);
   /* USER CODE BEGIN USART1_MspInit 1 */
 
   /* USER CODE END USART1_MspInit 1 */
@@ -106,6 +129,11 @@ void HAL_UART_MspDeInit(UART_HandleTypeDef* uartHandle)
     */
     HAL_GPIO_DeInit(GPIOA, GPIO_PIN_9|GPIO_PIN_10);
 
+    /* USART1 DMA DeInit */
+    HAL_DMA_DeInit(uartHandle->hdmarx);
+
+    /* USART1 interrupt Deinit */
+    HAL_NVIC_DisableIRQ(USART1_IRQn);
   /* USER CODE BEGIN USART1_MspDeInit 1 */
 
   /* USER CODE END USART1_MspDeInit 1 */
@@ -114,4 +142,45 @@ void HAL_UART_MspDeInit(UART_HandleTypeDef* uartHandle)
 
 /* USER CODE BEGIN 1 */
 
+/**
+ * @brief       启动USART1的DMA循环接收
+ *   @note      接收不需要CPU参与, 主循环用usart_rx_get()取出新数据. 缓冲可容纳约44ms的数据(115200bps),
+ *              上位机每帧等待回复, 不会溢出.
+ */
+void usart_rx_start(void)
+{
+  usart_rx_tail = 0;
+  HAL_UART_Receive_DMA(&huart1, usart_rx_buf, USART_RX_BUF_SIZE);
+}
+
+/**
+ * @brief       取出DMA已写入的新数据
+ *   @note      返回环形缓冲中连续的一段, 跨过缓冲末尾的数据在下一次调用时返回
+ * @param       data: 输出, 数据起始地址
+ * @retval      字节数, 0为没有新数据
+ */
+uint16_t usart_rx_get(const uint8_t **data)
+{
+  uint16_t head = USART_RX_BUF_SIZE - __HAL_DMA_GET_COUNTER(&hdma_usart1_rx);
+  uint16_t tail = usart_rx_tail;
+  uint16_t n;
+
+  if(head >= USART_RX_BUF_SIZE) head = 0;
+  if(head == tail) return 0;
+
+  n = (head > tail) ? (head - tail) : (USART_RX_BUF_SIZE - tail);
+  *data = &usart_rx_buf[tail];
+  usart_rx_tail = (tail + n) % USART_RX_BUF_SIZE;
+  return n;
+}
+
+/* 帧错误, 噪声或溢出时HAL停止了DMA接收, 重新启动. 丢失的数据由上位机重发 */
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart)
+{
+  if(huart->Instance == USART1)
+  {
+    usart_rx_start();
+  }
+}
+
 /* USER CODE END 1 */
@@ -31,6 +31,7 @@
 
 
 #include "stdlib.h"
+#include "string.h"
 #include "lcd.h"
 #include "lcdfont.h"
 #include "usart.h"
@@ -43,6 +44,8 @@
  * ļٰ.cļ!!ᱨ!)
  */
 #include "lcd_ex.c"
+/* lcd_line.cŻִ߲, ͬͨincludeʽ */
+#include "lcd_line.c"
 
 
 
@@ -55,6 +58,17 @@ uint32_t g_back_color  = 0XFFFF;    /* 
 /* LCDҪ */
 _lcd_dev lcddev;
 
+/* DMA: LCD_RAMDMAд, LCD(дĴſʼ)ȴ */
+static DMA_HandleTypeDef g_lcd_dma_handle;
+static volatile uint8_t g_lcd_dma_busy = 0;
+static uint16_t g_lcd_dma_color;            /* ɫԴ */
+static const uint16_t *g_lcd_dma_src;       /* һεԴַ */
+static uint32_t g_lcd_dma_left;             /* δĵ */
+static lcd_dma_done_fn g_lcd_dma_done;
+
+static void lcd_dma_xfer_cplt(DMA_HandleTypeDef *hdma);
+static void lcd_dma_xfer_error(DMA_HandleTypeDef *hdma);
+
 /**
  * @brief       LCDд
  * @param       data: Ҫд
@@ -73,6 +87,8 @@ void lcd_wr_data(volatile uint16_t data)
  */
 void lcd_wr_regno(volatile uint16_t regno)
 {
+    while (g_lcd_dma_busy); /* ȴDMA */
+
     regno = regno;          /* ʹ-O2Żʱ,ʱ */
     LCD->LCD_REG = regno;   /* дҪдļĴ */
 }
@@ -85,6 +101,8 @@ void lcd_wr_regno(volatile uint16_t regno)
  */
 void lcd_write_reg(uint16_t regno, uint16_t data)
 {
+    while (g_lcd_dma_busy); /* ȴDMA */
+
     LCD->LCD_REG = regno;   /* дҪдļĴ */
     LCD->LCD_RAM = data;    /* д */
 }
@@ -729,131 +747,267 @@ void lcd_init(void)
 
     lcd_display_dir(0); /* ĬΪ */
     LCD_BL(1);          /*  */
+    lcd_dma_init();
     lcd_clear(WHITE);
 }
 
 /**
- * @brief       
- * @param       color: Ҫɫ
+ * @brief       ʼLCDõDMA
+ *   @note      洢洢ģʽ: ΪԴ(, ɫʱ), 洢ΪLCD_RAM(, )
+ * @param       
  * @retval      
  */
-void lcd_clear(uint16_t color)
+void lcd_dma_init(void)
 {
-    uint32_t index = 0;
-    uint32_t totalpoint = lcddev.width;
-    totalpoint *= lcddev.height;    /* õܵ */
-    lcd_set_cursor(0x00, 0x0000);   /* ùλ */
-    lcd_write_ram_prepare();        /* ʼдGRAM */
+    LCD_DMA_CLK_ENABLE();
+
+    g_lcd_dma_handle.Instance = LCD_DMA_CHX;
+    g_lcd_dma_handle.Init.Direction = DMA_MEMORY_TO_MEMORY;
+    g_lcd_dma_handle.Init.PeriphInc = DMA_PINC_DISABLE;
+    g_lcd_dma_handle.Init.MemInc = DMA_MINC_DISABLE;
+    g_lcd_dma_handle.Init.PeriphDataAlignment = DMA_PDATAALIGN_HALFWORD;
+    g_lcd_dma_handle.Init.MemDataAlignment = DMA_MDATAALIGN_HALFWORD;
+    g_lcd_dma_handle.Init.Mode = DMA_NORMAL;
+    g_lcd_dma_handle.Init.Priority = DMA_PRIORITY_LOW;
+    HAL_DMA_Init(&g_lcd_dma_handle);
+
+    g_lcd_dma_handle.XferCpltCallback = lcd_dma_xfer_cplt;
+    g_lcd_dma_handle.XferErrorCallback = lcd_dma_xfer_error;
+
+    HAL_NVIC_SetPriority(LCD_DMA_IRQn, 3, 0);
+    HAL_NVIC_EnableIRQ(LCD_DMA_IRQn);
+}
 
-    for (index = 0; index < totalpoint; index++)
-    {
-        LCD->LCD_RAM = color;
-   }
+/**
+ * @brief       LCDDMAжϷ
+ * @param       
+ * @retval      
+ */
+void LCD_DMA_IRQHandler(void)
+{
+    HAL_DMA_IRQHandler(&g_lcd_dma_handle);
 }
 
 /**
- * @brief       ָ䵥ɫ
- * @param       (sx,sy),(ex,ey):ζԽ,СΪ:(ex - sx + 1) * (ey - sy + 1)
- * @param       color:Ҫɫ(32λɫ,LTDC)
+ * @brief       һDMA, ÿLCD_DMA_MAX_XFER
+ * @param       
  * @retval      
  */
-void lcd_fill(uint16_t sx, uint16_t sy, uint16_t ex, uint16_t ey, uint32_t color)
+static void lcd_dma_next(void)
 {
-    uint16_t i, j;
-    uint16_t xlen = 0;
-    xlen = ex - sx + 1;
+    uint16_t n = (g_lcd_dma_left > LCD_DMA_MAX_XFER) ? LCD_DMA_MAX_XFER : g_lcd_dma_left;
 
-    for (i = sy; i <= ey; i++)
-    {
-        lcd_set_cursor(sx, i);      /* ùλ */
-        lcd_write_ram_prepare();    /* ʼдGRAM */
+    g_lcd_dma_left -= n;
+    HAL_DMA_Start_IT(&g_lcd_dma_handle, (uint32_t)g_lcd_dma_src, (uint32_t)&LCD->LCD_RAM, n);
 
-        for (j = 0; j < xlen; j++)
-        {
-            LCD->LCD_RAM = color;   /* ʾɫ */
-        }
+    if (g_lcd_dma_handle.Init.PeriphInc == DMA_PINC_ENABLE)
+    {
+        g_lcd_dma_src += n;
     }
 }
 
 /**
- * @brief       ָָɫ
- * @param       (sx,sy),(ex,ey):ζԽ,СΪ:(ex - sx + 1) * (ey - sy + 1)
- * @param       color: Ҫɫ׵ַ
+ * @brief       : ָȫ, ɻص
+ * @param       
  * @retval      
  */
-void lcd_color_fill(uint16_t sx, uint16_t sy, uint16_t ex, uint16_t ey, uint16_t *color)
+static void lcd_dma_finish(void)
 {
-    uint16_t height, width;
-    uint16_t i, j;
-    width = ex - sx + 1;            /* õĿ */
-    height = ey - sy + 1;           /* ߶ */
+    lcd_dma_done_fn done = g_lcd_dma_done;
 
-    for (i = 0; i < height; i++)
-    {
-        lcd_set_cursor(sx, sy + i); /* ùλ */
-        lcd_write_ram_prepare();    /* ʼдGRAM */
+    g_lcd_dma_done = NULL;
+    g_lcd_dma_busy = 0;
+    lcd_set_window(0, 0, lcddev.width, lcddev.height);
 
-        for (j = 0; j < width; j++)
-        {
-            LCD->LCD_RAM = color[i * width + j]; /* д */
-        }
+    if (done != NULL)
+    {
+        done();
     }
 }
 
 /**
- * @brief       
- * @param       x1,y1: 
- * @param       x2,y2: յ
- * @param       color: ߵɫ
+ * @brief       DMAɻص: ʣʱŴһ, GRAMַڴ
+ * @param       hdma: DMA
  * @retval      
  */
-void lcd_draw_line(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint16_t color)
+static void lcd_dma_xfer_cplt(DMA_HandleTypeDef *hdma)
 {
-    uint16_t t;
-    int xerr = 0, yerr = 0, delta_x, delta_y, distance;
-    int incx, incy, row, col;
-    delta_x = x2 - x1;          /*  */
-    delta_y = y2 - y1;
-    row = x1;
-    col = y1;
-
-    if (delta_x > 0)incx = 1;   /* õ */
-    else if (delta_x == 0)incx = 0; /* ֱ */
-    else
-    {
-        incx = -1;
-        delta_x = -delta_x;
-    }
+    (void)hdma;
 
-    if (delta_y > 0)incy = 1;
-    else if (delta_y == 0)incy = 0; /* ˮƽ */
-    else
+    if (g_lcd_dma_left > 0)
     {
-        incy = -1;
-        delta_y = -delta_y;
+        lcd_dma_next();
+        return;
     }
 
-    if ( delta_x > delta_y)distance = delta_x;  /* ѡȡ */
-    else distance = delta_y;
+    lcd_dma_finish();
+}
 
-    for (t = 0; t <= distance + 1; t++ )   /*  */
-    {
-        lcd_draw_point(row, col, color); /*  */
-        xerr += delta_x ;
-        yerr += delta_y ;
+/**
+ * @brief       DMAص: ʣಿ
+ * @param       hdma: DMA
+ * @retval      
+ */
+static void lcd_dma_xfer_error(DMA_HandleTypeDef *hdma)
+{
+    (void)hdma;
+    g_lcd_dma_left = 0;
+    lcd_dma_finish();
+}
+
+/**
+ * @brief       DMAǷ
+ * @param       
+ * @retval      1, ; 0, 
+ */
+uint8_t lcd_dma_busy(void)
+{
+    return g_lcd_dma_busy;
+}
+
+/**
+ * @brief       ȴDMA
+ *   @note      һ㲻Ҫ: LCDдĴǰԶȴ.
+ *              ֻҪдڴԴʱҪȵȴ.
+ * @param       
+ * @retval      
+ */
+void lcd_dma_wait(void)
+{
+    while (g_lcd_dma_busy);
+}
+
+/**
+ * @brief       , ʱֱCPUд
+ * @param       (sx,sy),(ex,ey): ζԽ
+ * @param       src  : Դ
+ * @param       inc  : 1, Դַ(ɫ); 0, Դ̶ַ(ɫ)
+ * @param       done : ɻص, ΪNULL
+ * @retval      
+ */
+static void lcd_dma_start(uint16_t sx, uint16_t sy, uint16_t ex, uint16_t ey,
+                          const uint16_t *src, uint8_t inc, lcd_dma_done_fn done)
+{
+    uint32_t n = (uint32_t)(ex - sx + 1) * (ey - sy + 1);
 
-        if (xerr > distance)
+    lcd_set_window(sx, sy, ex - sx + 1, ey - sy + 1);
+    lcd_write_ram_prepare();        /* ʼдGRAM */
+
+    if (n < LCD_DMA_MIN_PIXELS)
+    {
+        while (n--)
         {
-            xerr -= distance;
-            row += incx;
+            LCD->LCD_RAM = *src;
+            src += inc;
         }
 
-        if (yerr > distance)
+        lcd_set_window(0, 0, lcddev.width, lcddev.height);
+
+        if (done != NULL)
         {
-            yerr -= distance;
-            col += incy;
+            done();
         }
+
+        return;
+    }
+
+    g_lcd_dma_handle.Init.PeriphInc = inc ? DMA_PINC_ENABLE : DMA_PINC_DISABLE;
+    HAL_DMA_Init(&g_lcd_dma_handle);
+
+    g_lcd_dma_src = src;
+    g_lcd_dma_left = n;
+    g_lcd_dma_done = done;
+    g_lcd_dma_busy = 1;
+    lcd_dma_next();
+}
+
+/**
+ * @brief       DMAɫ, 
+ *   @note      ڼCPULCD޹صĹ, һLCDԶȴ.
+ * @param       (sx,sy),(ex,ey): ζԽ,СΪ:(ex - sx + 1) * (ey - sy + 1)
+ * @param       color: Ҫɫ
+ * @param       done : ɻص(DMAже), ΪNULL
+ * @retval      
+ */
+void lcd_dma_fill(uint16_t sx, uint16_t sy, uint16_t ex, uint16_t ey, uint16_t color, lcd_dma_done_fn done)
+{
+    lcd_dma_wait();                 /* Դһʹ */
+    g_lcd_dma_color = color;
+    lcd_dma_start(sx, sy, ex, ey, &g_lcd_dma_color, 0, done);
+}
+
+/**
+ * @brief       DMAɫд, 
+ *   @note      ɫɻص֮ǰ(lcd_dma_wait֮ǰ)뱣ЧҲд.
+ * @param       (sx,sy),(ex,ey): ζԽ,СΪ:(ex - sx + 1) * (ey - sy + 1)
+ * @param       color: ɫ׵ַ, д
+ * @param       done : ɻص(DMAже), ΪNULL
+ * @retval      
+ */
+void lcd_dma_color_fill(uint16_t sx, uint16_t sy, uint16_t ex, uint16_t ey, const uint16_t *color, lcd_dma_done_fn done)
+{
+    lcd_dma_start(sx, sy, ex, ey, color, 1, done);
+}
+
+/**
+ * @brief       
+ *   @note      DMA, 
+ * @param       color: Ҫɫ
+ * @retval      
+ */
+void lcd_clear(uint16_t color)
+{
+    lcd_dma_fill(0, 0, lcddev.width - 1, lcddev.height - 1, color, NULL);
+}
+
+/**
+ * @brief       ָ䵥ɫ
+ *   @note      DMA, 
+ * @param       (sx,sy),(ex,ey):ζԽ,СΪ:(ex - sx + 1) * (ey - sy + 1)
+ * @param       color:Ҫɫ(32λɫ,LTDC)
+ * @retval      
+ */
+void lcd_fill(uint16_t sx, uint16_t sy, uint16_t ex, uint16_t ey, uint32_t color)
+{
+    lcd_dma_fill(sx, sy, ex, ey, (uint16_t)color, NULL);
+}
+
+/**
+ * @brief       ָָɫ
+ *   @note      DMA; ɫڵ, ȴŷ
+ * @param       (sx,sy),(ex,ey):ζԽ,СΪ:(ex - sx + 1) * (ey - sy + 1)
+ * @param       color: Ҫɫ׵ַ
+ * @retval      
+ */
+void lcd_color_fill(uint16_t sx, uint16_t sy, uint16_t ex, uint16_t ey, uint16_t *color)
+{
+    lcd_dma_color_fill(sx, sy, ex, ey, color, NULL);
+    lcd_dma_wait();
+}
+
+/**
+ * @brief       ָдɫ
+ *   @note      ֻһδںһдGRAM, ֮ȫ, ʺлˢ.
+ *              ݰɨ跽(ĬL2R_U2DΪ), Ϊ1ʱһдϵ.
+ *              д󴰿ڻָΪȫ, ӰֻùĻ/亯.
+ * @param       sx,sy       : ʼ(Ͻ)
+ * @param       width,height: ڿȺ͸߶, 0
+ * @param       color       : ɫ׵ַ, width * height
+ * @retval      
+ */
+void lcd_color_burst(uint16_t sx, uint16_t sy, uint16_t width, uint16_t height, const uint16_t *color)
+{
+    uint32_t n = (uint32_t)width * height;
+
+    lcd_set_window(sx, sy, width, height);
+    lcd_write_ram_prepare();        /* ʼдGRAM */
+
+    while (n--)
+    {
+        LCD->LCD_RAM = *color++;
     }
+
+    lcd_set_window(0, 0, lcddev.width, lcddev.height);
 }
 
 /**
@@ -961,46 +1115,147 @@ void lcd_fill_circle(uint16_t x, uint16_t y, uint16_t r, uint16_t color)
     }
 }
 
+/* : չΪRGB565󿪴д.
+ * ַлкϳ, 黺彻ʹ: һDMAдʱһкϳһ.
+ * DMAͬһʱֻһ, ҿʼ´ǰȴһ, ںϳɵĻ岻ᱻDMAȡ.
+ */
+static uint16_t g_text_buf[2][LCD_TEXT_BUF_PIXELS];
+static uint8_t g_text_buf_sel = 0;
+
+#if LCD_GLYPH_CACHE_SLOTS > 0
+/* λ: (ַ, ֺ, ǰɫ, ɫ), Ժ滻 */
+typedef struct
+{
+    char chr;                   /* 0Ϊ */
+    uint8_t size;
+    uint16_t fg;
+    uint16_t bg;
+    uint16_t pix[(LCD_GLYPH_CACHE_MAX_SIZE / 2) * LCD_GLYPH_CACHE_MAX_SIZE];
+} lcd_glyph_slot_t;
+
+static lcd_glyph_slot_t g_glyph_cache[LCD_GLYPH_CACHE_SLOTS];
+static uint8_t g_glyph_next = 0;
+#endif
+
 /**
- * @brief       ָλʾһַ
- * @param       x,y  : 
- * @param       chr  : Ҫʾַ:" "--->"~"
+ * @brief       ȡַĵ
+ * @param       chr  : ַ, ' '~'~'
  * @param       size : С 12/16/24/32
- * @param       mode : ӷʽ(1); ǵӷʽ(0);
- * @param       color : ַɫ;
- * @retval      
+ * @retval      ׵ַ, ֵַֺ֧ŷNULL
  */
-void lcd_show_char(uint16_t x, uint16_t y, char chr, uint8_t size, uint8_t mode, uint16_t color)
+static const uint8_t *lcd_font_glyph(char chr, uint8_t size)
 {
-    uint8_t temp, t1, t;
-    uint16_t y0 = y;
-    uint8_t csize = 0;
-    uint8_t *pfont = 0;
+    if (chr < ' ' || chr > '~') return NULL;
 
-    csize = (size / 8 + ((size % 8) ? 1 : 0)) * (size / 2); /* õһַӦռֽ */
-    chr = chr - ' ';    /* õƫƺֵASCIIֿǴӿոʼȡģ-' 'ǶӦַֿ⣩ */
+    chr = chr - ' ';    /* ASCIIֿǴӿոʼȡģ */
 
     switch (size)
     {
         case 12:
-            pfont = (uint8_t *)asc2_1206[(uint8_t)chr];  /* 1206 */
-            break;
+            return asc2_1206[(uint8_t)chr];
 
         case 16:
-            pfont = (uint8_t *)asc2_1608[(uint8_t)chr];  /* 1608 */
-            break;
+            return asc2_1608[(uint8_t)chr];
 
         case 24:
-            pfont = (uint8_t *)asc2_2412[(uint8_t)chr];  /* 2412 */
-            break;
+            return asc2_2412[(uint8_t)chr];
 
         case 32:
-            pfont = (uint8_t *)asc2_3216[(uint8_t)chr];  /* 3216 */
-            break;
+            return asc2_3216[(uint8_t)chr];
 
         default:
-            return ;
+            return NULL;
+    }
+}
+
+/**
+ * @brief       һչΪRGB565, д
+ *   @note      ֿⰴȡģ: ÿsize, ռ(size + 7) / 8ֽ, λ.
+ * @param       dst   : Ŀ, rowеcoldst[row * stride + col]
+ * @param       stride: Ŀÿеĵ
+ * @param       pfont : 
+ * @param       size  : С, Ϊ(size / 2) * size
+ * @param       fg,bg : ǰɫ, ɫ
+ * @retval      
+ */
+static void lcd_glyph_expand(uint16_t *dst, uint16_t stride, const uint8_t *pfont, uint8_t size, uint16_t fg, uint16_t bg)
+{
+    uint8_t bpc = (size + 7) / 8;   /* ÿֽ */
+    uint8_t col, row;
+
+    for (col = 0; col < size / 2; col++)
+    {
+        const uint8_t *p = pfont + col * bpc;
+        uint16_t *d = dst + col;
+
+        for (row = 0; row < size; row++)
+        {
+            *d = (p[row >> 3] & (0x80 >> (row & 7))) ? fg : bg;
+            d += stride;
+        }
+    }
+}
+
+/**
+ * @brief       ȡչ: ַӻȡ, չbuf
+ * @param       chr,size: ַС
+ * @param       fg,bg   : ǰɫ, ɫ
+ * @param       buf     : ڻʱչ, (size / 2) * size
+ * @retval      дŵ, ֵַ֧NULL
+ */
+static const uint16_t *lcd_glyph_get(char chr, uint8_t size, uint16_t fg, uint16_t bg, uint16_t *buf)
+{
+    const uint8_t *pfont = lcd_font_glyph(chr, size);
+
+    if (pfont == NULL) return NULL;
+
+#if LCD_GLYPH_CACHE_SLOTS > 0
+    if (size <= LCD_GLYPH_CACHE_MAX_SIZE && strchr(LCD_GLYPH_CACHE_CHARS, chr) != NULL)
+    {
+        lcd_glyph_slot_t *slot;
+        uint8_t i;
+
+        for (i = 0; i < LCD_GLYPH_CACHE_SLOTS; i++)
+        {
+            slot = &g_glyph_cache[i];
+
+            if (slot->chr == chr && slot->size == size && slot->fg == fg && slot->bg == bg)
+            {
+                return slot->pix;
+            }
+        }
+
+        lcd_dma_wait();             /* 滻οDMAд */
+        slot = &g_glyph_cache[g_glyph_next];
+        g_glyph_next = (g_glyph_next + 1) % LCD_GLYPH_CACHE_SLOTS;
+        slot->chr = chr;
+        slot->size = size;
+        slot->fg = fg;
+        slot->bg = bg;
+        lcd_glyph_expand(slot->pix, size / 2, pfont, size, fg, bg);
+        return slot->pix;
     }
+#endif
+
+    lcd_glyph_expand(buf, size / 2, pfont, size, fg, bg);
+    return buf;
+}
+
+/**
+ * @brief       ʾһַ(ӷʽ, ַĻʱ)
+ * @param       ͬlcd_show_char
+ * @retval      
+ */
+static void lcd_show_char_points(uint16_t x, uint16_t y, char chr, uint8_t size, uint8_t mode, uint16_t color)
+{
+    uint8_t temp, t1, t;
+    uint16_t y0 = y;
+    uint8_t csize = 0;
+    const uint8_t *pfont = lcd_font_glyph(chr, size);
+
+    if (pfont == NULL) return;
+
+    csize = (size / 8 + ((size % 8) ? 1 : 0)) * (size / 2); /* õһַӦռֽ */
 
     for (t = 0; t < csize; t++)
     {
@@ -1035,6 +1290,40 @@ void lcd_show_char(uint16_t x, uint16_t y, char chr, uint8_t size, uint8_t mode,
     }
 }
 
+/**
+ * @brief       ָλʾһַ
+ *   @note      ǵӷʽʱַ()һд; ӷʽֻ㻭.
+ * @param       x,y  : 
+ * @param       chr  : Ҫʾַ:" "--->"~"
+ * @param       size : С 12/16/24/32
+ * @param       mode : ӷʽ(1); ǵӷʽ(0);
+ * @param       color : ַɫ;
+ * @retval      
+ */
+void lcd_show_char(uint16_t x, uint16_t y, char chr, uint8_t size, uint8_t mode, uint16_t color)
+{
+    const uint16_t *pix;
+    uint16_t *buf;
+
+    if (mode != 0 || x + size / 2 > lcddev.width || y + size > lcddev.height)
+    {
+        lcd_show_char_points(x, y, chr, size, mode, color);
+        return;
+    }
+
+    buf = g_text_buf[g_text_buf_sel];
+    pix = lcd_glyph_get(chr, size, color, g_back_color, buf);
+
+    if (pix == NULL) return;
+
+    if (pix == buf)
+    {
+        g_text_buf_sel ^= 1;
+    }
+
+    lcd_dma_color_fill(x, y, x + size / 2 - 1, y + size - 1, pix, NULL);
+}
+
 /**
  * @brief       ƽ, m^n
  * @param       m: 
@@ -1136,6 +1425,8 @@ void lcd_show_xnum(uint16_t x, uint16_t y, uint32_t num, uint8_t len, uint8_t si
 
 /**
  * @brief       ʾַ
+ *   @note      ͬһַлкϳ, һ(LCD_TEXT_BUF_PIXELS)һд,
+ *              DMAдͬʱϳһ. ʱ.
  * @param       x,y         : ʼ
  * @param       width,height: С
  * @param       size        : ѡ 12/16/24/32
@@ -1145,23 +1436,71 @@ void lcd_show_xnum(uint16_t x, uint16_t y, uint32_t num, uint8_t len, uint8_t si
  */
 void lcd_show_string(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint8_t size, char *p, uint16_t color)
 {
-    uint8_t x0 = x;
+    uint16_t x0 = x;
+    uint16_t cw = size / 2;
+    uint16_t per_burst = LCD_TEXT_BUF_PIXELS / ((uint16_t)cw * size);   /* һַ */
+    uint16_t bg = g_back_color;
     width += x;
     height += y;
 
+    if (lcd_font_glyph(' ', size) == NULL) return;
+
     while ((*p <= '~') && (*p >= ' '))   /* жǲǷǷַ! */
     {
+        uint16_t *buf = g_text_buf[g_text_buf_sel];
+        uint16_t sx = x, n = 0, stride, row;
+        char *q;
+
         if (x >= width)
         {
             x = x0;
             y += size;
+            continue;
+        }
+
+        if (y >= height) break; /* ˳ */
+
+        if (x + cw > lcddev.width || y + size > lcddev.height)
+        {
+            lcd_show_char_points(x, y, *p, size, 0, color);     /* Ļַ㻭ʾĲ */
+            x += cw;
+            p++;
+            continue;
         }
 
-        if (y >= height)break;  /* ˳ */
+        /* ַ: ұ, Ļұ, ַΪֹ */
+        for (q = p; (*q <= '~') && (*q >= ' ') && n < per_burst && x < width && x + cw <= lcddev.width; q++)
+        {
+            n++;
+            x += cw;
+        }
+
+        stride = n * cw;
+
+        for (q = p; q < p + n; q++)
+        {
+            const uint16_t *pix;
+            uint16_t *dst = buf + (q - p) * cw;
+
+#if LCD_GLYPH_CACHE_SLOTS > 0
+            if (size <= LCD_GLYPH_CACHE_MAX_SIZE && strchr(LCD_GLYPH_CACHE_CHARS, *q) != NULL)
+            {
+                pix = lcd_glyph_get(*q, size, color, bg, NULL);
+
+                for (row = 0; row < size; row++)
+                {
+                    memcpy(dst + row * stride, pix + row * cw, cw * sizeof(uint16_t));
+                }
+
+                continue;
+            }
+#endif
+            lcd_glyph_expand(dst, stride, lcd_font_glyph(*q, size), size, color, bg);
+        }
 
-        lcd_show_char(x, y, *p, size, 0, color);
-        x += size / 2;
-        p++;
+        g_text_buf_sel ^= 1;
+        lcd_dma_color_fill(sx, y, sx + stride - 1, y + size - 1, buf, NULL);
+        p += n;
     }
 }
 
@@ -50,6 +50,39 @@
 #define LCD_FSMC_BTRX        FSMC_Bank1->BTCR[(LCD_FSMC_NEX - 1) * 2 + 1]   /* BTRĴ,LCD_FSMC_NEXԶ */
 #define LCD_FSMC_BWTRX       FSMC_Bank1E->BWTR[(LCD_FSMC_NEX - 1) * 2]      /* BWTRĴ,LCD_FSMC_NEXԶ */
 
+/******************************************************************************************/
+/* LCD DMA 
+ * DMAĴ洢洢ģʽдLCD_RAM: Դ̶ַ(ɫ)(ɫ), Ŀ̶ַ.
+ * ѡδռõDMA2ͨ1, ȼ, ӰADC/DACDMA.
+ */
+#define LCD_DMA_CHX             DMA2_Channel1
+#define LCD_DMA_IRQn            DMA2_Channel1_IRQn
+#define LCD_DMA_IRQHandler      DMA2_Channel1_IRQHandler
+#define LCD_DMA_CLK_ENABLE()    do{ __HAL_RCC_DMA2_CLK_ENABLE(); }while(0)
+
+#define LCD_DMA_MAX_XFER        65535       /* һDMA(CNDTRΪ16λ), Զֶ */
+#define LCD_DMA_MIN_PIXELS      64          /* ڴ˵ʱCPUֱд, ʡȥDMAĿ */
+
+/* DMAɻص, DMAже */
+typedef void (*lcd_dma_done_fn)(void);
+
+/* ʾռõRAM:
+ *   ַл 2 * LCD_TEXT_BUF_PIXELS * 2ֽ = 2KB, 16һ4ַ, 56ַϢз14д
+ *   λ LCD_GLYPH_CACHE_SLOTS * (8*16 * 2ֽ + 6ֽ) = 16 * 262ֽ, Լ4.1KB
+ * ϼԼ6.1KB. Ϊ0ȥλ, ֻʣ2KBл
+ */
+/* ַл(齻)ĵ, һ32(16*32) */
+#define LCD_TEXT_BUF_PIXELS     512
+
+#if LCD_TEXT_BUF_PIXELS < 16 * 32
+#error "LCD_TEXT_BUF_PIXELS must hold one size-32 glyph"
+#endif
+
+/* λ: ֺ͵λַչΪRGB565󱣴, ǰɫ/ɫ, Ϊ0ʱ */
+#define LCD_GLYPH_CACHE_SLOTS   16
+#define LCD_GLYPH_CACHE_MAX_SIZE 16         /* ֻ治16ŵ */
+#define LCD_GLYPH_CACHE_CHARS   "0123456789.-%HzV"
+
 /******************************************************************************************/
 
 /* LCDҪ */
@@ -192,13 +225,22 @@ uint32_t lcd_read_point(uint16_t x, uint16_t y);/* 
 void lcd_draw_point(uint16_t x, uint16_t y, uint32_t color);/* (32λɫ,LTDC) */
 
 void lcd_clear(uint16_t color);     /* LCD */
+void lcd_dma_init(void);            /* ʼLCDõDMA */
+void lcd_dma_fill(uint16_t sx, uint16_t sy, uint16_t ex, uint16_t ey, uint16_t color, lcd_dma_done_fn done);            /* DMAɫ(첽) */
+void lcd_dma_color_fill(uint16_t sx, uint16_t sy, uint16_t ex, uint16_t ey, const uint16_t *color, lcd_dma_done_fn done);/* DMAɫ(첽) */
+uint8_t lcd_dma_busy(void);         /* DMAǷ */
+void lcd_dma_wait(void);            /* ȴDMA */
 void lcd_fill_circle(uint16_t x, uint16_t y, uint16_t r, uint16_t color);                   /* ʵԲ */
 void lcd_draw_circle(uint16_t x0, uint16_t y0, uint8_t r, uint16_t color);                  /* Բ */
 void lcd_draw_hline(uint16_t x, uint16_t y, uint16_t len, uint16_t color);                  /* ˮƽ */
 void lcd_set_window(uint16_t sx, uint16_t sy, uint16_t width, uint16_t height);             /* ô */
 void lcd_fill(uint16_t sx, uint16_t sy, uint16_t ex, uint16_t ey, uint32_t color);          /* ɫ(32λɫ,LTDC) */
 void lcd_color_fill(uint16_t sx, uint16_t sy, uint16_t ex, uint16_t ey, uint16_t *color);   /* ɫ */
+void lcd_color_burst(uint16_t sx, uint16_t sy, uint16_t width, uint16_t height, const uint16_t *color); /* дɫ */
 void lcd_draw_line(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint16_t color);     /* ֱ */
+void lcd_draw_thick_line(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint8_t size, uint16_t color); /*  */
+void lcd_set_clip(uint16_t sx, uint16_t sy, uint16_t ex, uint16_t ey);                     /* ûߵĲü */
+void lcd_reset_clip(void);                                                                 /* ȡü */
 void lcd_draw_rectangle(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint16_t color);/*  */
 
 
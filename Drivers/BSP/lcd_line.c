@@ -0,0 +1,189 @@
+/**
+ ****************************************************************************************************
+ * @file        lcd_line.c
+ * @brief       lcd_line.cŻִ߲(ü, г̻ߺͻ), lcd_ex.cһֱӼ
+ *              , lcd.cͨincludeʽ.(Ҫļٰ.cļ!!ᱨ!)
+ *              (tests/mock_lcd_line.c)LCDģļĴ󵥶ⲿִ.
+ ****************************************************************************************************
+ */
+
+#include "lcd.h"
+
+
+/* ߵĲü, Ĭϲü(ֻĻС) */
+static uint16_t g_clip_sx = 0, g_clip_sy = 0, g_clip_ex = 0XFFFF, g_clip_ey = 0XFFFF;
+
+/**
+ * @brief       ûߵĲü, ֮lcd_draw_line/lcd_draw_thick_lineֻڵĲ
+ * @param       (sx,sy),(ex,ey): üζԽ(߽)
+ * @retval      
+ */
+void lcd_set_clip(uint16_t sx, uint16_t sy, uint16_t ex, uint16_t ey)
+{
+    g_clip_sx = sx;
+    g_clip_sy = sy;
+    g_clip_ex = ex;
+    g_clip_ey = ey;
+}
+
+/**
+ * @brief       ȡü
+ * @param       
+ * @retval      
+ */
+void lcd_reset_clip(void)
+{
+    lcd_set_clip(0, 0, 0XFFFF, 0XFFFF);
+}
+
+/**
+ * @brief       ɫһο, ȰüκĻü
+ *   @note      ֻһҴΪȫʱùд, ı䴰; 򿪴һд.
+ *              ڲָ, ɵڻпָȫ.
+ * @param       (x0,y0),(x1,y1): ζԽ, ԳĻΪ
+ * @param       color: ɫ
+ * @param       win  : ֮ǰĿǷѸı䴰(ֻ, ڲȫʱֻ)
+ * @retval      1, Ѹı; 0, δı
+ */
+static uint8_t lcd_fill_block(int x0, int y0, int x1, int y1, uint16_t color, uint8_t win)
+{
+    int ex = (g_clip_ex < lcddev.width) ? g_clip_ex : lcddev.width - 1;
+    int ey = (g_clip_ey < lcddev.height) ? g_clip_ey : lcddev.height - 1;
+    uint32_t n;
+
+    if (x0 < g_clip_sx) x0 = g_clip_sx;
+    if (y0 < g_clip_sy) y0 = g_clip_sy;
+    if (x1 > ex) x1 = ex;
+    if (y1 > ey) y1 = ey;
+
+    if (x0 > x1 || y0 > y1) return win; /* ڲü */
+
+    n = (uint32_t)(x1 - x0 + 1) * (y1 - y0 + 1);
+
+    if (y0 == y1 && !win)
+    {
+        lcd_set_cursor(x0, y0);         /* һ: lcd_fillͬ, д */
+        lcd_write_ram_prepare();
+    }
+    else
+    {
+        lcd_set_window(x0, y0, x1 - x0 + 1, y1 - y0 + 1);
+        lcd_write_ram_prepare();
+        win = 1;
+    }
+
+    while (n--)
+    {
+        LCD->LCD_RAM = color;
+    }
+
+    return win;
+}
+
+/**
+ * @brief       г̻: Bresenham㷨, η겻һغϳһг,
+ *              ÿг̼ϻʿȺΪһοһд
+ *   @note      ˮƽߺֱֻһг, һд. бС1߰ˮƽг,
+ *              ֱг. Ϊ߳2r+1.
+ * @param       x1,y1: 
+ * @param       x2,y2: յ
+ * @param       r    : ʰ, 0Ϊ1ؿ
+ * @param       color: ߵɫ
+ * @retval      
+ */
+static void lcd_draw_runs(int x1, int y1, int x2, int y2, int r, uint16_t color)
+{
+    int dx = (x2 > x1) ? x2 - x1 : x1 - x2;
+    int dy = (y2 > y1) ? y2 - y1 : y1 - y2;
+    int incx = (x2 > x1) ? 1 : -1;
+    int incy = (y2 > y1) ? 1 : -1;
+    int x = x1, y = y1, start, err;
+    uint8_t win = 0;
+
+    if (dx >= dy)       /* ˮƽг */
+    {
+        err = dx / 2;
+        start = x;
+
+        for (;;)
+        {
+            if (x == x2)
+            {
+                win = lcd_fill_block((start < x ? start : x) - r, y - r, (start < x ? x : start) + r, y + r, color, win);
+                break;
+            }
+
+            x += incx;
+            err -= dy;
+
+            if (err < 0)
+            {
+                int last = x - incx;
+                win = lcd_fill_block((start < last ? start : last) - r, y - r, (start < last ? last : start) + r, y + r, color, win);
+                y += incy;
+                err += dx;
+                start = x;
+            }
+        }
+    }
+    else                /* ֱг */
+    {
+        err = dy / 2;
+        start = y;
+
+        for (;;)
+        {
+            if (y == y2)
+            {
+                win = lcd_fill_block(x - r, (start < y ? start : y) - r, x + r, (start < y ? y : start) + r, color, win);
+                break;
+            }
+
+            y += incy;
+            err -= dx;
+
+            if (err < 0)
+            {
+                int last = y - incy;
+                win = lcd_fill_block(x - r, (start < last ? start : last) - r, x + r, (start < last ? last : start) + r, color, win);
+                x += incx;
+                err += dy;
+                start = y;
+            }
+        }
+    }
+
+    if (win)
+    {
+        lcd_set_window(0, 0, lcddev.width, lcddev.height);  /* ָȫ */
+    }
+}
+
+/**
+ * @brief       
+ *   @note      ˮƽ/ֱһд, б߷ֳˮƽֱг, ÿгһд.
+ *              ֻü(lcd_set_clip)ڵĲ.
+ * @param       x1,y1: 
+ * @param       x2,y2: յ
+ * @param       color: ߵɫ
+ * @retval      
+ */
+void lcd_draw_line(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint16_t color)
+{
+    lcd_draw_runs(x1, y1, x2, y2, 0, color);
+}
+
+/**
+ * @brief       
+ *   @note      Ϊsize*size(sizeΪżʱsize+1), ˸size/2.
+ *              ÿгͬʿΪһοһд, Ҫƽ.
+ * @param       x1,y1: 
+ * @param       x2,y2: յ
+ * @param       size : ߿()
+ * @param       color: ߵɫ
+ * @retval      
+ */
+void lcd_draw_thick_line(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint8_t size, uint16_t color)
+{
+    lcd_draw_runs(x1, y1, x2, y2, size / 2, color);
+}
@@ -0,0 +1,125 @@
+/* 主机测试用的LCD驱动替身, 实现显示模块用到的lcd.h函数 */
+#include "lcd.h"
+#include "mock_lcd.h"
+
+_lcd_dev lcddev = { MOCK_LCD_WIDTH, MOCK_LCD_HEIGHT, 0x5510, 0, 0x2C00, 0x2A00, 0x2B00 };
+uint32_t g_point_color = RED;
+uint32_t g_back_color = WHITE;
+
+/* 帧缓冲前面留一个寄存器位置, 使mock_lcd_reg()返回的LCD_RAM正好落在当前像素上 */
+static struct
+{
+  uint16_t reg;
+  uint16_t fb[MOCK_LCD_HEIGHT][MOCK_LCD_WIDTH];
+} mock_mem;
+
+uint16_t (*const mock_fb)[MOCK_LCD_WIDTH] = mock_mem.fb;
+uint32_t mock_fsmc_writes = 0;
+uint32_t mock_bursts = 0;
+
+/* 当前窗口和写入位置 */
+static uint16_t win_sx = 0, win_sy = 0, win_ex = MOCK_LCD_WIDTH - 1, win_ey = MOCK_LCD_HEIGHT - 1;
+static uint16_t cur_x = 0, cur_y = 0;
+
+/* 一次写GRAM: 返回当前像素的位置(屏幕外为NULL), 写入位置按窗口前进 */
+static uint16_t *mock_next(void)
+{
+  uint16_t *p = NULL;
+
+  if(cur_x < MOCK_LCD_WIDTH && cur_y < MOCK_LCD_HEIGHT) p = &mock_fb[cur_y][cur_x];
+  mock_fsmc_writes++;
+  if(++cur_x > win_ex) {
+    cur_x = win_sx;
+    if(++cur_y > win_ey) cur_y = win_sy;
+  }
+  return p;
+}
+
+static void mock_put(uint16_t color)
+{
+  uint16_t *p = mock_next();
+
+  if(p) *p = color;
+}
+
+LCD_TypeDef *mock_lcd_reg(void)
+{
+  static LCD_TypeDef off_screen;
+  uint16_t *p = mock_next();
+
+  return p ? (LCD_TypeDef *)(p - 1) : &off_screen;
+}
+
+void mock_lcd_clear(uint16_t color)
+{
+  uint32_t i;
+
+  for(i = 0; i < MOCK_LCD_WIDTH * MOCK_LCD_HEIGHT; i++) mock_fb[0][i] = color;
+}
+
+void lcd_set_cursor(uint16_t x, uint16_t y)
+{
+  cur_x = x;
+  cur_y = y;
+  mock_fsmc_writes += 8;
+}
+
+void lcd_write_ram_prepare(void)
+{
+  mock_fsmc_writes++;
+}
+
+void lcd_set_window(uint16_t sx, uint16_t sy, uint16_t width, uint16_t height)
+{
+  win_sx = sx;
+  win_sy = sy;
+  win_ex = sx + width - 1;
+  win_ey = sy + height - 1;
+  cur_x = sx;
+  cur_y = sy;
+  mock_fsmc_writes += 16;
+}
+
+void lcd_draw_point(uint16_t x, uint16_t y, uint32_t color)
+{
+  lcd_set_cursor(x, y);
+  lcd_write_ram_prepare();
+  mock_put((uint16_t)color);
+}
+
+void lcd_fill(uint16_t sx, uint16_t sy, uint16_t ex, uint16_t ey, uint32_t color)
+{
+  uint16_t x, y;
+
+  for(y = sy; y <= ey; y++) {
+    lcd_set_cursor(sx, y);
+    lcd_write_ram_prepare();
+    for(x = sx; x <= ex; x++) mock_put((uint16_t)color);
+  }
+}
+
+void lcd_color_burst(uint16_t sx, uint16_t sy, uint16_t width, uint16_t height, const uint16_t *color)
+{
+  uint32_t n = (uint32_t)width * height;
+
+  mock_bursts++;
+  lcd_set_window(sx, sy, width, height);
+  lcd_write_ram_prepare();
+  while(n--) mock_put(*color++);
+  lcd_set_window(0, 0, lcddev.width, lcddev.height);
+}
+
+void lcd_draw_rectangle(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint16_t color)
+{
+  lcd_draw_line(x1, y1, x2, y1, color);
+  lcd_draw_line(x1, y2, x2, y2, color);
+  lcd_draw_line(x1, y1, x1, y2, color);
+  lcd_draw_line(x2, y1, x2, y2, color);
+}
+
+/* 文字不画出, 只计入写GRAM命令 */
+void lcd_show_string(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint8_t size, char *p, uint16_t color)
+{
+  (void)x; (void)y; (void)width; (void)height; (void)size; (void)p; (void)color;
+  mock_fsmc_writes++;
+}
@@ -0,0 +1,21 @@
+#ifndef __MOCK_LCD_H
+#define __MOCK_LCD_H
+
+#include "lcd.h"
+
+/* 主机测试用的LCD: 画到帧缓冲, 并按NT35510的寄存器写次数统计FSMC写操作
+ *   设置光标8次, 设置窗口16次, 写GRAM命令1次, 每个像素1次
+ * 画线用驱动里的lcd_line.c(见mock_lcd_line.c), 其中的LCD换成mock_lcd_reg()
+ */
+
+#define MOCK_LCD_WIDTH  480
+#define MOCK_LCD_HEIGHT 800
+
+extern uint16_t (*const mock_fb)[MOCK_LCD_WIDTH];
+extern uint32_t mock_fsmc_writes;       /* FSMC写操作数 */
+extern uint32_t mock_bursts;            /* lcd_color_burst()的调用次数 */
+
+void mock_lcd_clear(uint16_t color);
+LCD_TypeDef *mock_lcd_reg(void);        /* 每次调用为一次写GRAM, LCD_RAM即当前像素 */
+
+#endif /* __MOCK_LCD_H */
@@ -0,0 +1,8 @@
+/* 主机上编译驱动的画线部分: LCD->LCD_RAM的每次写入由mock_lcd_reg()落到帧缓冲的当前像素 */
+#include "lcd.h"
+#include "mock_lcd.h"
+
+#undef LCD
+#define LCD     mock_lcd_reg()
+
+#include "lcd_line.c"
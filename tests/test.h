@@ -0,0 +1,37 @@
+#ifndef __TEST_H
+#define __TEST_H
+
+#include <stdio.h>
+
+/* 主机测试的检查宏: 失败时打印位置并计数, 测试结束时返回失败数 */
+static int test_failures = 0;
+
+#define CHECK(cond) do { \
+    if(!(cond)) { \
+      printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+      test_failures++; \
+    } \
+  } while(0)
+
+#define CHECK_EQ(a, b) do { \
+    long long _a = (long long)(a), _b = (long long)(b); \
+    if(_a != _b) { \
+      printf("%s:%d: %s == %s failed: %lld != %lld\n", __FILE__, __LINE__, #a, #b, _a, _b); \
+      test_failures++; \
+    } \
+  } while(0)
+
+#define CHECK_NEAR(a, b, tol) do { \
+    double _a = (double)(a), _b = (double)(b); \
+    if(_a - _b > (tol) || _b - _a > (tol)) { \
+      printf("%s:%d: %s ~ %s failed: %g vs %g (tol %g)\n", __FILE__, __LINE__, #a, #b, _a, _b, (double)(tol)); \
+      test_failures++; \
+    } \
+  } while(0)
+
+#define TEST_END() do { \
+    printf("%s: %s (%d failures)\n", __FILE__, test_failures ? "FAIL" : "ok", test_failures); \
+    return test_failures != 0; \
+  } while(0)
+
+#endif /* __TEST_H */
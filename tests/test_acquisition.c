@@ -0,0 +1,113 @@
+/* 采集数据块交接: 用模拟的DMA半传输/全传输回调驱动主循环一侧的接口 */
+#include "acquisition.h"
+#include "test.h"
+
+static uint32_t hook_calls = 0;
+static const uint16_t *hook_last = 0;
+
+static void hook(const uint16_t *samples, uint16_t n)
+{
+  hook_calls++;
+  hook_last = samples;
+  CHECK_EQ(n, ACQ_HALF_SAMPLES);
+}
+
+/* DMA写满一个半区: 写入以块序号标记的数据后调用对应的回调 */
+static void dma_fill(uint8_t half, uint16_t tag)
+{
+  uint16_t i;
+
+  for(i = 0; i < ACQ_HALF_SAMPLES; i++) {
+    acq_dma_buf.samples[half * ACQ_HALF_SAMPLES + i] = (uint16_t)(tag + i);
+  }
+  if(half == 0) {
+    acq_on_half_complete();
+  } else {
+    acq_on_full_complete();
+  }
+}
+
+int main(void)
+{
+  acq_block_t blk;
+  uint32_t seq;
+  uint16_t k;
+
+  acq_stream_reset();
+  CHECK(!acq_get_block(&blk));
+
+  /* 主循环跟得上: 每块就绪后立即取走, 序号连续, 数据为刚写入的半区 */
+  for(k = 0; k < 100; k++) {
+    dma_fill(k & 1, k * 1000);
+    CHECK(acq_get_block(&blk));
+    CHECK_EQ(blk.seq, k);
+    CHECK_EQ(blk.len, ACQ_HALF_SAMPLES);
+    CHECK(blk.data == &acq_dma_buf.samples[(k & 1) * ACQ_HALF_SAMPLES]);
+    CHECK_EQ(blk.data[0], (uint16_t)(k * 1000));
+    CHECK_EQ(blk.data[ACQ_HALF_SAMPLES - 1], (uint16_t)(k * 1000 + ACQ_HALF_SAMPLES - 1));
+    acq_release_block();
+    CHECK(!acq_get_block(&blk));
+  }
+  CHECK_EQ(acq_dropped_blocks(), 0);
+
+  /* 两个半区都就绪时先取较早的一块 */
+  acq_stream_reset();
+  dma_fill(0, 0);
+  dma_fill(1, 0);
+  CHECK(acq_get_block(&blk));
+  CHECK_EQ(blk.seq, 0);
+  acq_release_block();
+  CHECK(acq_get_block(&blk));
+  CHECK_EQ(blk.seq, 1);
+  acq_release_block();
+
+  /* 跨过序号起点: 后半的序号较早 */
+  acq_stream_reset();
+  dma_fill(0, 0);
+  CHECK(acq_get_block(&blk));
+  acq_release_block();
+  dma_fill(1, 0);
+  dma_fill(0, 0);
+  CHECK(acq_get_block(&blk));
+  CHECK_EQ(blk.seq, 1);
+  CHECK(blk.data == &acq_dma_buf.samples[ACQ_HALF_SAMPLES]);
+  acq_release_block();
+  CHECK(acq_get_block(&blk));
+  CHECK_EQ(blk.seq, 2);
+  acq_release_block();
+
+  /* 主循环太慢: 未取走的半区被覆盖, 以及正在处理的半区被覆盖, 都计为丢块 */
+  acq_stream_reset();
+  dma_fill(0, 0);
+  dma_fill(1, 0);
+  dma_fill(0, 0);
+  CHECK_EQ(acq_dropped_blocks(), 1);
+  CHECK(acq_get_block(&blk));
+  seq = blk.seq;
+  CHECK_EQ(seq, 1);
+  dma_fill(1, 0);                   /* 覆盖正在处理的后半 */
+  CHECK_EQ(acq_dropped_blocks(), 2);
+  acq_release_block();
+  CHECK(acq_get_block(&blk));
+  CHECK_EQ(blk.seq, 2);
+  acq_release_block();
+  CHECK(acq_get_block(&blk));
+  CHECK_EQ(blk.seq, 3);
+  acq_release_block();
+
+  /* 中断上下文的处理函数对每个半区都调用一次, 与主循环是否取走无关 */
+  acq_stream_reset();
+  acq_set_block_hook(hook);
+  for(k = 0; k < 10; k++) {
+    dma_fill(k & 1, 0);
+    CHECK(hook_last == &acq_dma_buf.samples[(k & 1) * ACQ_HALF_SAMPLES]);
+  }
+  CHECK_EQ(hook_calls, 10);
+  acq_set_block_hook(0);
+  dma_fill(0, 0);
+  CHECK_EQ(hook_calls, 10);
+
+  CHECK(acq_mode_name(ACQ_MODE_COUNT)[0] == '?');
+
+  TEST_END();
+}
@@ -0,0 +1,134 @@
+/* 记录平均: 数据块处理函数累加每一条完成的记录, 块平均/指数平均的结果和噪声下降, 16位记录不溢出 */
+#include "average.h"
+#include "capture.h"
+#include "trigger.h"
+#include "test.h"
+#include <math.h>
+#include <stdlib.h>
+
+#define PERIOD  200
+#define REC     100
+
+static uint16_t block[256];
+static uint32_t stream_pos = 0;
+
+/* 周期PERIOD的正弦加峰值noise的均匀噪声, 幅度scale */
+static uint16_t sample(uint32_t i, int noise, uint32_t scale)
+{
+  double v = 2048 + 1500 * sin(2 * M_PI * (i % PERIOD) / PERIOD);
+
+  if(noise) v += rand() % (2 * noise + 1) - noise;
+  return (uint16_t)lround(v * scale);
+}
+
+/* 按半缓冲喂入count个采样 */
+static void feed(uint32_t count, int noise, uint32_t scale)
+{
+  while(count > 0) {
+    uint16_t n = (count < 256) ? (uint16_t)count : 256, i;
+
+    for(i = 0; i < n; i++) block[i] = sample(stream_pos + i, noise, scale);
+    average_push(block, n);
+    stream_pos += n;
+    count -= n;
+  }
+}
+
+/* 平均结果与无噪声信号的均方根误差 */
+static double rms_error(uint32_t scale)
+{
+  uint16_t rec[REC];
+  uint16_t i, n;
+  uint32_t first;
+  double e = 0;
+
+  n = average_read(rec, REC);
+  CHECK_EQ(n, REC);
+  /* 触发点在过零上升处(相位0), 预触发一半 */
+  first = PERIOD - REC / 2;
+  for(i = 0; i < n; i++) {
+    double d = (double)rec[i] - sample(first + i, 0, scale);
+    e += d * d;
+  }
+  return sqrt(e / n);
+}
+
+/* 16位记录在右移4位后检测触发, 同高分辨率模式 */
+static int32_t trigger_16bit(const uint16_t *samples, uint16_t n)
+{
+  uint16_t tmp[256], i;
+
+  for(i = 0; i < n; i++) tmp[i] = samples[i] >> 4;
+  return trigger_find(tmp, n);
+}
+
+static void start(average_mode_t mode, uint8_t log2n)
+{
+  srand(5);
+  stream_pos = 0;
+  trigger_reset();
+  trigger_set_edge(TRIGGER_EDGE_RISING);
+  trigger_set_level(2048, 200);
+  trigger_set_holdoff(0);
+  capture_set_trigger(trigger_find);
+  capture_configure(REC, 50, 1);
+  average_configure(mode, log2n);
+  capture_arm();
+}
+
+int main(void)
+{
+  double e1, e16;
+  uint16_t rec[REC];
+
+  /* 每个周期一个触发点: 喂入64个周期, 除第一个周期外每条记录都被累加, 与取走结果的频率无关 */
+  start(AVERAGE_BLOCK, 8);
+  CHECK_EQ(average_read(rec, REC), 0);
+  feed(64 * PERIOD, 100, 1);
+  CHECK_EQ(average_records(), 63);
+  CHECK_EQ(average_count(), 63);
+  CHECK(!capture_ready());                    /* 中断中已重新布防 */
+
+  /* 块平均: 1条和16条记录的噪声, 均匀噪声±100的均方根约58 */
+  start(AVERAGE_BLOCK, 4);
+  feed(PERIOD + REC, 100, 1);
+  CHECK_EQ(average_count(), 1);
+  e1 = rms_error(1);
+  feed(15 * PERIOD, 100, 1);
+  CHECK_EQ(average_count(), 16);
+  e16 = rms_error(1);
+  printf("block average: rms error %.1f LSB (1 record) -> %.1f LSB (16 records)\n", e1, e16);
+  CHECK(e1 > 40);
+  CHECK(e16 < e1 / 3);
+
+  /* 满16条后下一条重新开始 */
+  feed(PERIOD, 100, 1);
+  CHECK_EQ(average_count(), 1);
+
+  /* 指数平均: 等效32条 */
+  start(AVERAGE_EMA, 5);
+  feed(200 * PERIOD, 100, 1);
+  CHECK_EQ(average_count(), 32);
+  e16 = rms_error(1);
+  printf("EMA 1/32: rms error %.1f LSB\n", e16);
+  CHECK(e16 < 20);
+
+  /* 16位高分辨率记录: 块平均256条和指数平均都不溢出 */
+  start(AVERAGE_BLOCK, 8);
+  capture_set_trigger(trigger_16bit);
+  feed(257 * PERIOD, 0, 16);
+  CHECK_EQ(average_count(), 256);
+  CHECK(rms_error(16) < 1.0);
+  start(AVERAGE_EMA, 8);
+  capture_set_trigger(trigger_16bit);
+  feed(300 * PERIOD, 0, 16);
+  CHECK(rms_error(16) < 2.0);
+
+  /* 关闭时等同于capture_push(): 记录完成后保持, 由显示取走 */
+  start(AVERAGE_OFF, 1);
+  feed(2 * PERIOD, 100, 1);
+  CHECK(capture_ready());
+  CHECK_EQ(average_read(rec, REC), 0);
+
+  TEST_END();
+}
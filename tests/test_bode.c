@@ -0,0 +1,129 @@
+/* 波特图: 模拟DAC阶梯输出经一阶RC低通后由ADC采样, 直通校准后的增益/相位与RC网络的理论值比较 */
+#include "bode.h"
+#include "dds.h"
+#include "test.h"
+#include <math.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define RATE        200000.0
+#define FC          1000.0          /* RC网络的截止频率, Hz */
+#define POINTS      16
+#define AMP         3000            /* dds_set_level的幅度, 峰值1500LSB */
+
+static double rc_y = 2048;          /* 电容电压 */
+
+static uint32_t host_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint32_t)(ts.tv_sec * 1000000000ULL + ts.tv_nsec);
+}
+
+/* 加0~1LSB的均匀抖动后取整, 模拟ADC的量化和噪声 */
+static uint16_t quantize(double v)
+{
+  v = floor(v + (rand() % 1000) / 1000.0);
+  if(v < 0) v = 0;
+  if(v > 4095) v = 4095;
+  return (uint16_t)v;
+}
+
+/**
+ * 扫描一次: DAC第j个台阶开始后BODE_ADC_SAMPLE_NS采到的值是第j+1个ADC采样(晚BODE_DAC_LATENCY个点).
+ * rc=0时ADC直接接DAC输出, rc=1时接RC网络的输出, 网络在台阶内按指数规律充放电.
+ */
+static void sweep(uint8_t rc)
+{
+  static uint16_t dac[256], adc[256];
+  const double tau = 1.0 / (2 * M_PI * FC);
+  const double a_step = exp(-1.0 / RATE / tau);
+  const double a_adc = exp(-BODE_ADC_SAMPLE_NS * 1e-9 / tau);
+  uint16_t last = 2048;
+  uint32_t guard = 0;
+
+  bode_stop();
+  dds_reset_phase();
+  bode_start(AMP);
+  rc_y = 2048;
+  while(bode_running() && ++guard < 100000) {
+    uint16_t i;
+
+    dds_fill(dac, 256);
+    for(i = 0; i < 256; i++) {
+      double u = dac[i];
+
+      adc[i] = last;
+      if(rc) {
+        last = quantize(rc_y * a_adc + u * (1 - a_adc));
+        rc_y = rc_y * a_step + u * (1 - a_step);
+      } else {
+        last = dac[i];
+      }
+    }
+    bode_push(adc, 256);
+    bode_poll();
+  }
+}
+
+int main(void)
+{
+  bode_point_t pt;
+  uint16_t i;
+  double worst_gain = 0, worst_phase = 0;
+
+  srand(17);
+  dds_init();
+  dds_set_rate((uint32_t)RATE);
+  dds_set_shape(0, DDS_SINE);
+  dds_set_level(0, AMP, 2048);
+  dds_set_interp(1);
+  bode_configure(BODE_DEFAULT_START_MHZ, BODE_DEFAULT_STOP_MHZ, POINTS);
+  CHECK_EQ(bode_points(), POINTS);
+  CHECK(!bode_cal_valid());
+
+  /* 直通扫描: 未校准时增益只差零阶保持的sinc, 在0dB附近 */
+  sweep(0);
+  CHECK_EQ(bode_done(), POINTS);
+  CHECK(bode_get_point(0, &pt));
+  CHECK(abs(pt.gain_cdb) <= 5);
+  CHECK(!bode_get_point(POINTS, &pt));
+  bode_cal_store();
+  CHECK(bode_cal_valid());
+
+  /* 校准后直通: 结果里补回了网络看到的零阶保持, 低频点(sinc可忽略)增益0dB, 相位0度 */
+  sweep(0);
+  for(i = 0; i < POINTS; i++) {
+    CHECK(bode_get_point(i, &pt));
+    if(pt.freq_mhz > 1000000) break;
+    CHECK(abs(pt.gain_cdb) <= 2);
+    CHECK(abs(pt.phase_x10) <= 2);
+  }
+
+  /* RC低通: |H| = 1/sqrt(1+(f/fc)^2), 相位 -atan(f/fc) */
+  bode_set_clock(host_ns);
+  sweep(1);
+  printf("   freq(Hz)  gain(dB) ideal  phase(deg) ideal\n");
+  for(i = 0; i < POINTS; i++) {
+    double f, gain, phase;
+
+    CHECK(bode_get_point(i, &pt));
+    f = pt.freq_mhz / 1000.0;
+    gain = -10 * log10(1 + (f / FC) * (f / FC));
+    phase = -atan(f / FC) * 180 / M_PI;
+    printf("%10.2f  %7.2f %6.2f  %7.1f %7.1f\n", f, pt.gain_cdb / 100.0, gain, pt.phase_x10 / 10.0, phase);
+    if(fabs(pt.gain_cdb / 100.0 - gain) > worst_gain) worst_gain = fabs(pt.gain_cdb / 100.0 - gain);
+    if(fabs(pt.phase_x10 / 10.0 - phase) > worst_phase) worst_phase = fabs(pt.phase_x10 / 10.0 - phase);
+  }
+  printf("max error %.2f dB, %.1f deg; correlation %.2f ns/sample on host\n",
+         worst_gain, worst_phase, bode_cycles_per_sample_x100() / 100.0);
+  CHECK(worst_gain < 0.3);
+  CHECK(worst_phase < 2.0);
+
+  /* 频点改变后校准失效 */
+  bode_configure(BODE_DEFAULT_START_MHZ, BODE_DEFAULT_STOP_MHZ, POINTS + 1);
+  CHECK(!bode_cal_valid());
+
+  TEST_END();
+}
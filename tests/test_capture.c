@@ -0,0 +1,152 @@
+/* 预触发/后触发采集: 触发点下标和记录内容, 各种预触发深度和数据块大小 */
+#include "capture.h"
+#include "test.h"
+
+/* 采样值即其绝对序号(取模4096), 记录内容可以直接与序号比较 */
+static uint32_t stream_pos = 0;
+static uint16_t trigger_at = 0;
+
+/* 在值为trigger_at的采样处触发 */
+static int32_t value_trigger(const uint16_t *samples, uint16_t n)
+{
+  uint16_t i;
+
+  for(i = 0; i < n; i++) {
+    if(samples[i] == trigger_at) return i;
+  }
+  return -1;
+}
+
+/* 按块大小block喂入count个采样 */
+static void feed(uint32_t count, uint16_t block)
+{
+  uint16_t buf[512];
+  uint16_t i, n;
+
+  while(count > 0) {
+    n = (count < block) ? (uint16_t)count : block;
+    for(i = 0; i < n; i++) {
+      buf[i] = (uint16_t)((stream_pos + i) & 0xFFF);
+    }
+    capture_push(buf, n);
+    stream_pos += n;
+    count -= n;
+  }
+}
+
+/* 记录应为触发点之前pre个和之后len-pre个连续序号 */
+static void check_record(uint16_t trig, uint16_t len, uint16_t pre)
+{
+  uint16_t rec[CAPTURE_MAX_RECORD];
+  uint16_t i, bad = 0;
+
+  CHECK(capture_ready());
+  CHECK_EQ(capture_record_length(), len);
+  CHECK_EQ(capture_trigger_index(), pre);
+  capture_copy_record(rec, len);
+  for(i = 0; i < len; i++) {
+    if(rec[i] != (uint16_t)((trig - pre + i) & 0xFFF)) bad++;
+  }
+  CHECK_EQ(bad, 0);
+  CHECK_EQ(capture_read(pre), trig);
+}
+
+int main(void)
+{
+  static const uint8_t pcts[] = { 0, 10, 25, 50, 90, 100 };
+  static const uint16_t blocks[] = { 1, 7, 64, 256, 512 };
+  uint16_t p, b;
+
+  capture_set_trigger(value_trigger);
+
+  for(p = 0; p < sizeof(pcts); p++) {
+    for(b = 0; b < sizeof(blocks) / sizeof(blocks[0]); b++) {
+      uint16_t len = 460, pre;
+
+      capture_configure(len, pcts[p], 1);
+      pre = (uint32_t)len * pcts[p] / 100;
+      if(pre > len - 1) pre = len - 1;
+
+      /* 预触发数据未填满之前出现的触发点被忽略 */
+      stream_pos = 3000;
+      trigger_at = (uint16_t)((stream_pos + pre / 2) & 0xFFF);
+      capture_arm();
+      feed(pre, blocks[b]);
+      CHECK(pre == 0 || capture_state() == CAPTURE_ARMED);
+      CHECK(!capture_ready());
+
+      trigger_at = (uint16_t)((stream_pos + 333) & 0xFFF);
+      feed(1500, blocks[b]);
+      check_record(trigger_at, len, pre);
+
+      /* 冻结后继续喂入不改变记录 */
+      feed(2000, blocks[b]);
+      check_record(trigger_at, len, pre);
+    }
+  }
+
+  /* 峰值检测的对齐: 长度和预触发深度取偶数 */
+  capture_configure(461, 33, 2);
+  CHECK_EQ(capture_record_length(), 460);
+  CHECK_EQ(capture_trigger_index() % 2, 0);
+
+  /* 连续布防: 记录完成时立即重新布防, 紧接着的触发点的预触发数据取自上一条记录 */
+  capture_configure(200, 50, 1);
+  stream_pos = 0;
+  trigger_at = 150;
+  capture_arm();
+  while(!capture_ready()) feed(1, 1);
+  CHECK_EQ(stream_pos, 250);
+  check_record(150, 200, 100);
+  capture_arm_continue();
+  trigger_at = (uint16_t)((stream_pos + 5) & 0xFFF);
+  feed(300, 64);
+  check_record(trigger_at, 200, 100);
+
+  /* capture_feed()在记录完成处停止, 返回已处理的采样数 */
+  {
+    uint16_t buf[256], i;
+
+    capture_configure(100, 0, 1);
+    trigger_at = 40;
+    for(i = 0; i < 256; i++) buf[i] = i;
+    capture_arm();
+    CHECK_EQ(capture_feed(buf, 256), 140);
+    CHECK(capture_ready());
+    CHECK_EQ(capture_read(0), 40);
+  }
+
+  /* 强制触发: 以下一个采样作为触发点 */
+  capture_configure(100, 20, 1);
+  stream_pos = 0;
+  trigger_at = 0xFFFF;              /* 永不触发 */
+  capture_arm();
+  feed(500, 50);
+  CHECK_EQ(capture_state(), CAPTURE_ARMED);
+  capture_force();
+  feed(200, 50);
+  check_record(500, 100, 20);
+
+  /* 停止后不写入 */
+  capture_disarm();
+  feed(100, 50);
+  CHECK_EQ(capture_state(), CAPTURE_IDLE);
+
+  /* 默认触发: 电平上升穿越, 在跨越块边界时也能检测到 */
+  {
+    uint16_t lo[10] = { 100, 100, 100, 100, 100, 100, 100, 100, 100, 100 };
+    uint16_t hi[10] = { 3000, 3000, 3000, 3000, 3000, 3000, 3000, 3000, 3000, 3000 };
+
+    capture_set_trigger(0);
+    capture_set_level(2048);
+    capture_configure(10, 50, 1);
+    capture_arm();
+    capture_push(lo, 10);
+    capture_push(hi, 10);
+    CHECK(capture_ready());
+    CHECK_EQ(capture_read(4), 100);
+    CHECK_EQ(capture_read(5), 3000);
+  }
+
+  TEST_END();
+}
@@ -0,0 +1,189 @@
+/* DDS: 正弦表精度, 频率字的频率精度, 由输出过零点测得的频率, 改变频率时相位连续, 双通道相位差,
+ * 大跨度的对数阶梯扫频 */
+#include "dds.h"
+#include "test.h"
+#include <math.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define RATE    200000U
+#define N       50000
+
+static uint16_t out[N];
+static uint32_t dual[4096];
+
+static uint32_t host_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint32_t)(ts.tv_sec * 1000000000ULL + ts.tv_nsec);
+}
+
+/* 由上升过零点(线性插值)测量输出频率, Hz */
+static double measure_hz(const uint16_t *s, uint32_t n, double mid)
+{
+  double first = -1, last = -1;
+  uint32_t i, count = 0;
+
+  for(i = 1; i < n; i++) {
+    if(s[i - 1] < mid && s[i] >= mid) {
+      double t = i - 1 + (mid - s[i - 1]) / (s[i] - s[i - 1]);
+      if(first < 0) first = t;
+      else count++;
+      last = t;
+    }
+  }
+  return (count > 0) ? count * (double)RATE / (last - first) : 0;
+}
+
+/* 输出相对理想正弦的最大误差(LSB) */
+static double sine_error(const uint16_t *s, uint32_t n, double hz)
+{
+  double worst = 0;
+  uint32_t i;
+
+  for(i = 0; i < n; i++) {
+    double ideal = 2048 + 4000.0 / 65536 * 32767 * sin(2 * M_PI * hz * i / RATE);
+    double e = fabs(s[i] - ideal);
+    if(e > worst) worst = e;
+  }
+  return worst;
+}
+
+int main(void)
+{
+  static const uint32_t freqs_mhz[] = { 1000, 1234567, 9999999, 37000000 };
+  const int16_t *lut;
+  uint32_t i, k;
+  int worst = 0;
+  double e_plain, e_interp;
+
+  dds_init();
+  dds_set_rate(RATE);
+  CHECK_EQ(dds_get_rate(), RATE);
+
+  /* 正弦表: 定点递推生成, 与理想值相差不超过1LSB(Q15) */
+  lut = dds_sine_table();
+  for(i = 0; i <= DDS_LUT_SIZE; i++) {
+    int d = abs(lut[i] - (int)lround(32767 * sin(2 * M_PI * i / DDS_LUT_SIZE)));
+    if(d > worst) worst = d;
+  }
+  CHECK(worst <= 1);
+
+  /* 设定频率与频率字: 误差不超过半个分辨率(fs/2^32), 输出过零点测得的频率与频率字一致 */
+  dds_set_shape(0, DDS_SINE);
+  dds_set_level(0, 4000, 2048);
+  dds_set_interp(1);
+  for(k = 0; k < sizeof(freqs_mhz) / sizeof(freqs_mhz[0]); k++) {
+    double exact = freqs_mhz[k] / 1000.0;
+    double word_hz, meas;
+
+    dds_set_frequency(freqs_mhz[k]);
+    word_hz = dds_get_tuning_word() * (double)RATE / 4294967296.0;
+    CHECK(fabs(word_hz - exact) <= RATE / 4294967296.0 / 2 + 1e-9);
+    CHECK(fabs(dds_get_frequency() / 1000.0 - word_hz) <= 0.001);
+
+    dds_reset_phase();
+    dds_fill(out, N);
+    meas = measure_hz(out, N, 2048);
+    printf("set %.3f Hz: word %.6f Hz, measured %.6f Hz\n", exact, word_hz, meas);
+    /* 1Hz在N个采样内不足一个周期, 只检查频率字 */
+    if(freqs_mhz[k] >= 10000) {
+      CHECK(fabs(meas - word_hz) / word_hz < 1e-5);
+    }
+  }
+
+  /* 频率上限fs/2 */
+  CHECK_EQ(dds_set_frequency(RATE * 1000U), RATE * 1000U / 2);
+
+  /* 插值: 低频正弦的最大误差明显小于直接查表 */
+  dds_set_frequency(50000);
+  dds_reset_phase();
+  dds_set_interp(0);
+  dds_fill(out, 8000);
+  e_plain = sine_error(out, 8000, dds_get_tuning_word() * (double)RATE / 4294967296.0);
+  dds_reset_phase();
+  dds_set_interp(1);
+  dds_fill(out, 8000);
+  e_interp = sine_error(out, 8000, dds_get_tuning_word() * (double)RATE / 4294967296.0);
+  printf("50 Hz sine max error: table %.2f LSB, interpolated %.2f LSB\n", e_plain, e_interp);
+  CHECK(e_interp < 1.5);
+  CHECK(e_interp < e_plain);
+
+  /* 改变频率时相位连续: 分两次填充, 中间改频率, 相邻点之差不超过新频率下的最大斜率 */
+  dds_set_frequency(1000000);
+  dds_reset_phase();
+  dds_fill(out, 1000);
+  dds_set_frequency(3000000);
+  dds_fill(&out[1000], 1000);
+  worst = 0;
+  for(i = 1; i < 2000; i++) {
+    int d = abs((int)out[i] - (int)out[i - 1]);
+    if(d > worst) worst = d;
+  }
+  CHECK(worst <= (int)(2000 * 2 * M_PI * 3000.0 / RATE) + 2);
+  CHECK_EQ(dds_get_sample_count(), 2000);
+
+  /* 双通道: 通道2为同一相位加90度, 即余弦 */
+  dds_set_shape(1, DDS_SINE);
+  dds_set_level(1, 4000, 2048);
+  dds_set_ratio(1);
+  dds_set_phase_offset(900);
+  dds_set_frequency(2000000);
+  dds_reset_phase();
+  dds_fill_dual(dual, 4096);
+  worst = 0;
+  for(i = 0; i < 4096; i++) {
+    uint16_t c1 = dual[i] & 0xFFFF, c2 = dual[i] >> 16;
+    double th = 2 * M_PI * dds_get_tuning_word() * (double)i / 4294967296.0;
+    int d1 = abs((int)c1 - (int)lround(2048 + 2000 * sin(th)));
+    int d2 = abs((int)c2 - (int)lround(2048 + 2000 * cos(th)));
+    if(d1 > worst) worst = d1;
+    if(d2 > worst) worst = d2;
+  }
+  CHECK(worst <= 3);
+
+  /* 对数阶梯扫频1Hz->1MHz: 2步时相邻两级的频率字之比约10^6, 3步时约10^3, 都超出32位Q28的范围;
+   * 每一级的频率字等于起止频率字的几何插值 */
+  dds_set_rate(2500000);
+  for(k = 2; k <= 3; k++) {
+    uint32_t words[3] = { 0, 0, 0 }, m0, m1, fills;
+
+    dds_sweep_start(DDS_SWEEP_STEP, 1000, 1000000000, 100, k, 1, 256);
+    fills = 250000 / k / 256 * k;
+    for(i = 0; i < fills; i++) {
+      dds_fill(out, 256);
+      CHECK(dds_sweep_step_index() < k);
+      words[dds_sweep_step_index()] = dds_get_tuning_word();
+    }
+    m0 = words[0];
+    m1 = words[k - 1];
+    printf("log sweep %lu steps: words %lu %lu %lu\n", (unsigned long)k,
+           (unsigned long)words[0], (unsigned long)words[1], (unsigned long)words[2]);
+    CHECK(fabs(m0 - 4294967296.0 / 2500000) <= 0.5);
+    CHECK(fabs(m1 - 4294967296.0 * 1e6 / 2500000) <= 0.5);
+    for(i = 1; i + 1 < k; i++) {
+      double ideal = m0 * pow((double)m1 / m0, (double)i / (k - 1));
+      CHECK(fabs(words[i] - ideal) / ideal < 1e-5);
+    }
+  }
+  dds_sweep_stop();
+  dds_set_rate(RATE);
+
+  /* 填充耗时(主机上的ns, 仅供参考) */
+  dds_set_clock(host_ns);
+  for(k = 0; k < DDS_SHAPE_COUNT; k++) {
+    uint32_t best = 0xFFFFFFFF;
+
+    dds_set_shape(0, (dds_shape_t)k);
+    for(i = 0; i < 20; i++) {
+      dds_fill(out, 256);
+      if(dds_cycles_per_sample_x100() < best) best = dds_cycles_per_sample_x100();
+    }
+    printf("fill %-6s: %.2f ns/sample on host\n", dds_shape_name((dds_shape_t)k), best / 100.0);
+  }
+  dds_set_clock(0);
+
+  TEST_END();
+}
@@ -0,0 +1,92 @@
+/* 等效时间采样: 随机触发相位的记录放入时间网格后重建出高于实际采样率的波形, 空格插值, 旧数据衰减 */
+#include "ets.h"
+#include "test.h"
+#include <math.h>
+#include <stdlib.h>
+
+#define FACTOR  16
+#define BINS    400
+#define PERIOD  2.5         /* 信号周期(实际采样间隔), 每周期只有2.5个实际采样 */
+
+/* 以上升过零时刻为t=0的信号, t以实际采样间隔为单位 */
+static double signal_at(double t)
+{
+  return 2048 + 1500 * sin(2 * M_PI * t / PERIOD);
+}
+
+/* 过电平时刻在(trig_idx-1, trig_idx]内随机的一条记录 */
+static void add_random_record(void)
+{
+  uint16_t rec[ETS_MAX_RECORD];
+  uint16_t len = ets_record_length();
+  uint16_t trig_idx = len / 2;
+  double tc = trig_idx - 1 + (rand() + 1.0) / (RAND_MAX + 1.0);
+  uint16_t frac = (uint16_t)lround((tc - (trig_idx - 1)) * FACTOR);
+  uint16_t i;
+
+  for(i = 0; i < len; i++) {
+    rec[i] = (uint16_t)lround(signal_at(i - tc));
+  }
+  ets_add_record(rec, len, trig_idx, frac);
+}
+
+static double rms_error(const uint16_t *out)
+{
+  double e = 0;
+  uint16_t b;
+
+  for(b = 0; b < BINS; b++) {
+    double d = out[b] - signal_at((b - BINS / 2.0) / FACTOR);
+    e += d * d;
+  }
+  return sqrt(e / BINS);
+}
+
+int main(void)
+{
+  static uint16_t out[ETS_MAX_BINS];
+  uint16_t filled;
+  uint32_t k;
+  double err;
+
+  srand(9);
+  ets_configure(FACTOR, BINS, 50);
+  CHECK_EQ(ets_get_factor(), FACTOR);
+  CHECK_EQ(ets_get_bins(), BINS);
+  CHECK_EQ(ets_record_length(), (BINS + FACTOR - 1) / FACTOR + 2);
+
+  /* 没有记录时输出中间值 */
+  CHECK_EQ(ets_reconstruct(out), 0);
+  CHECK_EQ(out[0], 2048);
+
+  /* 一条记录只填满1/FACTOR的格, 空格线性插值 */
+  add_random_record();
+  filled = ets_reconstruct(out);
+  CHECK(filled >= BINS / FACTOR - 1 && filled <= BINS / FACTOR + 1);
+
+  /* 多条随机相位的记录之后网格被填满, 重建误差只来自相位量化(1/FACTOR个采样间隔) */
+  for(k = 0; k < 300; k++) add_random_record();
+  CHECK_EQ(ets_record_count(), 301);
+  filled = ets_reconstruct(out);
+  err = rms_error(out);
+  printf("ETS x%u, %.1f samples/period: %u/%u bins filled, rms error %.1f LSB\n",
+         FACTOR, PERIOD, filled, BINS, err);
+  CHECK_EQ(filled, BINS);
+  CHECK(err < 60);
+
+  /* 长时间累积: 任一格满ETS_DECAY_COUNT次时全部减半, 减半不能改变各格的平均值 */
+  for(k = 0; k < 5000; k++) add_random_record();
+  CHECK_EQ(ets_reconstruct(out), BINS);
+  err = rms_error(out);
+  printf("after 5000 records: rms error %.1f LSB\n", err);
+  CHECK(err < 60);
+
+  /* 等效采样倍数超出范围时取边界 */
+  ets_configure(200, 1000, 150);
+  CHECK_EQ(ets_get_factor(), ETS_MAX_FACTOR);
+  CHECK_EQ(ets_get_bins(), ETS_MAX_BINS);
+  CHECK(ets_record_length() <= ETS_MAX_RECORD);
+  CHECK_EQ(ets_record_count(), 0);
+
+  TEST_END();
+}
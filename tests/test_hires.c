@@ -0,0 +1,137 @@
+/* 高分辨率采集: R=4/16/64/256时的噪声底和有效位数, 直流的16位读数, 扫描时间与抽取比的对应 */
+#include "hires.h"
+#include "test.h"
+#include <math.h>
+#include <stdlib.h>
+
+#define OUT_POINTS  2048
+#define NOISE_LSB   0.5     /* 输入端的热噪声(12位LSB, 均方根) */
+
+static uint16_t buf[256];
+
+/* 均值0, 方差1的高斯噪声 */
+static double gauss(void)
+{
+  double u1 = (rand() + 1.0) / (RAND_MAX + 2.0);
+  double u2 = (rand() + 1.0) / (RAND_MAX + 2.0);
+
+  return sqrt(-2 * log(u1)) * cos(2 * M_PI * u2);
+}
+
+static uint16_t adc(double v)
+{
+  v = floor(v + NOISE_LSB * gauss() + 0.5);
+  if(v < 0) v = 0;
+  if(v > 4095) v = 4095;
+  return (uint16_t)v;
+}
+
+/* 以抽取比r处理函数f(i)给出的输入, 收集OUT_POINTS个16位输出 */
+static void collect(uint16_t r, double (*f)(uint32_t, uint16_t), double *out)
+{
+  uint32_t pos = 0;
+  uint16_t got = 0;
+
+  hires_configure(r, 0);
+  hires_reset();
+  while(got < OUT_POINTS) {
+    uint16_t i, m;
+
+    for(i = 0; i < 256; i++) buf[i] = adc(f(pos + i, r));
+    pos += 256;
+    m = hires_process(buf, 256);
+    for(i = 0; i < m && got < OUT_POINTS; i++) out[got++] = buf[i];
+  }
+}
+
+static double dc_input(uint32_t i, uint16_t r)
+{
+  (void)i;
+  (void)r;
+  return 2047.3;
+}
+
+/* 输出序列上正好17个周期的正弦, 幅度1800LSB */
+static double sine_input(uint32_t i, uint16_t r)
+{
+  return 2048 + 1800 * sin(2 * M_PI * 17.0 * i / ((double)OUT_POINTS * r));
+}
+
+/* 按已知频率做正弦+直流的最小二乘拟合, 返回残差均方根 */
+static double sine_residual(const double *y)
+{
+  double s[3][3] = {{0}}, b[3] = {0}, x[3], e = 0;
+  uint16_t i, j, k;
+
+  for(i = 0; i < OUT_POINTS; i++) {
+    double v[3] = { sin(2 * M_PI * 17.0 * i / OUT_POINTS), cos(2 * M_PI * 17.0 * i / OUT_POINTS), 1 };
+    for(j = 0; j < 3; j++) {
+      b[j] += v[j] * y[i];
+      for(k = 0; k < 3; k++) s[j][k] += v[j] * v[k];
+    }
+  }
+  /* 3x3高斯消元 */
+  for(j = 0; j < 3; j++) {
+    for(k = j + 1; k < 3; k++) {
+      double f = s[k][j] / s[j][j];
+      s[k][0] -= f * s[j][0]; s[k][1] -= f * s[j][1]; s[k][2] -= f * s[j][2];
+      b[k] -= f * b[j];
+    }
+  }
+  for(j = 3; j-- > 0;) {
+    x[j] = b[j];
+    for(k = j + 1; k < 3; k++) x[j] -= s[j][k] * x[k];
+    x[j] /= s[j][j];
+  }
+  for(i = 0; i < OUT_POINTS; i++) {
+    double d = y[i] - x[0] * sin(2 * M_PI * 17.0 * i / OUT_POINTS)
+                    - x[1] * cos(2 * M_PI * 17.0 * i / OUT_POINTS) - x[2];
+    e += d * d;
+  }
+  return sqrt(e / OUT_POINTS);
+}
+
+int main(void)
+{
+  static const uint16_t rs[] = { 4, 16, 64, 256 };
+  static double out[OUT_POINTS];
+  double prev_enob = 0;
+  uint16_t k, i;
+
+  srand(11);
+  printf("  R  noise(LSB12)  DC(LSB12)  ENOB  nominal\n");
+  for(k = 0; k < sizeof(rs) / sizeof(rs[0]); k++) {
+    double mean = 0, var = 0, rms, enob;
+
+    /* 直流输入: 噪声底(换算为12位LSB)和平均值 */
+    collect(rs[k], dc_input, out);
+    for(i = 0; i < OUT_POINTS; i++) mean += out[i];
+    mean /= OUT_POINTS;
+    for(i = 0; i < OUT_POINTS; i++) var += (out[i] - mean) * (out[i] - mean);
+    rms = sqrt(var / OUT_POINTS) / 16;
+
+    /* 正弦输入: 16位满量程下, 残差相对理想量化噪声的位数 */
+    collect(rs[k], sine_input, out);
+    enob = 16 - log2(sine_residual(out) * sqrt(12));
+
+    printf("%3u  %11.4f  %9.3f  %5.2f  %u\n", rs[k], rms, mean / 16, enob, hires_bits());
+    CHECK_EQ(hires_get_decimation(), rs[k]);
+
+    /* 白噪声经2阶CIC后均方根下降不少于sqrt(R)倍 */
+    CHECK(rms <= NOISE_LSB / sqrt(rs[k]) * 1.1 + 0.3 / 16);
+    /* 直流的16位读数分辨出小数部分 */
+    CHECK(fabs(mean / 16 - 2047.3) < 0.05);
+    /* 输入端0.5LSB的噪声使R=1时只有约11位, 有效位数不低于标称值1位以上, 且随R增加 */
+    CHECK(enob >= hires_bits() - 1.0);
+    CHECK(enob > prev_enob + 0.5);
+    prev_enob = enob;
+  }
+
+  /* 扫描时间与抽取比: 时基分频1~3(5817/2902/1939ms)分别为R=256/256/64 */
+  CHECK_EQ(hires_select_decimation(5817), 256);
+  CHECK_EQ(hires_select_decimation(2902), 256);
+  CHECK_EQ(hires_select_decimation(1939), 64);
+  CHECK_EQ(hires_select_decimation(HIRES_SWEEP_MS_15BIT - 1), 16);
+
+  TEST_END();
+}
@@ -0,0 +1,106 @@
+/* 双ADC交替数据: 解交替的时间顺序, 增益/偏置失配的估计和修正, 不可信估计的拒绝 */
+#include "interleave.h"
+#include "test.h"
+#include <math.h>
+#include <stdlib.h>
+
+#define PAIRS 128
+
+static uint32_t words[PAIRS];
+static uint16_t truth[PAIRS * 2];
+
+static uint16_t clip12(double v)
+{
+  if(v < 0) return 0;
+  if(v > 4095) return 4095;
+  return (uint16_t)lround(v);
+}
+
+/* 同一输入: 第2k点由ADC2采样(高半字), 第2k+1点由ADC1采样(低半字); ADC2有增益和偏置误差 */
+static void make(double amp, double gain2, double offset2)
+{
+  uint16_t i;
+
+  for(i = 0; i < PAIRS * 2; i++) {
+    truth[i] = clip12(2048 + amp * sin(2 * M_PI * i / 37.0));
+  }
+  for(i = 0; i < PAIRS; i++) {
+    uint16_t a2 = clip12(truth[2 * i] * gain2 + offset2);
+    uint16_t a1 = truth[2 * i + 1];
+    words[i] = ((uint32_t)a2 << 16) | a1;
+  }
+}
+
+/* 解交替后与真值的最大误差 */
+static int max_error(void)
+{
+  const uint16_t *s = (const uint16_t *)words;
+  int i, e, worst = 0;
+
+  for(i = 0; i < PAIRS * 2; i++) {
+    e = abs((int)s[i] - (int)truth[i]);
+    if(e > worst) worst = e;
+  }
+  return worst;
+}
+
+int main(void)
+{
+  interleave_cal_t cal;
+  int err_raw, err_cal;
+
+  /* 无修正时解交替: 时间顺序为ADC2, ADC1, 误差只来自ADC2的失配 */
+  make(1500, 1.0, 0);
+  interleave_cal_reset(&cal);
+  interleave_unpack(words, PAIRS, &cal);
+  CHECK_EQ(max_error(), 0);
+
+  /* 增益+5%, 偏置-40LSB: 修正后误差为舍入级 */
+  make(1500, 1.05, -40);
+  interleave_cal_reset(&cal);
+  interleave_unpack(words, PAIRS, &cal);
+  err_raw = max_error();
+  make(1500, 1.05, -40);
+  CHECK(interleave_estimate(words, PAIRS, &cal));
+  CHECK_NEAR(cal.gain_q14, INTERLEAVE_GAIN_ONE / 1.05, 80);
+  interleave_unpack(words, PAIRS, &cal);
+  err_cal = max_error();
+  printf("gain 1.05 offset -40: max error %d -> %d LSB\n", err_raw, err_cal);
+  CHECK(err_raw > 100);
+  CHECK(err_cal * 10 <= err_raw);   /* 两路采样相位不同, 由均值和平均绝对偏差估计有几个LSB的残差 */
+
+  /* 增益0.6(比值约1.67, 在允许范围内) */
+  make(1200, 0.6, 300);
+  CHECK(interleave_estimate(words, PAIRS, &cal));
+  interleave_unpack(words, PAIRS, &cal);
+  CHECK(max_error() <= 8);
+
+  /* 直流输入: 只修正偏置 */
+  make(0, 1.0, 25);
+  CHECK(interleave_estimate(words, PAIRS, &cal));
+  CHECK_EQ(cal.gain_q14, INTERLEAVE_GAIN_ONE);
+  CHECK_EQ(cal.offset, -25);
+
+  /* 比值4.5: Q14已超出16位, 必须拒绝且不改变原参数 */
+  make(1800, 1.0 / 4.5, 1600);
+  interleave_cal_reset(&cal);
+  cal.offset = 7;
+  CHECK(!interleave_estimate(words, PAIRS, &cal));
+  CHECK_EQ(cal.gain_q14, INTERLEAVE_GAIN_ONE);
+  CHECK_EQ(cal.offset, 7);
+
+  /* 比值略超出2.0和低于0.5都拒绝 */
+  make(1800, 1.0 / 2.2, 1000);
+  CHECK(!interleave_estimate(words, PAIRS, &cal));
+  make(700, 2.2, -2400);
+  CHECK(!interleave_estimate(words, PAIRS, &cal));
+
+  /* ADC2未接入(恒定值)而ADC1有信号 */
+  make(1500, 0.0, 12);
+  CHECK(!interleave_estimate(words, PAIRS, &cal));
+  CHECK_EQ(cal.gain_q14, INTERLEAVE_GAIN_ONE);
+
+  CHECK(!interleave_estimate(words, 0, &cal));
+
+  TEST_END();
+}
@@ -0,0 +1,165 @@
+/* 画线: lcd_draw_line/lcd_draw_thick_line按行程写入的像素与逐点Bresenham一致, 裁剪矩形和屏幕边界的裁剪,
+ * 水平线和竖直线一次写入 */
+#include "lcd.h"
+#include "mock_lcd.h"
+#include "test.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define W       MOCK_LCD_WIDTH
+#define H       MOCK_LCD_HEIGHT
+#define BG      0x0000
+#define FG      0xF800
+
+static uint16_t ref[H][W];
+
+/* 当前的裁剪矩形(包含边界), 与lcd_set_clip的参数相同 */
+static int clip_sx = 0, clip_sy = 0, clip_ex = 0xFFFF, clip_ey = 0xFFFF;
+
+static void set_clip(int sx, int sy, int ex, int ey)
+{
+  clip_sx = sx;
+  clip_sy = sy;
+  clip_ex = ex;
+  clip_ey = ey;
+  lcd_set_clip(sx, sy, ex, ey);
+}
+
+static void reset_clip(void)
+{
+  clip_sx = 0;
+  clip_sy = 0;
+  clip_ex = 0xFFFF;
+  clip_ey = 0xFFFF;
+  lcd_reset_clip();
+}
+
+/* 参考画法: 逐点Bresenham(主方向每步一点, 误差初值为主方向长度的一半), 每点画边长2r+1的正方形,
+ * 只画裁剪矩形和屏幕以内的像素 */
+static void ref_line(int x1, int y1, int x2, int y2, int r)
+{
+  int dx = abs(x2 - x1), dy = abs(y2 - y1);
+  int incx = (x2 > x1) ? 1 : -1, incy = (y2 > y1) ? 1 : -1;
+  int x = x1, y = y1, err = (dx >= dy) ? dx / 2 : dy / 2;
+
+  for(;;) {
+    int px, py;
+
+    for(py = y - r; py <= y + r; py++) {
+      for(px = x - r; px <= x + r; px++) {
+        if(px < clip_sx || px > clip_ex || py < clip_sy || py > clip_ey) continue;
+        if(px < 0 || px >= W || py < 0 || py >= H) continue;
+        ref[py][px] = FG;
+      }
+    }
+    if(x == x2 && y == y2) break;
+    if(dx >= dy) {
+      x += incx;
+      err -= dy;
+      if(err < 0) { y += incy; err += dx; }
+    } else {
+      y += incy;
+      err -= dx;
+      if(err < 0) { x += incx; err += dy; }
+    }
+  }
+}
+
+static void ref_clear(void)
+{
+  uint32_t i;
+
+  for(i = 0; i < W * H; i++) ref[0][i] = BG;
+}
+
+/* 清屏后画一条线, 返回与参考画法不同的像素数; size为0时用lcd_draw_line */
+static uint32_t check_line(int x1, int y1, int x2, int y2, uint8_t size)
+{
+  uint32_t bad = 0;
+  int x, y;
+
+  mock_lcd_clear(BG);
+  ref_clear();
+  if(size == 0) lcd_draw_line(x1, y1, x2, y2, FG);
+  else lcd_draw_thick_line(x1, y1, x2, y2, size, FG);
+  ref_line(x1, y1, x2, y2, size / 2);
+  for(y = 0; y < H; y++) {
+    if(memcmp(mock_fb[y], ref[y], sizeof(ref[y])) == 0) continue;
+    for(x = 0; x < W; x++) bad += (mock_fb[y][x] != ref[y][x]);
+  }
+  return bad;
+}
+
+/* 画一条线的FSMC写操作数 */
+static uint32_t line_cost(int x1, int y1, int x2, int y2)
+{
+  uint32_t before = mock_fsmc_writes;
+
+  lcd_draw_line(x1, y1, x2, y2, FG);
+  return mock_fsmc_writes - before;
+}
+
+int main(void)
+{
+  uint32_t bad, i;
+  uint8_t size;
+
+  srand(21);
+
+  /* 各个方向和斜率, 端点在屏幕内 */
+  bad = 0;
+  for(i = 0; i < 400; i++) {
+    bad += check_line(rand() % W, rand() % H, rand() % W, rand() % H, (i % 4 == 0) ? 0 : 1 + i % 5);
+  }
+  CHECK_EQ(bad, 0);
+
+  /* 短线, 单点, 以及45度和接近45度的线(行程长度为1) */
+  bad = 0;
+  for(size = 0; size <= 4; size++) {
+    bad += check_line(100, 100, 100, 100, size);
+    bad += check_line(100, 100, 101, 100, size);
+    bad += check_line(100, 100, 100, 99, size);
+    bad += check_line(100, 100, 200, 200, size);
+    bad += check_line(200, 100, 100, 200, size);
+    bad += check_line(100, 100, 200, 201, size);
+    bad += check_line(100, 300, 3, 200, size);
+  }
+  CHECK_EQ(bad, 0);
+
+  /* 粗线在屏幕边上和超出屏幕: 只画屏幕内的部分 */
+  bad = 0;
+  for(i = 0; i < 100; i++) {
+    bad += check_line(rand() % (W + 100), rand() % (H + 100), rand() % (W + 100), rand() % (H + 100), 1 + i % 5);
+  }
+  bad += check_line(0, 0, W - 1, H - 1, 5);
+  bad += check_line(0, H - 1, W - 1, 0, 3);
+  CHECK_EQ(bad, 0);
+
+  /* 裁剪矩形: 穿过和在矩形外的线只画矩形内的部分 */
+  bad = 0;
+  for(i = 0; i < 200; i++) {
+    int sx = rand() % W, sy = rand() % H;
+
+    set_clip(sx, sy, sx + rand() % 200, sy + rand() % 300);
+    bad += check_line(rand() % W, rand() % H, rand() % W, rand() % H, (i % 3 == 0) ? 0 : 1 + i % 5);
+  }
+  set_clip(50, 50, 150, 150);
+  bad += check_line(0, 100, 300, 100, 3);
+  bad += check_line(100, 0, 100, 300, 0);
+  bad += check_line(0, 0, 300, 300, 5);
+  CHECK_EQ(bad, 0);
+
+  /* 整条线在裁剪矩形外: 不写GRAM; 取消裁剪后整条画出 */
+  CHECK_EQ(line_cost(200, 10, 400, 40), 0);
+  CHECK_EQ(line_cost(10, 160, 40, 400), 0);
+  reset_clip();
+  CHECK_EQ(check_line(0, 100, 300, 100, 3), 0);
+
+  /* 水平线设置光标后连续写入, 竖直线开窗一次写入并恢复窗口; 斜线每个行程一次 */
+  CHECK_EQ(line_cost(10, 20, 109, 20), 8 + 1 + 100);
+  CHECK_EQ(line_cost(10, 20, 10, 119), 16 + 1 + 100 + 16);
+  CHECK(line_cost(10, 20, 109, 29) <= 10 * (16 + 1 + 10) + 16);
+  printf("lines: %lu FSMC writes in total\n", (unsigned long)mock_fsmc_writes);
+
+  TEST_END();
+}
@@ -0,0 +1,250 @@
+/* 扫描显示: 每列一次开窗写入, 只改写新旧迹线覆盖的行, 与原来逐点画的FSMC写次数比较; 旧迹线擦除后网格复原,
+ * 峰值检测和多通道条带; 清除显示区域后界面元素整个重画; 自动滚动的门限和迟滞 */
+#include "oscilloscope.h"
+#include "lcd.h"
+#include "scan.h"
+#include "ui.h"
+#include "mock_lcd.h"
+#include "test.h"
+#include <math.h>
+
+uint16_t dac_offset = 2048;
+
+#define DAC_Y(v)    (WAVE_START_Y + WAVE_HEIGHT / 2 - (v) * (WAVE_HEIGHT / 2) / 4096)
+#define ADC_Y(v)    (WAVE_START_Y + WAVE_HEIGHT / 2 + 10 + (4096 - (v)) * (WAVE_HEIGHT / 2 - 20) / 4096)
+
+/* 与init_waveform_display()画出的网格一致 */
+static uint16_t grid_color(uint16_t x, uint16_t y)
+{
+  uint16_t row = y - WAVE_START_Y;
+
+  if(row == WAVE_HEIGHT / 2) return BLACK;
+  if(row % (WAVE_HEIGHT / 5) == 0) return LGRAY;
+  return ((x - WAVE_START_X) % (WAVE_WIDTH / 8) == 0) ? LGRAY : WHITE;
+}
+
+static uint16_t sine(uint32_t i, uint16_t amp)
+{
+  return (uint16_t)(2048 + amp * sin(i * 2 * M_PI / 150.0));
+}
+
+static void ui_fill(uint16_t sx, uint16_t sy, uint16_t ex, uint16_t ey, uint16_t color)
+{
+  lcd_fill(sx, sy, ex, ey, color);
+}
+
+static void ui_text(uint16_t x, uint16_t y, uint16_t width, uint8_t size, const char *str, uint16_t color, uint16_t bg)
+{
+  (void)bg;
+  lcd_show_string(x, y, width, size, size, (char *)str, color);
+}
+
+static const ui_backend_t ui_mock = { ui_fill, lcd_draw_rectangle, ui_text };
+
+/* 一次完整扫描, 返回每步的平均FSMC写操作数; bursts返回每步最多的开窗次数 */
+static uint32_t sweep(uint16_t amp, uint32_t *bursts)
+{
+  uint32_t before = mock_fsmc_writes;
+  uint16_t i, n = waveform_sweep_length();
+
+  *bursts = 0;
+  for(i = 0; i < n; i++) {
+    uint32_t b = mock_bursts;
+    uint16_t v = sine(i, amp);
+
+    draw_waveform_point(v, v);
+    if(mock_bursts - b > *bursts) *bursts = mock_bursts - b;
+  }
+  return (mock_fsmc_writes - before) / n;
+}
+
+/* 原来lcd.c的lcd_draw_line: Bresenham逐点调用lcd_draw_point */
+static void legacy_line(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint16_t color)
+{
+  int dx = (x2 > x1) ? x2 - x1 : x1 - x2, dy = (y2 > y1) ? y2 - y1 : y1 - y2;
+  int sx = (x2 > x1) ? 1 : -1, sy = (y2 > y1) ? 1 : -1;
+  int err = dx - dy, x = x1, y = y1;
+
+  for(;;) {
+    lcd_draw_point((uint16_t)x, (uint16_t)y, color);
+    if(x == x2 && y == y2) break;
+    if(2 * err > -dy) { err -= dy; x += sx; }
+    if(2 * err < dx) { err += dx; y += sy; }
+  }
+}
+
+/* 原来的draw_waveform_point(): 每步逐点清除三列, 重画网格, 画3x2条连接线, 再逐点画3x3的点 */
+static void legacy_point(uint16_t dac_value, uint16_t adc_value)
+{
+  static uint16_t cur_x = WAVE_START_X, prev_dac_y, prev_adc_y;
+  uint16_t dac_y = DAC_Y(dac_value), adc_y = ADC_Y(adc_value);
+  int thick, dx, dy;
+
+  legacy_line(cur_x, WAVE_START_Y + 1, cur_x, WAVE_START_Y + WAVE_HEIGHT - 1, WHITE);
+  legacy_line(cur_x + 1, WAVE_START_Y + 1, cur_x + 1, WAVE_START_Y + WAVE_HEIGHT - 1, WHITE);
+  legacy_line(cur_x + 2, WAVE_START_Y + 1, cur_x + 2, WAVE_START_Y + WAVE_HEIGHT - 1, WHITE);
+  if((cur_x - WAVE_START_X) % (WAVE_WIDTH / 8) == 0) {
+    legacy_line(cur_x, WAVE_START_Y, cur_x, WAVE_START_Y + WAVE_HEIGHT, LGRAY);
+  }
+  lcd_draw_point(cur_x, WAVE_START_Y + WAVE_HEIGHT / 2, GRAY);
+  if(cur_x > WAVE_START_X) {
+    for(thick = -1; thick <= 1; thick++) {
+      legacy_line(cur_x - 1, prev_dac_y + thick, cur_x, dac_y + thick, BLUE);
+      legacy_line(cur_x - 1 + thick, prev_dac_y, cur_x + thick, dac_y, BLUE);
+    }
+    for(thick = -1; thick <= 1; thick++) {
+      legacy_line(cur_x - 1, prev_adc_y + thick, cur_x, adc_y + thick, RED);
+      legacy_line(cur_x - 1 + thick, prev_adc_y, cur_x + thick, adc_y, RED);
+    }
+  }
+  for(dx = -1; dx <= 1; dx++) {
+    for(dy = -1; dy <= 1; dy++) {
+      lcd_draw_point(cur_x + dx, dac_y + dy, BLUE);
+      lcd_draw_point(cur_x + dx, adc_y + dy, RED);
+    }
+  }
+  prev_dac_y = dac_y;
+  prev_adc_y = adc_y;
+  if(++cur_x >= WAVE_START_X + WAVE_WIDTH - 1) {
+    cur_x = WAVE_START_X;
+    legacy_line(cur_x, WAVE_START_Y, cur_x, WAVE_START_Y + WAVE_HEIGHT, YELLOW);
+  }
+}
+
+/* 原来的画法扫描一次, 返回每步的平均FSMC写操作数 */
+static uint32_t legacy_sweep(uint16_t amp)
+{
+  uint32_t before = mock_fsmc_writes;
+  uint16_t i, n = WAVE_WIDTH - 1;
+
+  for(i = 0; i < n; i++) {
+    uint16_t v = sine(i, amp);
+
+    legacy_point(v, v);
+  }
+  return (mock_fsmc_writes - before) / n;
+}
+
+/* 显示区内不等于网格颜色的像素数, 跳过[lo, hi]行 */
+static uint32_t stray_pixels(uint16_t lo, uint16_t hi, uint16_t lo2, uint16_t hi2)
+{
+  uint32_t n = 0;
+  uint16_t x, y;
+
+  for(x = WAVE_START_X + 1; x < WAVE_START_X + WAVE_WIDTH; x++) {
+    for(y = WAVE_START_Y + 1; y < WAVE_START_Y + WAVE_HEIGHT - 1; y++) {
+      if((y >= lo && y <= hi) || (y >= lo2 && y <= hi2)) continue;
+      if(mock_fb[y][x] != grid_color(x, y)) n++;
+    }
+  }
+  return n;
+}
+
+int main(void)
+{
+  uint32_t sine_cost, dc_cost, bursts, full_cost, legacy_cost, wrong;
+  uint16_t x, y, dy = DAC_Y(2048), ay = ADC_Y(2048);
+
+  mock_lcd_clear(BLACK);
+  CHECK_EQ(roll_get_mode(), ROLL_AUTO);
+  init_waveform_display();
+  CHECK_EQ(waveform_sweep_index(), 0);
+
+  /* 初始化后第一次扫描改写整段, 之后的扫描只改写迹线的范围; 每列每段最多开一次窗 */
+  sweep(1800, &bursts);
+  sine_cost = sweep(1800, &bursts);
+  CHECK(bursts <= 3 * 2);
+  CHECK_EQ(waveform_sweep_index(), 0);
+
+  /* 直流: 擦除正弦后只剩3像素宽的水平迹线, 其余为网格 */
+  sweep(0, &bursts);
+  CHECK_EQ(stray_pixels(dy - 1, dy + 1, ay - 1, ay + 1), 0);
+  wrong = 0;
+  for(x = WAVE_START_X + 1; x < WAVE_START_X + WAVE_WIDTH; x++) {
+    for(y = dy - 1; y <= dy + 1; y++) wrong += (mock_fb[y][x] != BLUE);
+    for(y = ay - 1; y <= ay + 1; y++) wrong += (mock_fb[y][x] != RED);
+  }
+  CHECK_EQ(wrong, 0);
+
+  /* 直流稳定后每步只写三列x两段的迹线行(开窗, 写GRAM, 恢复窗口, 3行), 另有每轮一次的扫描光标(按逐点画估计上限);
+   * 整列重画需要三列各两段的全部像素 */
+  dc_cost = sweep(0, &bursts);
+  full_cost = 3 * (WAVE_HEIGHT - 1 + 2 * (16 + 1 + 16));
+  printf("FSMC writes per step: sine %lu, DC %lu, full-column redraw %lu\n",
+         (unsigned long)sine_cost, (unsigned long)dc_cost, (unsigned long)full_cost);
+  CHECK(dc_cost <= 3U * 2 * (16 + 1 + 16 + 3) + (WAVE_HEIGHT + 1) * 10U / waveform_sweep_length() + 1);
+  CHECK(sine_cost < full_cost / 4);
+
+  /* 峰值检测: 竖线覆盖min~max */
+  for(x = 0; x < 20; x++) draw_waveform_span(2048, 1000, 3000);
+  x = WAVE_START_X + waveform_sweep_index() - 2;
+  wrong = 0;
+  for(y = ADC_Y(3000); y <= ADC_Y(1000); y++) wrong += (mock_fb[y][x] != RED);
+  CHECK_EQ(wrong, 0);
+  CHECK(mock_fb[ADC_Y(3000) - 3][x] != RED);
+
+  /* 多通道: 通道k画在第k条带内, 颜色为scan_trace_colors[k] */
+  {
+    const uint16_t v[SCAN_MAX_CHANNELS] = { 2048, 2048, 2048, 2048 };
+    uint16_t lane_h = (WAVE_HEIGHT / 2 - 20) / SCAN_MAX_CHANNELS, ch;
+
+    for(x = 0; x < 20; x++) draw_waveform_scan(2048, v, SCAN_MAX_CHANNELS);
+    x = WAVE_START_X + waveform_sweep_index() - 2;
+    for(ch = 0; ch < SCAN_MAX_CHANNELS; ch++) {
+      y = WAVE_START_Y + WAVE_HEIGHT / 2 + 10 + ch * lane_h + lane_h / 2;
+      CHECK_EQ(mock_fb[y][x], scan_trace_colors[ch]);
+    }
+  }
+
+  /* 切换显示方式时清除显示区域: 界面元素在下一次ui_flush()时整个重画 */
+  {
+    static ui_text_t info;
+    static ui_button_t btn;
+
+    ui_init(&ui_mock);
+    ui_text_init(&info, 20, 615, 450, 16, BLACK, WHITE);
+    ui_button_init(&btn, 10, 710, 52, 30, "Trig", DARKBLUE, YELLOW);
+    ui_text_set(&info, "T:Auto Rise");
+    CHECK_EQ(ui_flush(), 3 + 2);
+    CHECK_EQ(ui_flush(), 0);
+    init_waveform_display();
+    CHECK_EQ(ui_flush(), 3 + 2);
+    draw_bode_frame(20000, 20000000);
+    CHECK_EQ(ui_flush(), 3 + 2);
+    roll_set_mode(ROLL_ON);
+    waveform_roll_update(1);
+    CHECK_EQ(ui_flush(), 3 + 2);
+    CHECK_EQ(ui_flush(), 0);
+    roll_set_mode(ROLL_AUTO);
+    CHECK_EQ(waveform_roll_update(1), 1);
+    CHECK_EQ(ui_flush(), 0);
+  }
+
+  /* 开机为自动滚动: 最慢时基的扫描时间低于默认门限, 仍为触发扫描; 调低门限后滚动, 门限调回时有迟滞 */
+  {
+    CHECK(waveform_sweep_ms() < ROLL_DEFAULT_THRESHOLD_MS);
+    roll_set_mode(ROLL_OFF);
+    CHECK_EQ(waveform_roll_update(1), 0);
+    roll_set_mode(ROLL_AUTO);
+    CHECK_EQ(waveform_roll_update(1), 0);
+    CHECK_EQ(waveform_roll_update(0), 0);
+    roll_set_threshold_ms(2500);
+    CHECK_EQ(waveform_roll_update(1), 1);
+    CHECK_EQ(waveform_roll_update(0), 0);
+    CHECK_EQ(waveform_roll_update(1), 1);
+    roll_set_threshold_ms(ROLL_DEFAULT_THRESHOLD_MS);
+    CHECK_EQ(waveform_roll_update(1), 1);
+    roll_set_threshold_ms(8000);
+    CHECK_EQ(waveform_roll_update(1), 0);
+    roll_set_threshold_ms(0);
+    CHECK_EQ(roll_get_threshold_ms(), ROLL_MIN_THRESHOLD_MS);
+  }
+
+  /* 与原来逐点画的正弦扫描比较(最后做, 逐点画会改写显示区): FSMC写操作至少减少到1/5 */
+  legacy_cost = legacy_sweep(1800);
+  printf("FSMC writes per step: legacy per-pixel %lu, sine %lu (%.1fx fewer)\n",
+         (unsigned long)legacy_cost, (unsigned long)sine_cost, (double)legacy_cost / sine_cost);
+  CHECK(sine_cost * 5 <= legacy_cost);
+
+  TEST_END();
+}
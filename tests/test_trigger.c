@@ -0,0 +1,186 @@
+/* 触发检测: 带噪声的边沿不重复触发, 释抑时间内不触发, 结果与数据块划分无关;
+ * 硬件标记定位: 测得的延迟等于注入的延迟, 超过上限时也不被截断 */
+#include "trigger.h"
+#include "test.h"
+#include <stdlib.h>
+
+#define LEN 20000
+#define AWD_BOUND 4         /* 与adc.h中的ADC_AWD_MAX_LATENCY一致 */
+#define AWD_BLOCK 256
+
+static uint16_t sig[LEN];
+static uint32_t hits[LEN];
+
+/* 周期period的方波, 边沿为斜坡, 叠加峰值noise的均匀噪声 */
+static void make_square(uint16_t period, uint16_t ramp, int noise)
+{
+  uint32_t i;
+
+  srand(1);
+  for(i = 0; i < LEN; i++) {
+    uint32_t ph = i % period;
+    int v;
+
+    if(ph < ramp) v = 1000 + 2000 * (int)ph / ramp;
+    else if(ph < period / 2) v = 3000;
+    else if(ph < period / 2 + ramp) v = 3000 - 2000 * (int)(ph - period / 2) / ramp;
+    else v = 1000;
+    if(noise) v += rand() % (2 * noise + 1) - noise;
+    sig[i] = (uint16_t)v;
+  }
+}
+
+/* 按块大小block扫描整个信号, 像capture_scan()一样在触发点之后继续, 返回触发次数 */
+static uint32_t scan(uint16_t block)
+{
+  uint32_t pos = 0, count = 0;
+
+  trigger_reset();
+  while(pos < LEN) {
+    uint16_t n = (LEN - pos < block) ? (uint16_t)(LEN - pos) : block;
+    uint16_t off = 0;
+
+    while(off < n) {
+      int32_t hit = trigger_find(&sig[pos + off], n - off);
+      if(hit < 0) break;
+      hits[count++] = pos + off + hit;
+      off += hit + 1;
+    }
+    pos += n;
+  }
+  return count;
+}
+
+int main(void)
+{
+  static const uint16_t blocks[] = { 1, 13, 256, 20000 };
+  uint32_t n, i, k, ref[LEN], ref_n;
+
+  /* 斜坡每采样20LSB, 噪声峰值±40LSB, 迟滞64: 每个上升沿恰好触发一次, 触发点在斜坡上 */
+  make_square(400, 100, 40);
+  trigger_set_edge(TRIGGER_EDGE_RISING);
+  trigger_set_level(2000, 64);
+  trigger_set_holdoff(0);
+  for(k = 0; k < sizeof(blocks) / sizeof(blocks[0]); k++) {
+    n = scan(blocks[k]);
+    CHECK_EQ(n, LEN / 400);
+    for(i = 0; i < n; i++) {
+      CHECK(hits[i] % 400 < 100);
+      CHECK(sig[hits[i]] >= 2000);
+    }
+  }
+
+  /* 没有迟滞时同一个边沿上会重复触发, 说明上面的噪声足以引起误触发 */
+  trigger_set_level(2000, 1);
+  n = scan(256);
+  printf("noisy rising edges: %u triggers without hysteresis, %u edges\n", (unsigned)n, LEN / 400);
+  CHECK(n > LEN / 400);
+
+  /* 下降沿和双边沿 */
+  trigger_set_level(2000, 64);
+  trigger_set_edge(TRIGGER_EDGE_FALLING);
+  n = scan(256);
+  CHECK_EQ(n, LEN / 400);
+  for(i = 0; i < n; i++) {
+    CHECK(hits[i] % 400 >= 200 && hits[i] % 400 < 300);
+    CHECK(sig[hits[i]] <= 2000);
+  }
+  trigger_set_edge(TRIGGER_EDGE_EITHER);
+  n = scan(256);
+  CHECK_EQ(n, 2 * LEN / 400);
+
+  /* 释抑: 周期100的方波, 释抑250个采样 -> 每3个边沿触发一次, 间隔不小于释抑时间 */
+  make_square(100, 5, 30);
+  trigger_set_edge(TRIGGER_EDGE_RISING);
+  trigger_set_level(2000, 64);
+  trigger_set_holdoff(0);
+  ref_n = scan(256);
+  CHECK_EQ(ref_n, LEN / 100);
+  for(i = 0; i < ref_n; i++) ref[i] = hits[i];
+
+  trigger_set_holdoff(250);
+  CHECK_EQ(trigger_get_holdoff(), 250);
+  for(k = 0; k < sizeof(blocks) / sizeof(blocks[0]); k++) {
+    uint32_t j = 0;
+
+    n = scan(blocks[k]);
+    CHECK_EQ(n, (LEN / 100 + 2) / 3);
+    for(i = 0; i < n; i++) {
+      /* 每个触发点是释抑结束后的第一个边沿 */
+      while(j < ref_n && ref[j] < hits[i]) j++;
+      CHECK(j < ref_n && ref[j] == hits[i]);
+      if(i > 0) {
+        CHECK(hits[i] - hits[i - 1] > 250);
+        CHECK(hits[i] - hits[i - 1] <= 250 + 100);
+      }
+    }
+  }
+
+  /* 释抑的单位换算 */
+  CHECK_EQ(TRIGGER_US_TO_SAMPLES(100, 250000), 25);
+  CHECK_EQ(TRIGGER_US_TO_SAMPLES(10000, 1714285), 17142);
+
+  /* 电平靠近满量程时布防门限不溢出 */
+  trigger_set_level(4090, 64);
+  CHECK_EQ(trigger_get_arm_high(), 4095);
+  CHECK_EQ(trigger_get_arm_low(), 4026);
+  trigger_set_level(20, 64);
+  CHECK_EQ(trigger_get_arm_low(), 0);
+
+  /* 精确定位: 在包含触发点的窗口内找到与trigger_find()相同的采样 */
+  make_square(400, 100, 40);
+  trigger_set_holdoff(0);
+  trigger_set_level(2000, 64);
+  n = scan(20000);
+  for(i = 1; i < n; i++) {
+    int32_t r = trigger_refine(sig, (uint16_t)(hits[i] - 30), (uint16_t)(hits[i] + 5));
+    CHECK_EQ(r, hits[i]);
+  }
+
+  /* 硬件标记定位: 过电平后延迟d个采样读取DMA位置, 由半缓冲大小的数据块依次定位.
+   * 标记可能落在下一块, 此时本块内就能找到过电平点; d超出上限时测得的延迟仍等于d */
+  {
+    uint32_t within = 0, beyond = 0;
+
+    make_square(150, 30, 20);
+    trigger_set_edge(TRIGGER_EDGE_RISING);
+    trigger_set_level(2000, 64);
+    n = scan(20000);
+    for(i = 1; i < n; i++) {
+      uint32_t d = (i * 7) % 61;
+      uint32_t mark = hits[i] + 1 + d;
+      uint32_t base = hits[i] / AWD_BLOCK * AWD_BLOCK;
+      uint16_t latency = 0;
+      int32_t hit = -1;
+
+      for(; base < LEN && hit < 0; base += AWD_BLOCK) {
+        uint16_t len = (LEN - base < AWD_BLOCK) ? (uint16_t)(LEN - base) : AWD_BLOCK;
+        hit = trigger_locate(&sig[base], len, (uint16_t)(mark - 1 - base), &latency);
+        if(hit >= 0) {
+          CHECK_EQ(base + hit, hits[i]);
+        }
+      }
+      CHECK_EQ(latency, d);
+      if(latency > AWD_BOUND) beyond++;
+      else within++;
+    }
+    printf("hardware mark: %u within the %u-sample bound, %u beyond (measured exactly)\n",
+           (unsigned)within, AWD_BOUND, (unsigned)beyond);
+    CHECK(within > 0 && beyond > 0);
+
+    /* 过电平点在更早的块中: 延迟无法测量 */
+    for(i = 1; i < n; i++) {
+      if(hits[i] % AWD_BLOCK > 200 && sig[(hits[i] / AWD_BLOCK + 1) * AWD_BLOCK] > 2000) break;
+    }
+    CHECK(i < n);
+    {
+      uint32_t base = (hits[i] / AWD_BLOCK + 1) * AWD_BLOCK;
+      uint16_t latency = 0;
+
+      CHECK_EQ(trigger_locate(&sig[base], AWD_BLOCK, 3, &latency), 0);
+      CHECK_EQ(latency, TRIGGER_LATENCY_UNKNOWN);
+    }
+  }
+
+  TEST_END();
+}
@@ -0,0 +1,152 @@
+/* 保留模式界面: ui_flush()只重画变化的字符段和按钮, 每种修改的绘制次数, 屏上内容与要显示的内容一致 */
+#include "ui.h"
+#include "test.h"
+#include <string.h>
+
+#define CW      8               /* 16号字的字符宽度 */
+#define COLS    60
+#define ROWS    4
+
+/* 模拟屏幕: 每个16号字符位置一格, 记录字符和颜色 */
+static char scr[ROWS][COLS + 1];
+static uint16_t scr_color[ROWS][COLS];
+static uint32_t text_chars = 0;     /* 画出的字符数 */
+static uint32_t fills = 0, rects = 0, texts = 0;
+
+static void mock_fill(uint16_t sx, uint16_t sy, uint16_t ex, uint16_t ey, uint16_t color)
+{
+  uint16_t c;
+
+  (void)ey;
+  (void)color;
+  fills++;
+  if(sy / 16 >= ROWS) return;
+  for(c = sx / CW; c <= ex / CW && c < COLS; c++) scr[sy / 16][c] = ' ';
+}
+
+static void mock_rect(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint16_t color)
+{
+  (void)x1; (void)y1; (void)x2; (void)y2; (void)color;
+  rects++;
+}
+
+static void mock_text(uint16_t x, uint16_t y, uint16_t width, uint8_t size, const char *str, uint16_t color, uint16_t bg)
+{
+  uint16_t c = x / CW, end = (x + width) / CW;
+
+  (void)size;
+  (void)bg;
+  texts++;
+  if(y / 16 >= ROWS) return;
+  for(; *str && c < end && c < COLS; str++, c++) {
+    scr[y / 16][c] = *str;
+    scr_color[y / 16][c] = color;
+    text_chars++;
+  }
+}
+
+static const ui_backend_t mock = { mock_fill, mock_rect, mock_text };
+
+/* 文本框t在屏上的内容(到宽度为止), 去掉末尾的空格 */
+static const char *screen_text(const ui_text_t *t)
+{
+  static char line[COLS + 1];
+  int16_t n = t->width / CW;
+
+  memcpy(line, scr[t->y / 16], n);
+  while(n > 0 && line[n - 1] == ' ') n--;
+  line[n] = '\0';
+  return line;
+}
+
+int main(void)
+{
+  static ui_text_t freq, info;
+  static ui_button_t run, stop;
+  uint32_t chars;
+
+  memset(scr, '?', sizeof(scr));
+  ui_text_init(&freq, 0, 0, 20 * CW, 16, 0x001F, UI_WHITE);
+  ui_text_init(&info, 0, 16, 40 * CW, 16, 0x0000, UI_WHITE);
+  ui_button_init(&run, 0, 100, 60, 30, "Run", 0x07E0, 0xFFE0);
+  ui_button_init(&stop, 70, 100, 60, 30, "Stop", 0xF800, 0xFFE0);
+
+  /* 未设置绘制接口时不画 */
+  CHECK_EQ(ui_flush(), 0);
+
+  /* 第一次整个重画: 每个按钮3次, 每个文本框写文字和清除到宽度各1次 */
+  ui_init(&mock);
+  ui_text_set(&freq, "F: 1234.5Hz");
+  ui_text_set(&info, "Vpp: 3.30V  Mean: 1.65V");
+  CHECK_EQ(ui_flush(), 2 * 3 + 2 * 2);
+  CHECK(strcmp(screen_text(&freq), "F: 1234.5Hz") == 0);
+  CHECK(strcmp(screen_text(&info), "Vpp: 3.30V  Mean: 1.65V") == 0);
+
+  /* 没有变化, 或设置相同的内容: 不访问LCD */
+  CHECK_EQ(ui_flush(), 0);
+  ui_text_set(&freq, "F: 1234.5Hz");
+  ui_button_select(&run, 0);
+  CHECK_EQ(ui_flush(), 0);
+
+  /* 一个字符变化: 只画这一个字符 */
+  chars = text_chars;
+  ui_text_set(&freq, "F: 1235.5Hz");
+  CHECK_EQ(ui_flush(), 1);
+  CHECK_EQ(text_chars - chars, 1);
+  CHECK(strcmp(screen_text(&freq), "F: 1235.5Hz") == 0);
+
+  /* 两处不相邻的变化: 两段 */
+  chars = text_chars;
+  ui_text_set(&info, "Vpp: 3.31V  Mean: 1.66V");
+  CHECK_EQ(ui_flush(), 2);
+  CHECK_EQ(text_chars - chars, 2);
+  CHECK(strcmp(screen_text(&info), "Vpp: 3.31V  Mean: 1.66V") == 0);
+
+  /* 变短: 变化的字符一段, 多出的尾部清除一次 */
+  chars = text_chars;
+  ui_text_set(&freq, "F: 99.0Hz");
+  CHECK_EQ(ui_flush(), 2);
+  CHECK_EQ(text_chars - chars, 6);
+  CHECK(strcmp(screen_text(&freq), "F: 99.0Hz") == 0);
+
+  /* 变长: 只画新增和变化的字符 */
+  chars = text_chars;
+  ui_text_set(&freq, "F: 99.0Hz ~");
+  CHECK_EQ(ui_flush(), 1);
+  CHECK_EQ(text_chars - chars, 2);
+  CHECK(strcmp(screen_text(&freq), "F: 99.0Hz ~") == 0);
+
+  /* 超出宽度的字符不显示, 宽度以外的屏幕不被改写 */
+  ui_text_set(&freq, "F: 99.0Hz ~ 0123456789ABCDEF");
+  ui_flush();
+  CHECK(strcmp(screen_text(&freq), "F: 99.0Hz ~ 01234567") == 0);
+  CHECK_EQ(scr[0][20], '?');
+
+  /* 改变颜色: 整行重画并清除到宽度 */
+  ui_text_set(&freq, "F: 50.0Hz");
+  ui_text_set_color(&freq, 0xF800);
+  CHECK_EQ(ui_flush(), 2);
+  CHECK(strcmp(screen_text(&freq), "F: 50.0Hz") == 0);
+  CHECK_EQ(scr_color[0][0], 0xF800);
+
+  /* 按钮只在选中状态变化时重画 */
+  ui_button_select(&run, 1);
+  CHECK_EQ(ui_flush(), 3);
+  ui_button_select(&run, 1);
+  CHECK_EQ(ui_flush(), 0);
+  ui_button_select(&run, 0);
+  ui_button_select(&stop, 1);
+  CHECK_EQ(ui_flush(), 6);
+
+  /* 清屏后ui_invalidate(): 全部元素整个重画 */
+  memset(scr, ' ', sizeof(scr));
+  ui_invalidate();
+  CHECK_EQ(ui_flush(), 2 * 3 + 2 * 2);
+  CHECK(strcmp(screen_text(&freq), "F: 50.0Hz") == 0);
+  CHECK(strcmp(screen_text(&info), "Vpp: 3.31V  Mean: 1.66V") == 0);
+  CHECK_EQ(ui_flush(), 0);
+  printf("ui: %lu text, %lu fill, %lu rect calls in total\n",
+         (unsigned long)texts, (unsigned long)fills, (unsigned long)rects);
+
+  TEST_END();
+}
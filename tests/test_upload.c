@@ -0,0 +1,245 @@
+/* 波形上传: 任意分段和夹杂噪声字节时的帧同步, 帧CRC错误, 顺序错误和重发, 整表校验, 放弃 */
+#include "upload.h"
+#include "test.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define POINTS  1000
+
+static uint16_t table[4096];
+static uint16_t committed[4096];
+static uint16_t committed_points = 0;
+static uint8_t refuse = 0;          /* 模拟发生器正在换表 */
+static uint8_t aborted = 0;
+
+static uint8_t last_cmd;
+static upload_status_t last_status;
+static uint16_t last_value;
+static uint32_t replies = 0;
+
+static uint16_t *gen_begin(uint16_t points)
+{
+  return (refuse || points > 4096) ? NULL : table;
+}
+
+static uint8_t gen_end(uint16_t points)
+{
+  if(points == 0) {
+    aborted = 1;
+    return 1;
+  }
+  memcpy(committed, table, points * 2);
+  committed_points = points;
+  return 1;
+}
+
+static void on_reply(uint8_t cmd, upload_status_t status, uint16_t value)
+{
+  last_cmd = cmd;
+  last_status = status;
+  last_value = value;
+  replies++;
+}
+
+/* 按1~17字节随机分段喂入, 模拟串口接收的任意分段 */
+static void feed_split(const uint8_t *p, uint16_t n)
+{
+  while(n > 0) {
+    uint16_t k = 1 + rand() % 17;
+    if(k > n) k = n;
+    upload_feed(p, k);
+    p += k;
+    n -= k;
+  }
+}
+
+/* 组帧, 返回帧长 */
+static uint16_t frame(uint8_t *out, uint8_t cmd, const uint8_t *payload, uint16_t len)
+{
+  uint16_t crc;
+
+  out[0] = UPLOAD_SYNC0;
+  out[1] = UPLOAD_SYNC1;
+  out[2] = cmd;
+  out[3] = (uint8_t)len;
+  out[4] = (uint8_t)(len >> 8);
+  memcpy(&out[5], payload, len);
+  crc = upload_crc16(0xFFFF, &out[2], len + 3);
+  out[5 + len] = (uint8_t)crc;
+  out[6 + len] = (uint8_t)(crc >> 8);
+  return len + 7;
+}
+
+static void send(uint8_t cmd, const uint8_t *payload, uint16_t len)
+{
+  uint8_t buf[UPLOAD_MAX_PAYLOAD + 7];
+
+  feed_split(buf, frame(buf, cmd, payload, len));
+}
+
+static void send16(uint8_t cmd, uint16_t v)
+{
+  uint8_t p[2] = { (uint8_t)v, (uint8_t)(v >> 8) };
+
+  send(cmd, p, 2);
+}
+
+/* 数据帧: 从offset起count个点 */
+static uint16_t data_payload(uint8_t *p, const uint16_t *src, uint16_t offset, uint16_t count)
+{
+  uint16_t i;
+
+  p[0] = (uint8_t)offset;
+  p[1] = (uint8_t)(offset >> 8);
+  for(i = 0; i < count; i++) {
+    p[2 + i * 2] = (uint8_t)src[offset + i];
+    p[3 + i * 2] = (uint8_t)(src[offset + i] >> 8);
+  }
+  return 2 + count * 2;
+}
+
+static void send_data(const uint16_t *src, uint16_t offset, uint16_t count)
+{
+  uint8_t p[UPLOAD_MAX_PAYLOAD];
+
+  send('D', p, data_payload(p, src, offset, count));
+}
+
+static uint16_t table_crc(const uint16_t *src, uint16_t n)
+{
+  uint16_t crc = 0xFFFF, i;
+
+  for(i = 0; i < n; i++) {
+    uint8_t b[2] = { (uint8_t)src[i], (uint8_t)(src[i] >> 8) };
+    crc = upload_crc16(crc, b, 2);
+  }
+  return crc;
+}
+
+/* 文本日志和噪声: 包含同步字节和不合理的帧头 */
+static void noise(void)
+{
+  static const uint8_t junk[] = "ADC 200kS/s \xA5\xA5\x5A\x58\xA5\x5A\n\xA5\x5A\x44\xFF\xFF";
+
+  feed_split(junk, sizeof(junk) - 1);
+}
+
+int main(void)
+{
+  static uint16_t wave[POINTS];
+  uint8_t buf[UPLOAD_MAX_PAYLOAD + 10], payload[UPLOAD_MAX_PAYLOAD];
+  uint16_t i, len, next;
+  uint32_t errors;
+
+  srand(18);
+  for(i = 0; i < POINTS; i++) wave[i] = (uint16_t)(i * 37 % 4096);
+  upload_init(gen_begin, gen_end, on_reply);
+
+  /* CRC16-CCITT(初值0xFFFF)的标准校验值 */
+  CHECK_EQ(upload_crc16(0xFFFF, (const uint8_t *)"123456789", 9), 0x29B1);
+
+  /* 未开始时的数据帧和结束帧: 顺序错误 */
+  send_data(wave, 0, 8);
+  CHECK_EQ(last_cmd, 'D');
+  CHECK_EQ(last_status, UPLOAD_ERR_SEQ);
+  send16('E', 0);
+  CHECK_EQ(last_status, UPLOAD_ERR_SEQ);
+
+  /* 奇数点数和发生器拒绝: 忙 */
+  send16('B', 999);
+  CHECK_EQ(last_status, UPLOAD_ERR_BUSY);
+  refuse = 1;
+  send16('B', POINTS);
+  CHECK_EQ(last_status, UPLOAD_ERR_BUSY);
+  CHECK(!upload_active());
+  refuse = 0;
+
+  /* 完整上传, 帧之间夹杂日志和假同步字节; 途中插入各种错误, 上位机按回复的起始点继续 */
+  send16('B', POINTS);
+  CHECK_EQ(last_status, UPLOAD_OK);
+  CHECK(upload_active());
+  CHECK_EQ(upload_total(), POINTS);
+  next = 0;
+  for(i = 0; next < POINTS; i++) {
+    uint16_t n = (POINTS - next < UPLOAD_MAX_CHUNK) ? POINTS - next : UPLOAD_MAX_CHUNK;
+    uint32_t before = replies;
+
+    noise();
+    if(i == 3) {
+      /* 一个字节出错: 帧CRC错误, 回复当前的起始点 */
+      len = frame(buf, 'D', payload, data_payload(payload, wave, next, n));
+      buf[20] ^= 0x10;
+      feed_split(buf, len);
+      CHECK_EQ(last_status, UPLOAD_ERR_CRC);
+      CHECK_EQ(last_value, next);
+      CHECK_EQ(upload_received(), next);
+    } else if(i == 5) {
+      /* 跳过一帧: 顺序错误, 回复应从哪一点重发 */
+      send_data(wave, next + UPLOAD_MAX_CHUNK, n);
+      CHECK_EQ(last_status, UPLOAD_ERR_SEQ);
+      CHECK_EQ(last_value, next);
+    } else if(i == 7) {
+      /* 超出0~4095的点: 整帧不写入 */
+      static uint16_t bad[POINTS];
+      memcpy(bad, wave, sizeof(bad));
+      bad[next + 1] = 4096;
+      send_data(bad, next, n);
+      CHECK_EQ(last_status, UPLOAD_ERR_RANGE);
+      CHECK_EQ(upload_received(), next);
+    } else if(i == 9) {
+      /* 回复丢失后重发上一帧: 覆盖写入, 起始点不变 */
+      send_data(wave, next - UPLOAD_MAX_CHUNK, UPLOAD_MAX_CHUNK);
+      CHECK_EQ(last_status, UPLOAD_OK);
+      CHECK_EQ(last_value, next);
+    }
+    send_data(wave, next, n);
+    CHECK_EQ(replies, before + ((i == 3 || i == 5 || i == 7 || i == 9) ? 2 : 1));
+    CHECK_EQ(last_status, UPLOAD_OK);
+    next = last_value;
+  }
+  CHECK_EQ(upload_received(), POINTS);
+
+  /* 整表CRC不符: 校验失败, 从0点整表重发 */
+  send16('E', table_crc(wave, POINTS) ^ 1);
+  CHECK_EQ(last_cmd, 'E');
+  CHECK_EQ(last_status, UPLOAD_ERR_VERIFY);
+  CHECK_EQ(last_value, 0);
+  CHECK_EQ(committed_points, 0);
+  for(next = 0; next < POINTS; next = last_value) {
+    send_data(wave, next, (POINTS - next < UPLOAD_MAX_CHUNK) ? POINTS - next : UPLOAD_MAX_CHUNK);
+  }
+  send16('E', table_crc(wave, POINTS));
+  CHECK_EQ(last_status, UPLOAD_OK);
+  CHECK_EQ(last_value, POINTS);
+  CHECK_EQ(committed_points, POINTS);
+  CHECK(memcmp(committed, wave, sizeof(wave)) == 0);
+  CHECK(!upload_active());
+
+  /* 帧头不合理时从帧头重新找同步: 假同步字节后面紧跟真正的帧 */
+  errors = upload_frame_errors();
+  payload[0] = 0x10;
+  payload[1] = 0x00;
+  len = frame(buf + 3, 'B', payload, 2);
+  buf[0] = UPLOAD_SYNC0;
+  buf[1] = UPLOAD_SYNC1;
+  buf[2] = 'X';
+  replies = 0;
+  upload_feed(buf, len + 3);
+  CHECK_EQ(replies, 1);
+  CHECK_EQ(last_cmd, 'B');
+  CHECK_EQ(last_status, UPLOAD_OK);
+  CHECK_EQ(upload_frame_errors(), errors + 1);
+
+  /* 点数不足时结束: 校验失败; 放弃: 表交还发生器 */
+  send_data(wave, 0, 8);
+  send16('E', 0);
+  CHECK_EQ(last_status, UPLOAD_ERR_VERIFY);
+  CHECK_EQ(last_value, 8);
+  send('A', payload, 0);
+  CHECK_EQ(last_cmd, 'A');
+  CHECK_EQ(last_status, UPLOAD_OK);
+  CHECK(aborted);
+  CHECK(!upload_active());
+
+  TEST_END();
+}